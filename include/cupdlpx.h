@@ -33,6 +33,32 @@ extern "C"
         const double *var_ub,
         const double *objective_constant);
 
+    // same as create_lp_problem, but a CSR matrix is referenced instead of
+    // copied, and so are the arrays of a CSC matrix kept as its transpose;
+    // they must outlive the problem
+    lp_problem_t *create_lp_problem_borrowed(
+        const double *objective_c,
+        const matrix_desc_t *A_desc,
+        const double *con_lb,
+        const double *con_ub,
+        const double *var_lb,
+        const double *var_ub,
+        const double *objective_constant);
+
+    // same as create_lp_problem for index arrays of index_type and values of
+    // value_type elements, passed through the int and double pointers of
+    // A_desc; they are converted to int and double CSR in one parallel pass
+    lp_problem_t *create_lp_problem_typed(
+        const double *objective_c,
+        const matrix_desc_t *A_desc,
+        matrix_index_type_t index_type,
+        matrix_value_type_t value_type,
+        const double *con_lb,
+        const double *con_ub,
+        const double *var_lb,
+        const double *var_ub,
+        const double *objective_constant);
+
     // Set up initial primal and dual solution for an lp_problem_t
     void set_start_values(lp_problem_t *prob, const double *primal, const double *dual);
 
@@ -41,6 +67,38 @@ extern "C"
         const lp_problem_t *prob,
         const pdhg_parameters_t *params);
 
+    // a solver for repeated solves of one problem; it takes ownership of prob
+    // and keeps the rescaled matrix and its step size on the device, so a
+    // solve after an update only uploads the changed vectors
+    cupdlpx_solver_t *cupdlpx_solver_create(lp_problem_t *prob);
+
+    // replace the vectors that are not NULL; a change of bound type between
+    // free, one-sided, boxed and fixed makes the next solve set up again
+    void cupdlpx_solver_update(
+        cupdlpx_solver_t *solver,
+        const double *objective_c,
+        const double *objective_constant,
+        const double *con_lb,
+        const double *con_ub,
+        const double *var_lb,
+        const double *var_ub);
+
+    // starting point of the following solves; while none is set, a solve
+    // starts from the solution of the previous one
+    void cupdlpx_solver_set_start_values(
+        cupdlpx_solver_t *solver,
+        const double *primal,
+        const double *dual);
+
+    cupdlpx_result_t *cupdlpx_solver_solve(
+        cupdlpx_solver_t *solver,
+        const pdhg_parameters_t *params);
+
+    void cupdlpx_solver_free(cupdlpx_solver_t *solver);
+
+    // drops the solutions kept for solves with solution_store_size > 0
+    void cupdlpx_solution_store_clear(void);
+
     // parameter
     void set_default_parameters(pdhg_parameters_t *params);
 
@@ -32,7 +32,8 @@ extern "C"
 		TERMINATION_REASON_DUAL_INFEASIBLE,
 		TERMINATION_REASON_TIME_LIMIT,
 		TERMINATION_REASON_ITERATION_LIMIT,
-		TERMINATION_REASON_FEAS_POLISH_SUCCESS
+		TERMINATION_REASON_FEAS_POLISH_SUCCESS,
+		TERMINATION_REASON_USER_INTERRUPT
 	} termination_reason_t;
 
 	typedef struct
@@ -49,11 +50,21 @@ extern "C"
 		double *constraint_matrix_values;
 		int constraint_matrix_num_nonzeros;
 
+		// optional transpose of the matrix in CSR, i.e. the CSC arrays of A
+		// with the same nonzeros; NULL when absent, setup then builds it
+		int *constraint_matrix_t_row_pointers;
+		int *constraint_matrix_t_col_indices;
+		double *constraint_matrix_t_values;
+
 		double *constraint_lower_bound;
 		double *constraint_upper_bound;
 
 		double *primal_start;
 		double *dual_start;
+
+		// the matrix arrays belong to the caller and are not freed
+		bool borrows_constraint_matrix;
+		bool borrows_constraint_matrix_t;
 	} lp_problem_t;
 
 	typedef struct
@@ -77,6 +88,24 @@ extern "C"
 		int iteration_limit;
 	} termination_criteria_t;
 
+	// progress at a major iteration, in the units of the original problem
+	typedef struct
+	{
+		int iteration;
+		double elapsed_time_sec;
+		double primal_objective_value;
+		double dual_objective_value;
+		double relative_primal_residual;
+		double relative_dual_residual;
+		double relative_objective_gap;
+		double primal_weight;
+		double step_size;
+	} cupdlpx_iteration_stats_t;
+
+	// called at every major iteration; returning false stops the solve
+	typedef bool (*cupdlpx_iteration_callback_t)(
+		const cupdlpx_iteration_stats_t *stats, void *user_data);
+
 	typedef struct
 	{
 		int l_inf_ruiz_iterations;
@@ -92,6 +121,21 @@ extern "C"
 		restart_parameters_t restart_params;
 		double reflection_coefficient;
 		bool feasibility_polishing;
+		bool cuda_graph;
+		// run the plain iterations between evaluations in one cooperative kernel
+		bool persistent_iterations;
+		// keep only A on the device and scatter A^T y from its rows; also
+		// chosen when the transpose does not fit
+		bool transpose_free;
+		// directory of the on-disk setup cache, NULL to always set up afresh
+		const char *setup_cache_dir;
+		// sparsity patterns whose latest solution starts the next solve of the
+		// same pattern given no starting point, 0 to keep none
+		int solution_store_size;
+		// run the host side of a solve on the cpus next to the device
+		bool numa_affinity;
+		cupdlpx_iteration_callback_t iteration_callback;
+		void *callback_user_data;
 	} pdhg_parameters_t;
 
 	typedef struct
@@ -121,6 +165,8 @@ extern "C"
 		termination_reason_t termination_reason;
 		double feasibility_polishing_time;
 		int feasibility_iteration;
+		// device memory the setup allocated for this solve
+		size_t device_memory_bytes;
 	} cupdlpx_result_t;
 
 	// matrix formats
@@ -132,6 +178,20 @@ extern "C"
 		matrix_coo = 3
 	} matrix_format_t;
 
+	// element types of the index and value arrays of a matrix descriptor,
+	// see create_lp_problem_typed
+	typedef enum
+	{
+		matrix_int32 = 0,
+		matrix_int64 = 1
+	} matrix_index_type_t;
+
+	typedef enum
+	{
+		matrix_float64 = 0,
+		matrix_float32 = 1
+	} matrix_value_type_t;
+
 	// matrix descriptor
 	typedef struct
 	{
@@ -175,6 +235,9 @@ extern "C"
 		} data;
 	} matrix_desc_t;
 
+	// problem and device state kept between solves, see cupdlpx_solver_create
+	typedef struct cupdlpx_solver cupdlpx_solver_t;
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -18,8 +18,10 @@ limitations under the License.
 
 #include "cupdlpx_types.h"
 #include <cublas_v2.h>
+#include <cuda_runtime.h>
 #include <cusparse.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 typedef struct
 {
@@ -31,6 +33,63 @@ typedef struct
 	double *val;
 } cu_sparse_matrix_csr_t;
 
+// index ranges of variables (or rows) grouped by bound type:
+// [0, free_end) free, [free_end, lower_end) lower bound only,
+// [lower_end, upper_end) upper bound only, [upper_end, boxed_end) both bounds,
+// [boxed_end, n) fixed (equality rows)
+typedef struct
+{
+	int free_end;
+	int lower_end;
+	int upper_end;
+	int boxed_end;
+} bound_partition_t;
+
+// rows and columns of A that are dense enough to unbalance the CSR SpMV;
+// they are stored as dense vectors and removed from the sparse remainder
+typedef struct
+{
+	int num_rows;
+	int *row_index;
+	double *row_vals; // num_rows x num_variables, row major
+	int num_cols;
+	int *col_index;
+	double *col_vals; // num_cols x num_constraints, column major
+} dense_split_t;
+
+// matrices with few distinct coefficients are stored as the pattern plus a
+// one byte index per nonzero; the row and column scaling is applied on the fly
+typedef struct
+{
+	int num_values;
+	double *values;
+	unsigned char *codes;
+} coefficient_codes_t;
+
+// nonzero-balanced split of a skewed coded matrix for the merge-path SpMV;
+// num_partitions is zero when the rows are even enough for the lanes kernel
+typedef struct
+{
+	int num_partitions;
+	int *start_row; // device, num_partitions + 1
+	int *start_nz;	// device, num_partitions + 1
+} merge_path_t;
+
+// with no transpose stored, A^T y is scattered from the rows of A: one warp
+// per slice of rows and nonzeros sums into a private window over the columns
+// the slice touches, from col_begin on, and each column then adds up its
+// window entries in slice order
+typedef struct
+{
+	merge_path_t slices;
+	int *col_begin;		 // device, num_partitions
+	int *window_offset;	 // device, num_partitions + 1, into partials
+	int *column_ptr;	 // device, num_cols + 1
+	int *column_windows; // device, the partials entries of each column
+	int num_window_entries;
+	double *partials; // device, num_window_entries
+} dual_scatter_t;
+
 typedef struct
 {
 	int num_variables;
@@ -41,17 +100,33 @@ typedef struct
 	double objective_constant;
 	cu_sparse_matrix_csr_t *constraint_matrix;
 	cu_sparse_matrix_csr_t *constraint_matrix_t;
+	int num_dense_rows;
+	int num_dense_cols;
+	int *dense_row_index;
+	int *dense_col_index;
+	double *dense_rows;
+	double *dense_cols;
+	int num_coefficient_values;
+	double *coefficient_values;
+	unsigned char *constraint_matrix_codes;
+	unsigned char *constraint_matrix_t_codes;
+	int coded_row_lanes;
+	int coded_col_lanes;
+	merge_path_t row_merge_path;
+	merge_path_t col_merge_path;
+	double *coded_spmv_input; // followed by the merge-path carries
+	dual_scatter_t dual_scatter; // no slices while the transpose is stored
 	double *constraint_lower_bound;
 	double *constraint_upper_bound;
+	bound_partition_t variable_partition;
+	bound_partition_t constraint_partition;
+	int *variable_permutation;
+	int *constraint_permutation;
 	int num_blocks_primal;
 	int num_blocks_dual;
 	int num_blocks_primal_dual;
 	double objective_vector_norm;
 	double constraint_bound_norm;
-	double *constraint_lower_bound_finite_val;
-	double *constraint_upper_bound_finite_val;
-	double *variable_lower_bound_finite_val;
-	double *variable_upper_bound_finite_val;
 
 	double *initial_primal_solution;
 	double *current_primal_solution;
@@ -82,10 +157,8 @@ typedef struct
 	double rescaling_time_sec;
 	double cumulative_time_sec;
 
-	double *primal_residual;
 	double absolute_primal_residual;
 	double relative_primal_residual;
-	double *dual_residual;
 	double absolute_dual_residual;
 	double relative_dual_residual;
 	double primal_objective_value;
@@ -105,6 +178,9 @@ typedef struct
 	double last_trial_fixed_point_error;
 	int inner_count;
 
+	cudaStream_t stream;
+	// rows of a feasibility polish phase, buffered while both phases run
+	FILE *polish_log;
 	cusparseHandle_t sparse_handle;
 	cublasHandle_t blas_handle;
 	size_t spmv_buffer_size;
@@ -121,8 +197,21 @@ typedef struct
 	cusparseDnVecDescr_t vec_primal_prod;
 	cusparseDnVecDescr_t vec_dual_prod;
 
-	double *ones_primal_d;
-	double *ones_dual_d;
+	// vectors of length num_variables or num_constraints are slices of one
+	// allocation; the reduction buffer holds the per-block partial sums
+	void *vector_pool;
+	size_t vector_pool_bytes;
+	size_t device_memory_bytes;
+	double *reduction_buffer;
+
+	// one plain iteration captured as a graph and replayed between
+	// evaluations; the halpern weight comes from the device-side counter
+	cudaGraphExec_t plain_iteration_graph;
+	double graph_step_size;
+	double graph_primal_weight;
+	int *inner_count_d;
+	// or run in one cooperative kernel of this many blocks, zero when off
+	int persistent_blocks;
 
 	double feasibility_polishing_time;
 	int feasibility_iteration;
@@ -136,4 +225,13 @@ typedef struct
 	double con_bound_rescale;
 	double obj_vec_rescale;
 	double rescaling_time_sec;
+	bound_partition_t var_partition;
+	bound_partition_t con_partition;
+	int *var_perm;
+	int *con_perm;
+	dense_split_t dense;
+	coefficient_codes_t codes;
+	int num_blocks;
+	int num_linking_rows;
+	int num_linking_cols;
 } rescale_info_t;
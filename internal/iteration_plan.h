@@ -0,0 +1,43 @@
+/*
+Copyright 2025 Haihao Lu
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // the main loop mixes evaluation iterations, which compute residuals,
+    // check restarts or write the pdhg iterates, with plain iterations that
+    // only advance the halpern iteration and need nothing from the host
+
+    int get_print_frequency(int iter);
+
+    // true when iteration total_count neither evaluates, restarts, is a
+    // major iteration nor runs the major update kernels
+    bool is_plain_iteration(int total_count, int evaluation_frequency);
+
+    // number of consecutive plain iterations starting at total_count, at
+    // most max_count
+    int plain_iteration_run(int total_count, int evaluation_frequency,
+                            int max_count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -27,6 +27,14 @@ extern "C"
         const pdhg_parameters_t *params,
         const lp_problem_t *original_problem);
 
+    // redoes the vector part of rescale_problem for new bounds and objective
+    // of the same matrix, keeping the partitions and matrix scaling of info;
+    // the bound types must be unchanged
+    void rescale_problem_vectors(
+        const pdhg_parameters_t *params,
+        const lp_problem_t *original_problem,
+        rescale_info_t *rescale_info);
+
 #ifdef __cplusplus
 }
 #endif
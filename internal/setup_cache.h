@@ -0,0 +1,59 @@
+/*
+Copyright 2025 Haihao Lu
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#include "internal_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // FNV-1a over the matrix, the bound types and the parameters the matrix
+    // setup depends on; equal keys mean rescale_problem gives the same
+    // partitions, scaling and scaled matrix
+    uint64_t setup_cache_key(
+        const pdhg_parameters_t *params,
+        const lp_problem_t *problem);
+
+    // FNV-1a over the dimensions and the sparsity pattern alone, shared by
+    // problems that differ only in values
+    uint64_t setup_cache_pattern_key(const lp_problem_t *problem);
+
+    // the rescale info stored under key in dir, completed with the vectors
+    // of problem; NULL when there is no usable entry
+    rescale_info_t *setup_cache_load(
+        const char *dir,
+        uint64_t key,
+        const pdhg_parameters_t *params,
+        const lp_problem_t *problem,
+        double *step_size);
+
+    // writes the matrix part of info and the step size under key in dir,
+    // with checksums of problem's matrix and of the entry that the load
+    // compares; failures only print a warning, the cache is an optimization
+    void setup_cache_store(
+        const char *dir,
+        uint64_t key,
+        const lp_problem_t *problem,
+        const rescale_info_t *info,
+        double step_size);
+
+#ifdef __cplusplus
+}
+#endif
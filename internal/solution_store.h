@@ -0,0 +1,58 @@
+/*
+Copyright 2025 Haihao Lu
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#include "internal_types.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // a finished solve in the original space, with the primal weight it
+    // ended on and the step size of its matrix
+    typedef struct
+    {
+        uint64_t matrix_key;
+        int num_variables;
+        int num_constraints;
+        double *primal_solution;
+        double *dual_solution;
+        double primal_weight;
+        double step_size;
+    } stored_solution_t;
+
+    // a copy of the latest solution stored under pattern_key, NULL when
+    // there is none of these dimensions
+    stored_solution_t *solution_store_lookup(
+        uint64_t pattern_key,
+        int num_variables,
+        int num_constraints);
+
+    // keeps a copy of solution under pattern_key, replacing the previous one
+    // and dropping the least recently used keys beyond capacity
+    void solution_store_put(
+        int capacity,
+        uint64_t pattern_key,
+        const stored_solution_t *solution);
+
+    void stored_solution_free(stored_solution_t *solution);
+
+#ifdef __cplusplus
+}
+#endif
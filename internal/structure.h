@@ -0,0 +1,115 @@
+/*
+Copyright 2025 Haihao Lu
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#include "internal_types.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // stable order free | lower only | upper only | boxed | fixed, ordered
+    // by block inside each group when block is given; perm[new] = original index
+    bound_partition_t partition_by_bound_type(
+        const double *lower_bound,
+        const double *upper_bound,
+        const int *block,
+        int n,
+        int *perm);
+
+    // true when every entry falls in the same bound type under both pairs
+    // of bounds, so a partition of one also groups the other
+    bool same_bound_types(
+        const double *lower_a,
+        const double *upper_a,
+        const double *lower_b,
+        const double *upper_b,
+        int n);
+
+    // connected components of A once linking rows and columns are removed;
+    // returns the number of blocks, linking and isolated entries get that id
+    int detect_block_structure(
+        const lp_problem_t *prob,
+        int *var_block,
+        int *con_block,
+        int *num_linking_rows,
+        int *num_linking_cols);
+
+    // deep copy with variables and constraints reordered by the permutations
+    lp_problem_t *permute_problem(
+        const lp_problem_t *prob,
+        const int *var_perm,
+        const int *con_perm);
+
+    // moves dense rows and columns of the problem matrix into split and
+    // compacts the remaining sparse entries in place
+    void split_dense_rows_and_columns(
+        lp_problem_t *prob,
+        dense_split_t *split);
+
+    void dense_split_free(dense_split_t *split);
+
+    // replaces the sparse coefficients by indices into a table of the
+    // distinct unscaled values; false when there are too many of them
+    bool encode_coefficients(
+        const lp_problem_t *prob,
+        const double *con_rescale,
+        const double *var_rescale,
+        coefficient_codes_t *codes);
+
+    void coefficient_codes_free(coefficient_codes_t *codes);
+
+    // true when the longest row holds many times the mean row length
+    bool csr_rows_skewed(
+        const int *row_ptr,
+        int num_rows);
+
+    // partitions of equal share of row ends plus nonzeros
+    int merge_path_num_partitions(
+        int num_rows,
+        int nnz,
+        int items_per_partition);
+
+    // the start of every partition and the end of the last one: partition p
+    // covers rows [start_row[p], start_row[p + 1]) and nonzeros
+    // [start_nz[p], start_nz[p + 1]); both arrays hold num_partitions + 1
+    void merge_path_partitions(
+        const int *row_ptr,
+        int num_rows,
+        int items_per_partition,
+        int num_partitions,
+        int *start_row,
+        int *start_nz);
+
+    // dst[k] = src[perm[k]]
+    void permute_vector(
+        const double *src,
+        const int *perm,
+        int n,
+        double *dst);
+
+    // dst[perm[k]] = src[k]
+    void unpermute_vector(
+        const double *src,
+        const int *perm,
+        int n,
+        double *dst);
+
+#ifdef __cplusplus
+}
+#endif
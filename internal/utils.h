@@ -17,6 +17,7 @@ limitations under the License.
 #pragma once
 
 #include "internal_types.h"
+#include "iteration_plan.h"
 #include <cublas_v2.h>
 #include <cuda_runtime.h>
 #include <cusparse.h>
@@ -65,6 +66,9 @@ extern "C"
     } while (0)
 
 #define THREADS_PER_BLOCK 256
+#define REDUCTION_MAX_BLOCKS 1024
+#define REDUCTION_MAX_OUTPUTS 8
+#define REDUCTION_BUFFER_SIZE (REDUCTION_MAX_OUTPUTS * (REDUCTION_MAX_BLOCKS + 1))
 
     extern const double HOST_ONE;
     extern const double HOST_ZERO;
@@ -75,14 +79,41 @@ extern "C"
 
     void *safe_realloc(void *ptr, size_t new_size);
 
+    void compute_primal_product(
+        pdhg_solver_state_t *state,
+        const double *x,
+        double *out);
+
+    void compute_dual_product(
+        pdhg_solver_state_t *state,
+        const double *y,
+        double *out);
+
     double estimate_maximum_singular_value(
-        cusparseHandle_t sparse_handle,
-        cublasHandle_t blas_handle,
-        const cu_sparse_matrix_csr_t *A,
-        const cu_sparse_matrix_csr_t *AT,
+        pdhg_solver_state_t *state,
         int max_iterations,
         double tolerance);
 
+    // deterministic reductions: the grid depends only on the length and the
+    // partial sums are folded in a fixed order, so results are reproducible
+    double get_vector_dot(
+        pdhg_solver_state_t *state,
+        int n,
+        const double *x,
+        const double *y);
+
+    double get_vector_norm(
+        pdhg_solver_state_t *state,
+        int n,
+        const double *x);
+
+    // ||delta primal||^2, ||delta dual||^2 and <dual product, delta primal>
+    void get_movement_sums(
+        pdhg_solver_state_t *state,
+        double *primal_sq,
+        double *dual_sq,
+        double *cross_term);
+
     void compute_interaction_and_movement(
         pdhg_solver_state_t *solver_state,
         double *interaction,
@@ -97,7 +128,7 @@ extern "C"
         pdhg_solver_state_t *solver_state,
         const termination_criteria_t *criteria);
 
-    void print_initial_info(const pdhg_parameters_t *params, const lp_problem_t *problem);
+    void print_initial_info(const pdhg_parameters_t *params, const lp_problem_t *problem, const rescale_info_t *rescale_info, const pdhg_solver_state_t *state);
 
     void pdhg_final_log(
         const pdhg_solver_state_t *solver_state,
@@ -108,21 +139,34 @@ extern "C"
 
     const char *termination_reason_to_string(termination_reason_t reason);
 
-    int get_print_frequency(int iter);
-
     void compute_residual(pdhg_solver_state_t *state);
 
     void compute_infeasibility_information(pdhg_solver_state_t *state);
 
     void fill_or_copy(double **dest, int n, const double *src, double fill_value);
 
-    int dense_to_csr(const matrix_desc_t *desc,
+    // restricts the calling thread to the cpus of the current device's NUMA
+    // node; returns the previous mask for restore_thread_cpus, or NULL when
+    // the node is unknown and nothing changed
+    void *pin_thread_to_device_cpus(void);
+
+    void restore_thread_cpus(void *previous);
+
+    // the conversions read the index and value arrays of desc as the given
+    // element types and produce int and double CSR arrays
+    int dense_to_csr(const matrix_desc_t *desc, matrix_value_type_t value_type,
                      int **row_ptr, int **col_ind, double **vals, int *nnz_out);
 
-    int csc_to_csr(const matrix_desc_t *desc,
+    int csr_to_csr(const matrix_desc_t *desc, matrix_index_type_t index_type,
+                   matrix_value_type_t value_type,
+                   int **row_ptr, int **col_ind, double **vals, int *nnz_out);
+
+    int csc_to_csr(const matrix_desc_t *desc, matrix_index_type_t index_type,
+                   matrix_value_type_t value_type,
                    int **row_ptr, int **col_ind, double **vals, int *nnz_out);
 
-    int coo_to_csr(const matrix_desc_t *desc,
+    int coo_to_csr(const matrix_desc_t *desc, matrix_index_type_t index_type,
+                   matrix_value_type_t value_type,
                    int **row_ptr, int **col_ind, double **vals, int *nnz_out);
 
     void check_feas_polishing_termination_criteria(
@@ -130,7 +174,7 @@ extern "C"
         const termination_criteria_t *criteria,
         bool is_primal_polish);
 
-    void print_initial_feas_polish_info(bool is_primal_polish, const pdhg_parameters_t *params);
+    void print_initial_feas_polish_info(const pdhg_parameters_t *params);
 
     void display_feas_polish_iteration_stats(const pdhg_solver_state_t *state, bool verbose,  bool is_primal_polish);
 
@@ -140,6 +184,8 @@ extern "C"
 
     void compute_dual_feas_polish_residual(pdhg_solver_state_t *state, const pdhg_solver_state_t *ori_state);
 
+    void compute_dual_feas_polish_objective(pdhg_solver_state_t *state, const pdhg_solver_state_t *ori_state);
+
     void set_default_parameters(pdhg_parameters_t *params);
 
 #ifdef __cplusplus
@@ -22,6 +22,7 @@ PRIMAL_INFEASIBLE = 1
 DUAL_INFEASIBLE   = 2
 TIME_LIMIT        = 3
 ITERATION_LIMIT   = 4
+USER_INTERRUPT    = 5
 UNSPECIFIED       = -1
 
 
@@ -53,6 +54,16 @@ _PARAM_ALIAS = {
     # feasibility polishing
     "FeasibilityPolishing": "feasibility_polishing",
     "FeasibilityPolishingTol": "eps_feas_polish_relative",
+    # iteration replay
+    "CudaGraph": "cuda_graph",
+    "PersistentIterations": "persistent_iterations",
+    # matrix storage
+    "TransposeFree": "transpose_free",
+    # host placement
+    "NumaAffinity": "numa_affinity",
+    # setup cache and solution store
+    "SetupCacheDir": "setup_cache_dir",
+    "SolutionStoreSize": "solution_store_size",
     # singular value estimation (power method)
     "SVMaxIter": "sv_max_iter",
     "SVTol": "sv_tol",
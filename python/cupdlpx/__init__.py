@@ -13,9 +13,11 @@
 # limitations under the License.
 
 from .model import Model
+from .batch import solve_many
+from ._core import clear_solution_store
 from . import PDLP
 
-__all__ = ["Model"]
+__all__ = ["Model", "solve_many", "clear_solution_store"]
 
 # versioning
 from importlib.metadata import version, PackageNotFoundError
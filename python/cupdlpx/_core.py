@@ -12,4 +12,10 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 
-from ._cupdlpx_core import solve_once, get_default_params
\ No newline at end of file
+from ._cupdlpx_core import (
+    Solver,
+    clear_solution_store,
+    get_default_params,
+    solve_batch,
+    solve_once,
+)
\ No newline at end of file
@@ -0,0 +1,45 @@
+# Copyright 2025 Haihao Lu
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import annotations
+from typing import Optional, Sequence
+
+from ._core import solve_batch
+from .model import Model
+
+
+def solve_many(models: Sequence[Model], max_workers: Optional[int] = None) -> list[Model]:
+    """
+    Optimize several models at once on a pool of native threads, with the GIL
+    released for the whole batch. Each thread issues its solves on its own
+    CUDA stream. Results are stored on the models as by Model.optimize();
+    the models are returned in input order.
+
+    Every solve keeps its setup on the device while it runs, so max_workers
+    bounds the device memory of the batch. It defaults to 2.
+    """
+    models = list(models)
+    if len({id(m) for m in models}) != len(models):
+        raise ValueError("solve_many: a model appears more than once.")
+    # all inputs are converted and pushed before any solve starts
+    for m in models:
+        m._prepare_solve()
+    infos = solve_batch(
+        [m._solver for m in models],
+        [m._params for m in models],
+        max_workers=0 if max_workers is None else int(max_workers),
+    )
+    for m, info in zip(models, infos):
+        m._store_result(info)
+    return models
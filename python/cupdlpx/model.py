@@ -14,12 +14,12 @@
 
 from __future__ import annotations
 import warnings
-from typing import Any, Optional, Union
+from typing import Any, Callable, Optional, Union
 
 import numpy as np
 import scipy.sparse as sp
 
-from ._core import solve_once, get_default_params
+from ._core import Solver, get_default_params
 from . import PDLP
 
 # array-like type
@@ -48,6 +48,20 @@ def _as_csr_f64_i32(A: sp.spmatrix) -> sp.csr_matrix:
     csr.sort_indices()
     return csr
 
+def _as_sparse(A: sp.spmatrix) -> sp.spmatrix:
+    """
+    Keep CSR, CSC and COO inputs with float32/float64 values and int32/int64
+    indices as they are, the core converts them to int32 float64 CSR in one
+    parallel pass; every other sparse input goes through CSR here.
+    """
+    if A.format not in ("csr", "csc", "coo"):
+        return _as_csr_f64_i32(A)
+    if A.dtype not in (np.float32, np.float64):
+        A = A.astype(np.float64)
+    if A.format == "csr" and not A.has_sorted_indices:
+        A = A.sorted_indices()
+    return A
+
 
 class _ParamsView:
     """
@@ -109,6 +123,11 @@ class Model:
         m, n = constraint_matrix.shape
         self.num_vars = int(n)
         self.num_constrs = int(m)
+        # native solver kept across optimize() calls and the parts of the
+        # model changed since it last saw them
+        self._solver: Optional[Solver] = None
+        self._solver_sign = 1
+        self._dirty: set[str] = set()
         # sense
         self.ModelSense = PDLP.MINIMIZE
         # always start from backend defaults PDLP params
@@ -137,6 +156,7 @@ class Model:
         self._iter: Optional[int] = None # number of iterations
         self._runtime: Optional[float] = None # runtime
         self._rescale_time: Optional[float] = None # rescale time
+        self._device_memory: Optional[int] = None # device memory of the setup
         self._rel_p_res: Optional[float] = None # relative primal residual
         self._rel_d_res: Optional[float] = None # relative dual residual
         self._max_p_ray: Optional[float] = None # maximum primal ray
@@ -155,6 +175,7 @@ class Model:
             raise ValueError(f"setObjectiveVector: c must be 1D, got shape {self.c.shape}")
         if self.c.size != self.num_vars:
             raise ValueError(f"setObjectiveVector: length {self.c.size} != self.num_vars ({self.num_vars})")
+        self._dirty.add("objective")
         # clear cached solution
         self._clear_solution_cache()
 
@@ -164,6 +185,7 @@ class Model:
         Minimal check: convert to float.
         """
         self.c0 = float(c0)
+        self._dirty.add("objective")
         # clear cached solution
         self._clear_solution_cache()
 
@@ -177,9 +199,11 @@ class Model:
             raise ValueError(f"setConstraintMatrix: A must be 2D, got shape {A_like.shape}")
         if A_like.shape[1] != self.num_vars:
             raise ValueError(f"setConstraintMatrix: A shape {A_like.shape} does not match number of variables ({self.num_vars})")
-        # store as float64
+        # store as float64, or as given for sparse inputs the core converts
         if sp.issparse(A_like):
-            self.A = _as_csr_f64_i32(A_like)
+            self.A = _as_sparse(A_like)
+        elif A_like.dtype == np.float32:
+            self.A = np.ascontiguousarray(A_like)
         else:
             self.A = _as_dense_f64_c(A_like)
         # problem dimensions
@@ -204,6 +228,8 @@ class Model:
                     f"setConstraintMatrix: constraint_upper_bound length {u.size} != rows {self.num_constrs}. "
                     f"Call setConstraintUpperBound(...) to update it."
                )
+        # a new matrix needs a new native solver
+        self._solver = None
         # clear cached solution
         self._clear_solution_cache()
 
@@ -214,6 +240,7 @@ class Model:
         # check if the input is None
         if constr_lb is None:
             self.constr_lb = None
+            self._dirty.add("constraint_bounds")
             # clear cached solution
             self._clear_solution_cache()
             return
@@ -224,6 +251,7 @@ class Model:
                 f"setConstraintLowerBound: length {constr_lb.size} != self.num_constrs ({self.num_constrs})"
             )
         self.constr_lb = constr_lb
+        self._dirty.add("constraint_bounds")
         # clear cached solution
         self._clear_solution_cache()
 
@@ -234,6 +262,7 @@ class Model:
         # check if the input is None
         if constr_ub is None:
             self.constr_ub = None
+            self._dirty.add("constraint_bounds")
             # clear cached solution
             self._clear_solution_cache()
             return
@@ -244,6 +273,7 @@ class Model:
                 f"setConstraintUpperBound: length {constr_ub.size} != self.num_constrs ({self.num_constrs})"
             )
         self.constr_ub = constr_ub
+        self._dirty.add("constraint_bounds")
         # clear cached solution
         self._clear_solution_cache()
 
@@ -254,6 +284,7 @@ class Model:
         # check if the input is None
         if lb is None:
             self.lb = None
+            self._dirty.add("variable_bounds")
             # clear cached solution
             self._clear_solution_cache()
             return
@@ -264,6 +295,7 @@ class Model:
                 f"setVariableLowerBound: length {lb.size} != self.num_vars ({self.num_vars})"
             )
         self.lb = lb
+        self._dirty.add("variable_bounds")
         # clear cached solution
         self._clear_solution_cache()
 
@@ -274,6 +306,7 @@ class Model:
         # check if the input is None
         if ub is None:
             self.ub = None
+            self._dirty.add("variable_bounds")
             # clear cached solution
             self._clear_solution_cache()
             return
@@ -284,6 +317,7 @@ class Model:
                 f"setVariableUpperBound: length {ub.size} != self.num_vars ({self.num_vars})"
             )
         self.ub = ub
+        self._dirty.add("variable_bounds")
         # clear cached solution
         self._clear_solution_cache()
 
@@ -345,9 +379,18 @@ class Model:
         for k, v in kwargs.items():
             self.setParam(k, v)
 
-    def optimize(self):
+    def optimize(self, callback: Optional[Callable[[Any], Optional[bool]]] = None):
         """
         Solve the linear programming problem using the cuPDLPx solver.
+        The optional callback receives an IterationStats object at every
+        major iteration and stops the solve by returning False.
+        """
+        self._prepare_solve()
+        self._store_result(self._solver.solve(self._params, callback))
+
+    def _prepare_solve(self) -> None:
+        """
+        Bring the native solver up to date with the model.
         """
         # clear cached solution
         self._clear_solution_cache()
@@ -359,20 +402,30 @@ class Model:
         # effective objective based on sense
         c_eff  = sign * self.c if self.c is not None else None
         c0_eff = sign * self.c0 if self.c0 is not None else None
-        # call the core solver
-        info = solve_once(
-            self.A,
-            c_eff,
-            c0_eff,
-            self.lb,
-            self.ub,
-            self.constr_lb,
-            self.constr_ub,
-            zero_tolerance=0.0,
-            params=self._params,
-            primal_start=self._primal_start,
-            dual_start=self._dual_start
-        )
+        # set up the native solver once, afterwards only push what changed
+        if self._solver is None:
+            self._solver = Solver(
+                self.A,
+                c_eff,
+                c0_eff,
+                self.lb,
+                self.ub,
+                self.constr_lb,
+                self.constr_ub,
+                zero_tolerance=0.0,
+            )
+            self._solver_sign = sign
+            self._dirty.clear()
+        else:
+            self._push_changes(sign)
+        # without a warm start the solver starts from its previous solution
+        self._solver.set_warm_start(self._primal_start, self._dual_start)
+
+    def _store_result(self, info: dict) -> None:
+        """
+        Fill the solution attributes from the info dict of a solve.
+        """
+        sign = self._solver_sign
         # solutions
         self._x = np.asarray(info.get("X")) if info.get("X") is not None else None
         self._y = np.asarray(info.get("Pi")) if info.get("Pi") is not None else None
@@ -389,6 +442,7 @@ class Model:
         self._iter = int(info.get("Iterations")) if info.get("Iterations") is not None else None
         self._runtime = info.get("RuntimeSec")
         self._rescale_time = info.get("RescalingTimeSec")
+        self._device_memory = info.get("DeviceMemoryBytes")
         # residuals
         self._rel_p_res = info.get("RelativePrimalResidual")
         self._rel_d_res = info.get("RelativeDualResidual")
@@ -400,6 +454,28 @@ class Model:
         self._p_ray_lin_obj = sign * p_ray_lin_eff if p_ray_lin_eff is not None else None
         self._d_ray_obj = sign * d_ray_obj_eff if d_ray_obj_eff is not None else None
 
+    def _push_changes(self, sign: int) -> None:
+        """
+        Hand the vectors changed since the last optimize() to the native solver.
+        """
+        if sign != self._solver_sign:
+            self._dirty.add("objective")
+            self._solver_sign = sign
+        update = {}
+        if "objective" in self._dirty:
+            update["objective_vector"] = sign * self.c
+            update["objective_constant"] = sign * self.c0
+        # None means unchanged to the solver, so defaults are spelled out
+        if "variable_bounds" in self._dirty:
+            update["variable_lower_bound"] = self._bound(self.lb, self.num_vars, -np.inf)
+            update["variable_upper_bound"] = self._bound(self.ub, self.num_vars, np.inf)
+        if "constraint_bounds" in self._dirty:
+            update["constraint_lower_bound"] = self._bound(self.constr_lb, self.num_constrs, -np.inf)
+            update["constraint_upper_bound"] = self._bound(self.constr_ub, self.num_constrs, np.inf)
+        if update:
+            self._solver.update(**update)
+        self._dirty.clear()
+
     def _clear_solution_cache(self) -> None:
         """
         Clear cached solution attributes.
@@ -411,10 +487,51 @@ class Model:
         self._status_code = None
         self._iter = None
         self._runtime = self._rescale_time = None
+        self._device_memory = None
         self._rel_p_res = None
         self._rel_d_res = None
         self._max_p_ray = self._max_d_ray = None
         self._p_ray_lin_obj = self._d_ray_obj = None
+        self._derived = {}
+
+    def _bound(self, v: Optional[np.ndarray], n: int, fill: float) -> np.ndarray:
+        """
+        Bound vector as passed to the solver, with the solver's default for None.
+        """
+        return np.full(n, fill) if v is None else np.asarray(v, dtype=np.float64)
+
+    def _derive(self, name: str):
+        """
+        Vectors derived from X and Pi, computed on first access and cached
+        until the next solve or model change.
+        """
+        if self._x is None or self._y is None:
+            return None
+        if name not in self._derived:
+            if name in ("Slack", "PrimalResidual"):
+                ax = self.A @ self._x
+                l = self._bound(self.constr_lb, self.num_constrs, -np.inf)
+                u = self._bound(self.constr_ub, self.num_constrs, np.inf)
+                if name == "Slack":
+                    self._derived[name] = np.minimum(ax - l, u - ax)
+                else:
+                    self._derived[name] = ax - np.clip(ax, l, u)
+            elif name == "RC":
+                # Pi belongs to the minimization of the negated objective
+                # under MAXIMIZE, so A^T Pi changes sign with the sense
+                sign = 1 if self.ModelSense == PDLP.MINIMIZE else -1
+                self._derived[name] = self.c - sign * (self.A.T @ self._y)
+            elif name == "DualResidual":
+                sign = 1 if self.ModelSense == PDLP.MINIMIZE else -1
+                rc = sign * self._derive("RC")
+                lb = self._bound(self.lb, self.num_vars, -np.inf)
+                ub = self._bound(self.ub, self.num_vars, np.inf)
+                # in the minimization form a reduced cost may be positive at
+                # a finite lower bound and negative at a finite upper bound
+                lo = np.where(np.isfinite(ub), -np.inf, 0.0)
+                hi = np.where(np.isfinite(lb), np.inf, 0.0)
+                self._derived[name] = sign * (rc - np.clip(rc, lo, hi))
+        return self._derived[name]
 
     @property
     def X(self) -> Optional[np.ndarray]:
@@ -424,6 +541,22 @@ class Model:
     def Pi(self) -> Optional[np.ndarray]:
         return self._y
 
+    @property
+    def Slack(self) -> Optional[np.ndarray]:
+        return self._derive("Slack")
+
+    @property
+    def RC(self) -> Optional[np.ndarray]:
+        return self._derive("RC")
+
+    @property
+    def PrimalResidual(self) -> Optional[np.ndarray]:
+        return self._derive("PrimalResidual")
+
+    @property
+    def DualResidual(self) -> Optional[np.ndarray]:
+        return self._derive("DualResidual")
+
     @property
     def ObjVal(self) -> Optional[float]:
         return self._objval
@@ -460,6 +593,10 @@ class Model:
     def RescalingTime(self) -> Optional[float]:
         return self._rescale_time
 
+    @property
+    def DeviceMemory(self) -> Optional[int]:
+        return self._device_memory
+
     @property
     def RelPrimalResidual(self) -> Optional[float]:
         return self._rel_p_res
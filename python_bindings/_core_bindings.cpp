@@ -14,14 +14,19 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
-#include <cstring>
-#include <limits>
+#include <cstdio>
+#include <memory>
+#include <set>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "cupdlpx.h"
@@ -33,38 +38,18 @@ struct MatrixKeepalive
 {
     // keep every owner to prolong lifetime
     std::vector<py::object> owners;
-    // temporary storage for index downcast
-    std::vector<int32_t> tmp_rowptr, tmp_colind;
-    std::vector<int32_t> tmp_row, tmp_col;
 };
 
 // view of matrix with keepalive
 struct PyMatrixView
 {
     matrix_desc_t desc{};
+    // element types of the index and value arrays behind desc
+    matrix_index_type_t index_type = matrix_int32;
+    matrix_value_type_t value_type = matrix_float64;
     MatrixKeepalive keep;
 };
 
-// get contiguous double numpy array
-static py::array get_array_f64_c_contig(py::object obj, const char *name)
-{
-    // nullptr if obj is None
-    if (!obj || obj.is_none())
-    {
-        throw std::invalid_argument(std::string(name) + " is None.");
-    }
-    // cast to numpy array
-    py::array arr = py::cast<py::array>(obj);
-    // must have at least 1 dim
-    if (arr.ndim() <= 0)
-    {
-        throw std::invalid_argument(std::string(name) + " must be array.");
-    }
-    // make contiguous double array
-    py::array_t<double, py::array::c_style | py::array::forcecast> out(arr);
-    return py::reinterpret_borrow<py::array>(out);
-}
-
 // get double pointer to contiguous 1D numpy array
 static const double *get_arr_ptr_f64_or_null(py::object obj, const char *name, MatrixKeepalive &keep)
 {
@@ -88,53 +73,74 @@ static const double *get_arr_ptr_f64_or_null(py::object obj, const char *name, M
     return out.data();
 }
 
-// get int32 pointer to contiguous numpy array
-static const int32_t *get_index_ptr_i32(py::object obj, const char *name,
-                                        MatrixKeepalive &keep, std::vector<int32_t> &tmp_vec)
+// get pointer to contiguous 1D numpy array of the given type
+template <typename T>
+static const void *get_typed_ptr(py::array arr, MatrixKeepalive &keep)
+{
+    py::array_t<T, py::array::c_style | py::array::forcecast> out(arr);
+    keep.owners.push_back(out);
+    return out.data();
+}
+
+// cast to 1D numpy array
+static py::array get_1d_array(py::object obj, const char *name)
 {
     // nullptr if obj is None
     if (!obj || obj.is_none())
     {
         throw std::invalid_argument(std::string(name) + " is None.");
     }
-    // cast to numpy array
     py::array arr = py::cast<py::array>(obj);
-    // must have at least 1 dim
     if (arr.ndim() != 1)
     {
         throw std::invalid_argument(std::string(name) + " must be 1D.");
     }
-    // make int32 array
-    const auto dt = py::dtype(arr.dtype());
-    constexpr int64_t I32_MAX = std::numeric_limits<int32_t>::max();
-    // contiguous int32 array
-    if (dt.equal(py::dtype::of<int32_t>()))
+    return arr;
+}
+
+// get both index arrays of a sparse matrix as they are when they are int32
+// or int64; one int64 array makes the other int64 too
+static void get_index_ptrs(py::object a_obj, const char *a_name,
+                           py::object b_obj, const char *b_name,
+                           PyMatrixView &out, const void **a, const void **b)
+{
+    py::array a_arr = get_1d_array(a_obj, a_name);
+    py::array b_arr = get_1d_array(b_obj, b_name);
+    const auto a_dt = py::dtype(a_arr.dtype());
+    const auto b_dt = py::dtype(b_arr.dtype());
+    const auto i32 = py::dtype::of<int32_t>();
+    const auto i64 = py::dtype::of<int64_t>();
+    if (!(a_dt.equal(i32) || a_dt.equal(i64)))
+    {
+        throw std::invalid_argument(std::string(a_name) + " must be int32 or int64.");
+    }
+    if (!(b_dt.equal(i32) || b_dt.equal(i64)))
     {
-        py::array_t<int32_t, py::array::c_style | py::array::forcecast> out(arr);
-        keep.owners.push_back(out);
-        return out.data();
+        throw std::invalid_argument(std::string(b_name) + " must be int32 or int64.");
     }
-    // int64 -> int32 with range check
-    if (dt.equal(py::dtype::of<int64_t>()))
+    if (a_dt.equal(i64) || b_dt.equal(i64))
     {
-        py::array_t<int64_t, py::array::c_style | py::array::forcecast> a(arr);
-        const int64_t *p = a.data();
-        const py::ssize_t n = a.size();
-        tmp_vec.resize(static_cast<size_t>(n));
-        for (py::ssize_t i = 0; i < n; ++i)
-        {
-            int64_t v = p[i];
-            if (v < 0 || v > I32_MAX)
-            {
-                throw std::overflow_error(std::string(name) + " has value out of int32 range; "
-                                                              "backend currently supports only 32-bit indices.");
-            }
-            tmp_vec[static_cast<size_t>(i)] = static_cast<int32_t>(v);
-        }
-        return tmp_vec.data();
+        out.index_type = matrix_int64;
+        *a = get_typed_ptr<int64_t>(a_arr, out.keep);
+        *b = get_typed_ptr<int64_t>(b_arr, out.keep);
+        return;
+    }
+    out.index_type = matrix_int32;
+    *a = get_typed_ptr<int32_t>(a_arr, out.keep);
+    *b = get_typed_ptr<int32_t>(b_arr, out.keep);
+}
+
+// get matrix values as they are when float32 or float64, other types are
+// cast to float64
+static const void *get_value_ptr(py::array arr, PyMatrixView &out)
+{
+    if (py::dtype(arr.dtype()).equal(py::dtype::of<float>()))
+    {
+        out.value_type = matrix_float32;
+        return get_typed_ptr<float>(arr, out.keep);
     }
-    // unsupported dtype
-    throw std::invalid_argument(std::string(name) + " must be int32 or int64.");
+    out.value_type = matrix_float64;
+    return get_typed_ptr<double>(arr, out.keep);
 }
 
 // ensure 1D array or None with expected length
@@ -176,6 +182,8 @@ static const char *status_to_str(termination_reason_t r)
         return "ITERATION_LIMIT";
     case TERMINATION_REASON_FEAS_POLISH_SUCCESS:
         return "FEAS_POLISH_SUCCESS";
+    case TERMINATION_REASON_USER_INTERRUPT:
+        return "USER_INTERRUPT";
     case TERMINATION_REASON_UNSPECIFIED:
         return "UNSPECIFIED";
     default:
@@ -198,6 +206,8 @@ static int status_to_code(termination_reason_t r)
         return 3;
     case TERMINATION_REASON_ITERATION_LIMIT:
         return 4;
+    case TERMINATION_REASON_USER_INTERRUPT:
+        return 5;
     case TERMINATION_REASON_UNSPECIFIED:
     default:
         return -1;
@@ -248,9 +258,31 @@ static py::dict get_default_params_py()
     d["sv_max_iter"] = p.sv_max_iter;
     d["sv_tol"] = p.sv_tol;
 
+    // iteration replay
+    d["cuda_graph"] = p.cuda_graph;
+    d["persistent_iterations"] = p.persistent_iterations;
+
+    // matrix storage
+    d["transpose_free"] = p.transpose_free;
+
+    // host placement
+    d["numa_affinity"] = p.numa_affinity;
+
+    // setup cache
+    d["setup_cache_dir"] = py::none();
+    d["solution_store_size"] = p.solution_store_size;
+
     return d;
 }
 
+// the parameters keep a plain pointer to the cache directory, so the
+// strings live as long as the module; called with the GIL held
+static const char *intern_path(const std::string &path)
+{
+    static std::set<std::string> paths;
+    return paths.insert(path).first->c_str();
+}
+
 // parse parameters from Python dict
 static void parse_params_from_python(py::object params_obj, pdhg_parameters_t *p)
 {
@@ -301,6 +333,21 @@ static void parse_params_from_python(py::object params_obj, pdhg_parameters_t *p
     // power method for singular value estimation
     geti("sv_max_iter", p->sv_max_iter);
     getf("sv_tol", p->sv_tol);
+
+    // iteration replay
+    getb("cuda_graph", p->cuda_graph);
+    getb("persistent_iterations", p->persistent_iterations);
+
+    // matrix storage
+    getb("transpose_free", p->transpose_free);
+
+    // host placement
+    getb("numa_affinity", p->numa_affinity);
+
+    // setup cache
+    if (d.contains("setup_cache_dir") && !d["setup_cache_dir"].is_none())
+        p->setup_cache_dir = intern_path(py::str(d["setup_cache_dir"]));
+    geti("solution_store_size", p->solution_store_size);
 }
 
 // view of matrix from Python
@@ -326,17 +373,15 @@ static PyMatrixView get_matrix_from_python(py::object A, double zero_tol)
     // numpy ndarray as dense matrix
     if (py::isinstance<py::array>(A))
     {
-        py::array d = get_array_f64_c_contig(A, "dense matrix (float64)"); // get contiguous data array
-        auto req = d.request();
-        if (req.ndim != 2)
+        py::array d = py::cast<py::array>(A);
+        if (d.ndim() != 2)
         {
             throw std::invalid_argument("dense matrix must be 2D");
         }
-        desc.m = static_cast<int>(req.shape[0]);
-        desc.n = static_cast<int>(req.shape[1]);
+        desc.m = static_cast<int>(d.shape(0));
+        desc.n = static_cast<int>(d.shape(1));
         desc.fmt = matrix_dense;
-        desc.data.dense.A = static_cast<const double *>(req.ptr);
-        out.keep.owners.push_back(d); // keep alive
+        desc.data.dense.A = static_cast<const double *>(get_value_ptr(d, out)); // float32 or float64, contiguous
         return out;
     }
 
@@ -350,13 +395,14 @@ static PyMatrixView get_matrix_from_python(py::object A, double zero_tol)
         py::object rp = A.attr("indptr");
         py::object ci = A.attr("indices");
         py::object vv = A.attr("data");
-        py::array v64 = get_array_f64_c_contig(vv, "csr.data(float64)"); // get contiguous data array
+        py::array v = get_1d_array(vv, "csr.data");
+        const void *row_ptr, *col_ind;
+        get_index_ptrs(rp, "csr.indptr", ci, "csr.indices", out, &row_ptr, &col_ind);
         desc.fmt = matrix_csr;
-        desc.data.csr.nnz = static_cast<int>(v64.size());
-        desc.data.csr.row_ptr = get_index_ptr_i32(rp, "csr.indptr", out.keep, out.keep.tmp_rowptr);
-        desc.data.csr.col_ind = get_index_ptr_i32(ci, "csr.indices", out.keep, out.keep.tmp_colind);
-        desc.data.csr.vals = static_cast<const double *>(v64.request().ptr);
-        out.keep.owners.push_back(v64); // keep alive
+        desc.data.csr.nnz = static_cast<int>(v.size());
+        desc.data.csr.row_ptr = static_cast<const int *>(row_ptr);
+        desc.data.csr.col_ind = static_cast<const int *>(col_ind);
+        desc.data.csr.vals = static_cast<const double *>(get_value_ptr(v, out));
         return out;
     }
     // CSC
@@ -365,13 +411,14 @@ static PyMatrixView get_matrix_from_python(py::object A, double zero_tol)
         py::object cp = A.attr("indptr");
         py::object ri = A.attr("indices");
         py::object vv = A.attr("data");
-        py::array v64 = get_array_f64_c_contig(vv, "csc.data(float64)"); // get contiguous data array
+        py::array v = get_1d_array(vv, "csc.data");
+        const void *col_ptr, *row_ind;
+        get_index_ptrs(cp, "csc.indptr", ri, "csc.indices", out, &col_ptr, &row_ind);
         desc.fmt = matrix_csc;
-        desc.data.csc.nnz = static_cast<int>(v64.size());
-        desc.data.csc.col_ptr = get_index_ptr_i32(cp, "csc.indptr", out.keep, out.keep.tmp_rowptr);
-        desc.data.csc.row_ind = get_index_ptr_i32(ri, "csc.indices", out.keep, out.keep.tmp_colind);
-        desc.data.csc.vals = static_cast<const double *>(v64.request().ptr);
-        out.keep.owners.push_back(v64); // keep alive
+        desc.data.csc.nnz = static_cast<int>(v.size());
+        desc.data.csc.col_ptr = static_cast<const int *>(col_ptr);
+        desc.data.csc.row_ind = static_cast<const int *>(row_ind);
+        desc.data.csc.vals = static_cast<const double *>(get_value_ptr(v, out));
         return out;
     }
     // COO
@@ -380,13 +427,14 @@ static PyMatrixView get_matrix_from_python(py::object A, double zero_tol)
         py::object rr = A.attr("row");
         py::object cc = A.attr("col");
         py::object vv = A.attr("data");
-        py::array v64 = get_array_f64_c_contig(vv, "coo.data(float64)"); // get contiguous data array
+        py::array v = get_1d_array(vv, "coo.data");
+        const void *row_ind, *col_ind;
+        get_index_ptrs(rr, "coo.row", cc, "coo.col", out, &row_ind, &col_ind);
         desc.fmt = matrix_coo;
-        desc.data.coo.nnz = static_cast<int>(v64.size());
-        desc.data.coo.row_ind = get_index_ptr_i32(rr, "coo.row", out.keep, out.keep.tmp_row);
-        desc.data.coo.col_ind = get_index_ptr_i32(cc, "coo.col", out.keep, out.keep.tmp_col);
-        desc.data.coo.vals = static_cast<const double *>(v64.request().ptr);
-        out.keep.owners.push_back(v64); // keep alive
+        desc.data.coo.nnz = static_cast<int>(v.size());
+        desc.data.coo.row_ind = static_cast<const int *>(row_ind);
+        desc.data.coo.col_ind = static_cast<const int *>(col_ind);
+        desc.data.coo.vals = static_cast<const double *>(get_value_ptr(v, out));
         return out;
     }
 
@@ -394,6 +442,139 @@ static PyMatrixView get_matrix_from_python(py::object A, double zero_tol)
     throw std::invalid_argument("Unsupported matrix A: expected numpy.ndarray or scipy.sparse (csr/csc/coo)");
 }
 
+// build the problem of a matrix view; a CSR matrix of int32 and float64
+// arrays is borrowed from view, which must outlive the problem, and any
+// other matrix is converted by the core in one pass
+static lp_problem_t *create_problem(const PyMatrixView &view,
+                                    const double *c, const double *l, const double *u,
+                                    const double *lb, const double *ub, const double *c0)
+{
+    lp_problem_t *prob;
+    if (view.index_type == matrix_int32 && view.value_type == matrix_float64)
+        prob = create_lp_problem_borrowed(c, &view.desc, l, u, lb, ub, c0);
+    else
+        prob = create_lp_problem_typed(c, &view.desc, view.index_type, view.value_type,
+                                       l, u, lb, ub, c0);
+    if (!prob)
+    {
+        throw std::runtime_error("create_lp_problem failed.");
+    }
+    return prob;
+}
+
+// shared by the solves of one call while the GIL is released; at major
+// iterations the trampoline takes the GIL to run the Python callback and to
+// poll for signals such as Ctrl-C, the latter at most every SIGNAL_POLL
+struct InterruptContext
+{
+    static constexpr std::chrono::milliseconds SIGNAL_POLL{100};
+
+    py::object callback = py::none();
+    bool has_callback = false;
+    std::atomic<bool> stop{false};
+    std::atomic<int64_t> last_poll_ns{0};
+    // first error raised by the callback or a signal handler
+    std::unique_ptr<py::error_already_set> error;
+
+    explicit InterruptContext(py::object cb = py::none())
+        : callback(cb), has_callback(!cb.is_none()) {}
+
+    void install(pdhg_parameters_t &p)
+    {
+        p.iteration_callback = &InterruptContext::trampoline;
+        p.callback_user_data = this;
+    }
+
+    // re-raise what stopped the solves; called with the GIL held
+    void rethrow()
+    {
+        if (error)
+        {
+            throw *error;
+        }
+    }
+
+    static bool trampoline(const cupdlpx_iteration_stats_t *stats, void *user_data)
+    {
+        auto *ctx = static_cast<InterruptContext *>(user_data);
+        if (ctx->stop)
+            return false;
+        if (!ctx->has_callback)
+        {
+            int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now().time_since_epoch())
+                              .count();
+            int64_t last = ctx->last_poll_ns.load();
+            if (now - last < std::chrono::nanoseconds(SIGNAL_POLL).count() ||
+                !ctx->last_poll_ns.compare_exchange_strong(last, now))
+                return true;
+        }
+
+        py::gil_scoped_acquire acquire;
+        try
+        {
+            if (PyErr_CheckSignals() != 0)
+            {
+                throw py::error_already_set();
+            }
+            // None continues, anything falsy stops
+            if (ctx->has_callback)
+            {
+                py::object keep_going = ctx->callback(*stats);
+                if (!keep_going.is_none() && !py::cast<bool>(keep_going))
+                    ctx->stop = true;
+            }
+        }
+        catch (py::error_already_set &e)
+        {
+            if (!ctx->error)
+                ctx->error = std::make_unique<py::error_already_set>(std::move(e));
+            ctx->stop = true;
+        }
+        return !ctx->stop;
+    }
+};
+
+// build the info dict of a result; it takes ownership of res
+static py::dict result_to_dict(cupdlpx_result_t *res)
+{
+    // hand the solution buffers to numpy; the capsule frees the result once
+    // the last array referencing it is gone
+    py::capsule owner(res, [](void *p)
+                      { cupdlpx_result_free(static_cast<cupdlpx_result_t *>(p)); });
+    py::array_t<double> x({(py::ssize_t)res->num_variables}, {(py::ssize_t)sizeof(double)},
+                          res->primal_solution, owner);
+    py::array_t<double> y({(py::ssize_t)res->num_constraints}, {(py::ssize_t)sizeof(double)},
+                          res->dual_solution, owner);
+    // build info dict
+    py::dict info;
+    // solution
+    info["X"] = x;
+    info["Pi"] = y;
+    // objectives and gaps
+    info["PrimalObj"] = res->primal_objective_value;
+    info["DualObj"] = res->dual_objective_value;
+    info["ObjectiveGap"] = res->objective_gap;
+    info["RelativeObjectiveGap"] = res->relative_objective_gap;
+    // stats
+    info["Status"] = py::str(status_to_str(res->termination_reason));
+    info["StatusCode"] = status_to_code(res->termination_reason);
+    info["Iterations"] = res->total_count;
+    info["RescalingTimeSec"] = res->rescaling_time_sec;
+    info["RuntimeSec"] = res->cumulative_time_sec;
+    info["DeviceMemoryBytes"] = res->device_memory_bytes;
+    // residuals
+    info["RelativePrimalResidual"] = res->relative_primal_residual;
+    info["RelativeDualResidual"] = res->relative_dual_residual;
+    // rays
+    info["MaxPrimalRayInfeas"] = res->max_primal_ray_infeasibility;
+    info["MaxDualRayInfeas"] = res->max_dual_ray_infeasibility;
+    info["PrimalRayLinObj"] = res->primal_ray_linear_objective;
+    info["DualRayObj"] = res->dual_ray_objective;
+
+    return info;
+}
+
 // solve function
 static py::dict solve_once(
     py::object A,
@@ -406,7 +587,8 @@ static py::dict solve_once(
     double zero_tolerance = 0.0,          // zero filter tolerance
     py::object params = py::none(),       // PDHG parameters (optional → default)
     py::object primal_start = py::none(), // warm start primal solution (optional)
-    py::object dual_start = py::none()    // warm start dual solution (optional)
+    py::object dual_start = py::none(),   // warm start dual solution (optional)
+    py::object callback = py::none()      // called at major iterations (optional)
 )
 {
     // parse matrix
@@ -433,19 +615,8 @@ static py::dict solve_once(
         c0_ptr = &c0_local;
     }
 
-    // build problem
-    lp_problem_t *prob = create_lp_problem(c_ptr,      // objective vector
-                                           &view.desc, // constraint matrix
-                                           l_ptr,      // constraint lower bound
-                                           u_ptr,      // constraint upper bound
-                                           lb_ptr,     // variable lower bound
-                                           ub_ptr,     // variable upper bound
-                                           c0_ptr      // objective constant
-    );
-    if (!prob)
-    {
-        throw std::runtime_error("create_lp_problem failed.");
-    }
+    // build problem; view outlives prob
+    lp_problem_t *prob = create_problem(view, c_ptr, l_ptr, u_ptr, lb_ptr, ub_ptr, c0_ptr);
 
     // set warm start values if provided
     if ((primal_start && !primal_start.is_none()) || (dual_start && !dual_start.is_none()))
@@ -463,6 +634,8 @@ static py::dict solve_once(
     pdhg_parameters_t local_params;
     set_default_parameters(&local_params);
     parse_params_from_python(params, &local_params);
+    InterruptContext interrupt(callback);
+    interrupt.install(local_params);
     // solve (release GIL during compute)
     cupdlpx_result_t *res = nullptr;
     {
@@ -474,46 +647,196 @@ static py::dict solve_once(
     {
         throw std::runtime_error("solve_lp_problem returned NULL.");
     }
+    if (interrupt.error)
+    {
+        cupdlpx_result_free(res);
+        interrupt.rethrow();
+    }
 
-    // parse result
-    const int n_out = res->num_variables;
-    const int m_out = res->num_constraints;
-    py::array_t<double> x({n_out});
-    py::array_t<double> y({m_out});
+    return result_to_dict(res);
+}
+
+// native solver kept by a Model between optimize() calls; it holds the
+// arrays its problem borrows from
+class PySolver
+{
+public:
+    PySolver(py::object A,
+             py::object objective_vector,
+             py::object objective_constant,
+             py::object variable_lower_bound,
+             py::object variable_upper_bound,
+             py::object constraint_lower_bound,
+             py::object constraint_upper_bound,
+             double zero_tolerance)
+        : view_(get_matrix_from_python(A, zero_tolerance))
     {
-        auto xb = x.request(), yb = y.request();
-        std::memcpy(xb.ptr, res->primal_solution, sizeof(double) * n_out);
-        std::memcpy(yb.ptr, res->dual_solution, sizeof(double) * m_out);
+        m_ = view_.desc.m;
+        n_ = view_.desc.n;
+        MatrixKeepalive vectors;
+        const double *c_ptr = get_vector(objective_vector, "objective_vector", n_, vectors);
+        const double *lb_ptr = get_vector(variable_lower_bound, "variable_lower_bound", n_, vectors);
+        const double *ub_ptr = get_vector(variable_upper_bound, "variable_upper_bound", n_, vectors);
+        const double *l_ptr = get_vector(constraint_lower_bound, "constraint_lower_bound", m_, vectors);
+        const double *u_ptr = get_vector(constraint_upper_bound, "constraint_upper_bound", m_, vectors);
+        double c0 = objective_constant.is_none() ? 0.0 : py::cast<double>(objective_constant);
+        lp_problem_t *prob = create_problem(view_, c_ptr, l_ptr, u_ptr, lb_ptr, ub_ptr, &c0);
+        solver_ = cupdlpx_solver_create(prob);
     }
-    // build info dict
-    py::dict info;
-    // solution
-    info["X"] = x;
-    info["Pi"] = y;
-    // objectives and gaps
-    info["PrimalObj"] = res->primal_objective_value;
-    info["DualObj"] = res->dual_objective_value;
-    info["ObjectiveGap"] = res->objective_gap;
-    info["RelativeObjectiveGap"] = res->relative_objective_gap;
-    // stats
-    info["Status"] = py::str(status_to_str(res->termination_reason));
-    info["StatusCode"] = status_to_code(res->termination_reason);
-    info["Iterations"] = res->total_count;
-    info["RescalingTimeSec"] = res->rescaling_time_sec;
-    info["RuntimeSec"] = res->cumulative_time_sec;
-    // residuals
-    info["RelativePrimalResidual"] = res->relative_primal_residual;
-    info["RelativeDualResidual"] = res->relative_dual_residual;
-    // rays
-    info["MaxPrimalRayInfeas"] = res->max_primal_ray_infeasibility;
-    info["MaxDualRayInfeas"] = res->max_dual_ray_infeasibility;
-    info["PrimalRayLinObj"] = res->primal_ray_linear_objective;
-    info["DualRayObj"] = res->dual_ray_objective;
 
-    // free result
-    cupdlpx_result_free(res);
+    ~PySolver() { cupdlpx_solver_free(solver_); }
 
-    return info;
+    PySolver(const PySolver &) = delete;
+    PySolver &operator=(const PySolver &) = delete;
+
+    // None leaves a vector as it is
+    void update(py::object objective_vector,
+                py::object objective_constant,
+                py::object variable_lower_bound,
+                py::object variable_upper_bound,
+                py::object constraint_lower_bound,
+                py::object constraint_upper_bound)
+    {
+        MatrixKeepalive vectors;
+        const double *c_ptr = get_vector(objective_vector, "objective_vector", n_, vectors);
+        const double *lb_ptr = get_vector(variable_lower_bound, "variable_lower_bound", n_, vectors);
+        const double *ub_ptr = get_vector(variable_upper_bound, "variable_upper_bound", n_, vectors);
+        const double *l_ptr = get_vector(constraint_lower_bound, "constraint_lower_bound", m_, vectors);
+        const double *u_ptr = get_vector(constraint_upper_bound, "constraint_upper_bound", m_, vectors);
+        double c0 = 0.0;
+        const double *c0_ptr = nullptr;
+        if (!objective_constant.is_none())
+        {
+            c0 = py::cast<double>(objective_constant);
+            c0_ptr = &c0;
+        }
+        cupdlpx_solver_update(solver_, c_ptr, c0_ptr, l_ptr, u_ptr, lb_ptr, ub_ptr);
+    }
+
+    // None for both goes back to starting from the previous solution
+    void set_warm_start(py::object primal_start, py::object dual_start)
+    {
+        MatrixKeepalive vectors;
+        const double *primal_ptr = get_vector(primal_start, "primal_start", n_, vectors);
+        const double *dual_ptr = get_vector(dual_start, "dual_start", m_, vectors);
+        cupdlpx_solver_set_start_values(solver_, primal_ptr, dual_ptr);
+    }
+
+    py::dict solve(py::object params, py::object callback)
+    {
+        pdhg_parameters_t local_params;
+        set_default_parameters(&local_params);
+        parse_params_from_python(params, &local_params);
+        InterruptContext interrupt(callback);
+        interrupt.install(local_params);
+        cupdlpx_result_t *res = nullptr;
+        {
+            py::gil_scoped_release release;
+            res = solve_native(local_params);
+        }
+        // the native log goes through C stdio, flush it before Python
+        // writes again
+        std::fflush(stdout);
+        if (!res)
+        {
+            throw std::runtime_error("cupdlpx_solver_solve returned NULL.");
+        }
+        if (interrupt.error)
+        {
+            cupdlpx_result_free(res);
+            interrupt.rethrow();
+        }
+        return result_to_dict(res);
+    }
+
+    // callable without the GIL
+    cupdlpx_result_t *solve_native(const pdhg_parameters_t &params)
+    {
+        return cupdlpx_solver_solve(solver_, &params);
+    }
+
+private:
+    static const double *get_vector(py::object obj, const char *name, int len, MatrixKeepalive &keep)
+    {
+        ensure_len_or_null(obj, name, len);
+        return get_arr_ptr_f64_or_null(obj, name, keep);
+    }
+
+    PyMatrixView view_;
+    int m_ = 0;
+    int n_ = 0;
+    cupdlpx_solver_t *solver_ = nullptr;
+};
+
+// workers of a batch when none are asked for: every solve holds its whole
+// setup on the one device the batch runs on, so more than two mostly add
+// memory, and two already overlap one solve's host work with the other's
+// kernels
+static constexpr size_t DEFAULT_BATCH_WORKERS = 2;
+
+// solve every solver on a pool of native threads; each thread runs its
+// solves on its own default stream, results come back in input order
+static py::list solve_batch(py::list solvers, py::list params, int max_workers)
+{
+    const size_t count = solvers.size();
+    if (params.size() != count)
+    {
+        throw std::invalid_argument("solve_batch: solvers and params differ in length.");
+    }
+    // parse everything while holding the GIL
+    std::vector<PySolver *> native(count);
+    std::vector<pdhg_parameters_t> native_params(count);
+    // a signal stops every solve of the batch
+    InterruptContext interrupt;
+    for (size_t i = 0; i < count; ++i)
+    {
+        native[i] = solvers[i].cast<PySolver *>();
+        set_default_parameters(&native_params[i]);
+        parse_params_from_python(params[i], &native_params[i]);
+        interrupt.install(native_params[i]);
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        for (size_t j = 0; j < i; ++j)
+        {
+            if (native[i] == native[j])
+            {
+                throw std::invalid_argument("solve_batch: a solver appears more than once.");
+            }
+        }
+    }
+
+    size_t workers = max_workers > 0 ? (size_t)max_workers : DEFAULT_BATCH_WORKERS;
+    workers = std::min(workers, count);
+    std::vector<cupdlpx_result_t *> results(count, nullptr);
+    {
+        py::gil_scoped_release release;
+        std::atomic<size_t> next{0};
+        auto work = [&]()
+        {
+            for (size_t i = next++; i < count; i = next++)
+                results[i] = native[i]->solve_native(native_params[i]);
+        };
+        std::vector<std::thread> pool;
+        for (size_t t = 1; t < workers; ++t)
+            pool.emplace_back(work);
+        work();
+        for (auto &thread : pool)
+            thread.join();
+    }
+
+    bool failed = std::find(results.begin(), results.end(), nullptr) != results.end();
+    if (failed || interrupt.error)
+    {
+        for (cupdlpx_result_t *res : results)
+            cupdlpx_result_free(res);
+        interrupt.rethrow();
+        throw std::runtime_error("cupdlpx_solver_solve returned NULL.");
+    }
+    py::list out;
+    for (cupdlpx_result_t *res : results)
+        out.append(result_to_dict(res));
+    return out;
 }
 
 // module
@@ -535,5 +858,50 @@ PYBIND11_MODULE(_cupdlpx_core, m)
           py::arg("zero_tolerance") = 0.0,
           py::arg("params") = py::none(),
           py::arg("primal_start") = py::none(),
-          py::arg("dual_start") = py::none());
+          py::arg("dual_start") = py::none(),
+          py::arg("callback") = py::none());
+
+    py::class_<cupdlpx_iteration_stats_t>(m, "IterationStats")
+        .def_readonly("iteration", &cupdlpx_iteration_stats_t::iteration)
+        .def_readonly("elapsed_time_sec", &cupdlpx_iteration_stats_t::elapsed_time_sec)
+        .def_readonly("primal_objective_value", &cupdlpx_iteration_stats_t::primal_objective_value)
+        .def_readonly("dual_objective_value", &cupdlpx_iteration_stats_t::dual_objective_value)
+        .def_readonly("relative_primal_residual", &cupdlpx_iteration_stats_t::relative_primal_residual)
+        .def_readonly("relative_dual_residual", &cupdlpx_iteration_stats_t::relative_dual_residual)
+        .def_readonly("relative_objective_gap", &cupdlpx_iteration_stats_t::relative_objective_gap)
+        .def_readonly("primal_weight", &cupdlpx_iteration_stats_t::primal_weight)
+        .def_readonly("step_size", &cupdlpx_iteration_stats_t::step_size);
+
+    py::class_<PySolver>(m, "Solver")
+        .def(py::init<py::object, py::object, py::object, py::object, py::object,
+                      py::object, py::object, double>(),
+             py::arg("A"),
+             py::arg("objective_vector"),
+             py::arg("objective_constant") = py::none(),
+             py::arg("variable_lower_bound") = py::none(),
+             py::arg("variable_upper_bound") = py::none(),
+             py::arg("constraint_lower_bound") = py::none(),
+             py::arg("constraint_upper_bound") = py::none(),
+             py::arg("zero_tolerance") = 0.0)
+        .def("update", &PySolver::update,
+             py::arg("objective_vector") = py::none(),
+             py::arg("objective_constant") = py::none(),
+             py::arg("variable_lower_bound") = py::none(),
+             py::arg("variable_upper_bound") = py::none(),
+             py::arg("constraint_lower_bound") = py::none(),
+             py::arg("constraint_upper_bound") = py::none())
+        .def("set_warm_start", &PySolver::set_warm_start,
+             py::arg("primal_start") = py::none(),
+             py::arg("dual_start") = py::none())
+        .def("solve", &PySolver::solve,
+             py::arg("params") = py::none(),
+             py::arg("callback") = py::none());
+
+    m.def("solve_batch", &solve_batch,
+          py::arg("solvers"),
+          py::arg("params"),
+          py::arg("max_workers") = 0);
+
+    m.def("clear_solution_store", &cupdlpx_solution_store_clear,
+          "Drop the solutions kept for SolutionStoreSize > 0");
 }
@@ -173,6 +173,16 @@ void print_usage(const char *prog_name)
                     "Enable feasibility use feasibility polishing (default: false).\n");
     fprintf(stderr, "      --eps_feas_polish <tolerance>   Relative feasibility "
                     "polish tolerance (default: 1e-6).\n");
+    fprintf(stderr, "      --cuda_graph                    "
+                    "Replay plain iterations from a CUDA graph (default: false).\n");
+    fprintf(stderr, "      --persistent_iterations         "
+                    "Run plain iterations in one cooperative kernel (default: false).\n");
+    fprintf(stderr, "      --transpose_free                "
+                    "Keep only A on the GPU, chosen anyway when A^T does not fit (default: false).\n");
+    fprintf(stderr, "      --setup_cache_dir <path>        "
+                    "Reuse the matrix setup of earlier runs stored there (default: off).\n");
+    fprintf(stderr, "      --numa_affinity                 "
+                    "Run host work on the cpus next to the GPU (default: false).\n");
 }
 
 int main(int argc, char *argv[])
@@ -198,6 +208,11 @@ int main(int argc, char *argv[])
         {"sv_max_iter", required_argument, 0, 1011},
         {"sv_tol", required_argument, 0, 1012},
         {"eval_freq", required_argument, 0, 1013},
+        {"cuda_graph", no_argument, 0, 1014},
+        {"setup_cache_dir", required_argument, 0, 1015},
+        {"numa_affinity", no_argument, 0, 1016},
+        {"persistent_iterations", no_argument, 0, 1017},
+        {"transpose_free", no_argument, 0, 1018},
         {0, 0, 0, 0}};
 
     int opt;
@@ -256,6 +271,21 @@ int main(int argc, char *argv[])
         case 1013: // --eval_freq
             params.termination_evaluation_frequency = atoi(optarg);
             break;
+        case 1014: // --cuda_graph
+            params.cuda_graph = true;
+            break;
+        case 1015: // --setup_cache_dir
+            params.setup_cache_dir = optarg;
+            break;
+        case 1016: // --numa_affinity
+            params.numa_affinity = true;
+            break;
+        case 1017: // --persistent_iterations
+            params.persistent_iterations = true;
+            break;
+        case 1018: // --transpose_free
+            params.transpose_free = true;
+            break;
         case '?': // Unknown option
             return 1;
         }
@@ -22,16 +22,77 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 
-// create an lp_problem_t from a matrix
-lp_problem_t *create_lp_problem(const double *objective_c,
-                                const matrix_desc_t *A_desc,
-                                const double *con_lb, const double *con_ub,
-                                const double *var_lb, const double *var_ub,
-                                const double *objective_constant)
+// the CSC arrays are A^T in CSR when no entry was dropped and the rows of
+// every column are strictly increasing, as in the transpose setup builds
+static bool csc_is_transpose(const matrix_desc_t *A_desc, int csr_nnz)
+{
+    const int *col_ptr = A_desc->data.csc.col_ptr;
+    const int *row_ind = A_desc->data.csc.row_ind;
+    if (col_ptr[A_desc->n] != csr_nnz)
+        return false;
+    for (int j = 0; j < A_desc->n; ++j)
+    {
+        for (int k = col_ptr[j] + 1; k < col_ptr[j + 1]; ++k)
+        {
+            if (row_ind[k] <= row_ind[k - 1])
+                return false;
+        }
+    }
+    return true;
+}
+
+static void keep_csc_as_transpose(lp_problem_t *prob,
+                                  const matrix_desc_t *A_desc, bool borrow)
 {
+    int n = A_desc->n;
+    int nnz = prob->constraint_matrix_num_nonzeros;
+    if (borrow)
+    {
+        prob->constraint_matrix_t_row_pointers = (int *)A_desc->data.csc.col_ptr;
+        prob->constraint_matrix_t_col_indices = (int *)A_desc->data.csc.row_ind;
+        prob->constraint_matrix_t_values = (double *)A_desc->data.csc.vals;
+        prob->borrows_constraint_matrix_t = true;
+        return;
+    }
+    prob->constraint_matrix_t_row_pointers =
+        (int *)safe_malloc((size_t)(n + 1) * sizeof(int));
+    prob->constraint_matrix_t_col_indices =
+        (int *)safe_malloc((size_t)nnz * sizeof(int));
+    prob->constraint_matrix_t_values =
+        (double *)safe_malloc((size_t)nnz * sizeof(double));
+    memcpy(prob->constraint_matrix_t_row_pointers, A_desc->data.csc.col_ptr,
+           (size_t)(n + 1) * sizeof(int));
+    memcpy(prob->constraint_matrix_t_col_indices, A_desc->data.csc.row_ind,
+           (size_t)nnz * sizeof(int));
+    memcpy(prob->constraint_matrix_t_values, A_desc->data.csc.vals,
+           (size_t)nnz * sizeof(double));
+}
+
+static lp_problem_t *build_lp_problem(const double *objective_c,
+                                      const matrix_desc_t *A_desc,
+                                      matrix_index_type_t index_type,
+                                      matrix_value_type_t value_type,
+                                      const double *con_lb, const double *con_ub,
+                                      const double *var_lb, const double *var_ub,
+                                      const double *objective_constant,
+                                      bool borrow_csr)
+{
+    if ((index_type != matrix_int32 && index_type != matrix_int64) ||
+        (value_type != matrix_float64 && value_type != matrix_float32))
+    {
+        fprintf(stderr, "[interface] unsupported matrix element types %d, %d.\n",
+                index_type, value_type);
+        return NULL;
+    }
+
     lp_problem_t *prob = (lp_problem_t *)safe_malloc(sizeof(lp_problem_t));
     prob->primal_start = NULL;
     prob->dual_start = NULL;
+    prob->borrows_constraint_matrix = false;
+    prob->constraint_matrix_t_row_pointers = NULL;
+    prob->constraint_matrix_t_col_indices = NULL;
+    prob->constraint_matrix_t_values = NULL;
+    prob->borrows_constraint_matrix_t = false;
 
     prob->num_variables = A_desc->n;
     prob->num_constraints = A_desc->m;
@@ -40,10 +101,15 @@ lp_problem_t *create_lp_problem(const double *objective_c,
     switch (A_desc->fmt)
     {
     case matrix_dense:
-        dense_to_csr(A_desc, &prob->constraint_matrix_row_pointers,
-                     &prob->constraint_matrix_col_indices,
-                     &prob->constraint_matrix_values,
-                     &prob->constraint_matrix_num_nonzeros);
+        if (dense_to_csr(A_desc, value_type, &prob->constraint_matrix_row_pointers,
+                         &prob->constraint_matrix_col_indices,
+                         &prob->constraint_matrix_values,
+                         &prob->constraint_matrix_num_nonzeros) != 0)
+        {
+            fprintf(stderr, "[interface] dense->CSR failed.\n");
+            free(prob);
+            return NULL;
+        }
         break;
 
     case matrix_csc:
@@ -51,7 +117,7 @@ lp_problem_t *create_lp_problem(const double *objective_c,
         int *row_ptr = NULL, *col_ind = NULL;
         double *vals = NULL;
         int nnz = 0;
-        if (csc_to_csr(A_desc, &row_ptr, &col_ind, &vals, &nnz) != 0)
+        if (csc_to_csr(A_desc, index_type, value_type, &row_ptr, &col_ind, &vals, &nnz) != 0)
         {
             fprintf(stderr, "[interface] CSC->CSR failed.\n");
             free(prob);
@@ -61,6 +127,9 @@ lp_problem_t *create_lp_problem(const double *objective_c,
         prob->constraint_matrix_row_pointers = row_ptr;
         prob->constraint_matrix_col_indices = col_ind;
         prob->constraint_matrix_values = vals;
+        if (index_type == matrix_int32 && value_type == matrix_float64 &&
+            csc_is_transpose(A_desc, nnz))
+            keep_csc_as_transpose(prob, A_desc, borrow_csr);
         break;
     }
 
@@ -69,7 +138,7 @@ lp_problem_t *create_lp_problem(const double *objective_c,
         int *row_ptr = NULL, *col_ind = NULL;
         double *vals = NULL;
         int nnz = 0;
-        if (coo_to_csr(A_desc, &row_ptr, &col_ind, &vals, &nnz) != 0)
+        if (coo_to_csr(A_desc, index_type, value_type, &row_ptr, &col_ind, &vals, &nnz) != 0)
         {
             fprintf(stderr, "[interface] COO->CSR failed.\n");
             free(prob);
@@ -83,7 +152,29 @@ lp_problem_t *create_lp_problem(const double *objective_c,
     }
 
     case matrix_csr:
+        if (index_type != matrix_int32 || value_type != matrix_float64)
+        {
+            if (csr_to_csr(A_desc, index_type, value_type,
+                           &prob->constraint_matrix_row_pointers,
+                           &prob->constraint_matrix_col_indices,
+                           &prob->constraint_matrix_values,
+                           &prob->constraint_matrix_num_nonzeros) != 0)
+            {
+                fprintf(stderr, "[interface] CSR conversion failed.\n");
+                free(prob);
+                return NULL;
+            }
+            break;
+        }
         prob->constraint_matrix_num_nonzeros = A_desc->data.csr.nnz;
+        if (borrow_csr)
+        {
+            prob->constraint_matrix_row_pointers = (int *)A_desc->data.csr.row_ptr;
+            prob->constraint_matrix_col_indices = (int *)A_desc->data.csr.col_ind;
+            prob->constraint_matrix_values = (double *)A_desc->data.csr.vals;
+            prob->borrows_constraint_matrix = true;
+            break;
+        }
         prob->constraint_matrix_row_pointers =
             (int *)safe_malloc((size_t)(A_desc->m + 1) * sizeof(int));
         prob->constraint_matrix_col_indices =
@@ -121,6 +212,46 @@ lp_problem_t *create_lp_problem(const double *objective_c,
     return prob;
 }
 
+// create an lp_problem_t from a matrix
+lp_problem_t *create_lp_problem(const double *objective_c,
+                                const matrix_desc_t *A_desc,
+                                const double *con_lb, const double *con_ub,
+                                const double *var_lb, const double *var_ub,
+                                const double *objective_constant)
+{
+    return build_lp_problem(objective_c, A_desc, matrix_int32, matrix_float64,
+                            con_lb, con_ub, var_lb, var_ub, objective_constant,
+                            false);
+}
+
+lp_problem_t *create_lp_problem_borrowed(const double *objective_c,
+                                         const matrix_desc_t *A_desc,
+                                         const double *con_lb,
+                                         const double *con_ub,
+                                         const double *var_lb,
+                                         const double *var_ub,
+                                         const double *objective_constant)
+{
+    return build_lp_problem(objective_c, A_desc, matrix_int32, matrix_float64,
+                            con_lb, con_ub, var_lb, var_ub, objective_constant,
+                            true);
+}
+
+lp_problem_t *create_lp_problem_typed(const double *objective_c,
+                                      const matrix_desc_t *A_desc,
+                                      matrix_index_type_t index_type,
+                                      matrix_value_type_t value_type,
+                                      const double *con_lb,
+                                      const double *con_ub,
+                                      const double *var_lb,
+                                      const double *var_ub,
+                                      const double *objective_constant)
+{
+    return build_lp_problem(objective_c, A_desc, index_type, value_type,
+                            con_lb, con_ub, var_lb, var_ub, objective_constant,
+                            false);
+}
+
 void cupdlpx_result_free(cupdlpx_result_t *results)
 {
     if (results == NULL)
@@ -137,9 +268,18 @@ void lp_problem_free(lp_problem_t *prob)
 {
     if (!prob)
         return;
-    free(prob->constraint_matrix_row_pointers);
-    free(prob->constraint_matrix_col_indices);
-    free(prob->constraint_matrix_values);
+    if (!prob->borrows_constraint_matrix)
+    {
+        free(prob->constraint_matrix_row_pointers);
+        free(prob->constraint_matrix_col_indices);
+        free(prob->constraint_matrix_values);
+    }
+    if (!prob->borrows_constraint_matrix_t)
+    {
+        free(prob->constraint_matrix_t_row_pointers);
+        free(prob->constraint_matrix_t_col_indices);
+        free(prob->constraint_matrix_t_values);
+    }
     free(prob->variable_lower_bound);
     free(prob->variable_upper_bound);
     free(prob->objective_vector);
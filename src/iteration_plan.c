@@ -0,0 +1,58 @@
+/*
+Copyright 2025 Haihao Lu
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "iteration_plan.h"
+
+int get_print_frequency(int iter)
+{
+    int step = 10;
+    long long threshold = 1000;
+
+    while (iter >= threshold)
+    {
+        step *= 10;
+        threshold *= 10;
+    }
+    return step;
+}
+
+bool is_plain_iteration(int total_count, int evaluation_frequency)
+{
+    if (total_count <= 0)
+        return false;
+    // evaluation and restart check at the top of the iteration; the previous
+    // iteration was a major one when total_count is a multiple of the frequency
+    if (total_count % evaluation_frequency == 0 ||
+        total_count % get_print_frequency(total_count) == 0)
+        return false;
+    // this iteration is a major one
+    if ((total_count + 1) % evaluation_frequency == 0)
+        return false;
+    // the update kernels write the pdhg iterates for the next print
+    if ((total_count + 2) % get_print_frequency(total_count + 2) == 0)
+        return false;
+    return true;
+}
+
+int plain_iteration_run(int total_count, int evaluation_frequency,
+                        int max_count)
+{
+    int count = 0;
+    while (count < max_count &&
+           is_plain_iteration(total_count + count, evaluation_frequency))
+        count++;
+    return count;
+}
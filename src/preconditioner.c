@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #include "preconditioner.h"
+#include "structure.h"
 #include "utils.h"
 #include <math.h>
 #include <stdio.h>
@@ -23,7 +24,6 @@ limitations under the License.
 
 #define SCALING_EPSILON 1e-12
 
-static lp_problem_t *deepcopy_problem(const lp_problem_t *prob);
 static void scale_problem(lp_problem_t *problem, const double *con_rescale,
                           const double *var_rescale);
 static void ruiz_rescaling(lp_problem_t *problem, int num_iters,
@@ -31,67 +31,8 @@ static void ruiz_rescaling(lp_problem_t *problem, int num_iters,
 static void pock_chambolle_rescaling(lp_problem_t *problem, double alpha,
                                      double *cum_con_rescale,
                                      double *cum_var_rescale);
-
-static lp_problem_t *deepcopy_problem(const lp_problem_t *prob)
-{
-    lp_problem_t *new_prob = (lp_problem_t *)safe_malloc(sizeof(lp_problem_t));
-
-    new_prob->num_variables = prob->num_variables;
-    new_prob->num_constraints = prob->num_constraints;
-    new_prob->constraint_matrix_num_nonzeros =
-        prob->constraint_matrix_num_nonzeros;
-    new_prob->objective_constant = prob->objective_constant;
-
-    size_t var_bytes = prob->num_variables * sizeof(double);
-    size_t con_bytes = prob->num_constraints * sizeof(double);
-    size_t nnz_bytes_val = prob->constraint_matrix_num_nonzeros * sizeof(double);
-    size_t nnz_bytes_col = prob->constraint_matrix_num_nonzeros * sizeof(int);
-    size_t row_ptr_bytes = (prob->num_constraints + 1) * sizeof(int);
-
-    new_prob->variable_lower_bound = safe_malloc(var_bytes);
-    new_prob->variable_upper_bound = safe_malloc(var_bytes);
-    new_prob->objective_vector = safe_malloc(var_bytes);
-    new_prob->constraint_lower_bound = safe_malloc(con_bytes);
-    new_prob->constraint_upper_bound = safe_malloc(con_bytes);
-    new_prob->constraint_matrix_row_pointers = safe_malloc(row_ptr_bytes);
-    new_prob->constraint_matrix_col_indices = safe_malloc(nnz_bytes_col);
-    new_prob->constraint_matrix_values = safe_malloc(nnz_bytes_val);
-
-    memcpy(new_prob->variable_lower_bound, prob->variable_lower_bound, var_bytes);
-    memcpy(new_prob->variable_upper_bound, prob->variable_upper_bound, var_bytes);
-    memcpy(new_prob->objective_vector, prob->objective_vector, var_bytes);
-    memcpy(new_prob->constraint_lower_bound, prob->constraint_lower_bound,
-           con_bytes);
-    memcpy(new_prob->constraint_upper_bound, prob->constraint_upper_bound,
-           con_bytes);
-    memcpy(new_prob->constraint_matrix_row_pointers,
-           prob->constraint_matrix_row_pointers, row_ptr_bytes);
-    memcpy(new_prob->constraint_matrix_col_indices,
-           prob->constraint_matrix_col_indices, nnz_bytes_col);
-    memcpy(new_prob->constraint_matrix_values, prob->constraint_matrix_values,
-           nnz_bytes_val);
-
-    if (prob->primal_start)
-    {
-        new_prob->primal_start = safe_malloc(var_bytes);
-        memcpy(new_prob->primal_start, prob->primal_start, var_bytes);
-    }
-    else
-    {
-        new_prob->primal_start = NULL;
-    }
-    if (prob->dual_start)
-    {
-        new_prob->dual_start = safe_malloc(con_bytes);
-        memcpy(new_prob->dual_start, prob->dual_start, con_bytes);
-    }
-    else
-    {
-        new_prob->dual_start = NULL;
-    }
-
-    return new_prob;
-}
+static void rescale_bounds_and_objective(const pdhg_parameters_t *params,
+                                         rescale_info_t *info);
 
 static void scale_problem(lp_problem_t *problem,
                           const double *constraint_rescaling,
@@ -119,6 +60,21 @@ static void scale_problem(lp_problem_t *problem,
                 (constraint_rescaling[row] * variable_rescaling[col]);
         }
     }
+
+    // same product on a transpose given with the problem, so both stay
+    // bitwise transposes of each other
+    if (problem->constraint_matrix_t_row_pointers == NULL)
+        return;
+    for (int col = 0; col < problem->num_variables; ++col)
+    {
+        for (int nz_idx = problem->constraint_matrix_t_row_pointers[col];
+             nz_idx < problem->constraint_matrix_t_row_pointers[col + 1]; ++nz_idx)
+        {
+            int row = problem->constraint_matrix_t_col_indices[nz_idx];
+            problem->constraint_matrix_t_values[nz_idx] /=
+                (constraint_rescaling[row] * variable_rescaling[col]);
+        }
+    }
 }
 
 static void ruiz_rescaling(lp_problem_t *problem, int num_iterations,
@@ -214,21 +170,90 @@ static void pock_chambolle_rescaling(lp_problem_t *problem, double alpha,
     free(var_rescale);
 }
 
+// scales bounds and objective of the scaled problem to unit norm when asked
+static void rescale_bounds_and_objective(const pdhg_parameters_t *params,
+                                         rescale_info_t *info)
+{
+    lp_problem_t *problem = info->scaled_problem;
+    int num_cons = problem->num_constraints;
+    int num_vars = problem->num_variables;
+    if (!params->bound_objective_rescaling)
+    {
+        info->con_bound_rescale = 1.0;
+        info->obj_vec_rescale = 1.0;
+        return;
+    }
+
+    double bound_norm_sq = 0.0;
+    for (int i = 0; i < num_cons; ++i)
+    {
+        double lower = problem->constraint_lower_bound[i];
+        double upper = problem->constraint_upper_bound[i];
+        if (isfinite(lower) && (lower != upper))
+            bound_norm_sq += lower * lower;
+        if (isfinite(upper))
+            bound_norm_sq += upper * upper;
+    }
+
+    double obj_norm_sq = 0.0;
+    for (int i = 0; i < num_vars; ++i)
+        obj_norm_sq += problem->objective_vector[i] * problem->objective_vector[i];
+
+    info->con_bound_rescale = 1.0 / (sqrt(bound_norm_sq) + 1.0);
+    info->obj_vec_rescale = 1.0 / (sqrt(obj_norm_sq) + 1.0);
+
+    for (int i = 0; i < num_cons; ++i)
+    {
+        problem->constraint_lower_bound[i] *= info->con_bound_rescale;
+        problem->constraint_upper_bound[i] *= info->con_bound_rescale;
+    }
+    for (int i = 0; i < num_vars; ++i)
+    {
+        problem->variable_lower_bound[i] *= info->con_bound_rescale;
+        problem->variable_upper_bound[i] *= info->con_bound_rescale;
+        problem->objective_vector[i] *= info->obj_vec_rescale;
+    }
+}
+
 rescale_info_t *rescale_problem(const pdhg_parameters_t *params,
                                 const lp_problem_t *original_problem)
 {
     clock_t start_rescaling = clock();
     rescale_info_t *rescale_info =
         (rescale_info_t *)safe_calloc(1, sizeof(rescale_info_t));
-    rescale_info->scaled_problem = deepcopy_problem(original_problem);
+    int num_cons = original_problem->num_constraints;
+    int num_vars = original_problem->num_variables;
+
+    // group variables and rows by bound type so the projections can skip
+    // the bounds a group does not have, and keep independent blocks of the
+    // matrix contiguous inside each group for SpMV locality
+    int *var_block = safe_malloc(num_vars * sizeof(int));
+    int *con_block = safe_malloc(num_cons * sizeof(int));
+    rescale_info->num_blocks = detect_block_structure(
+        original_problem, var_block, con_block, &rescale_info->num_linking_rows,
+        &rescale_info->num_linking_cols);
+
+    rescale_info->var_perm = safe_malloc(num_vars * sizeof(int));
+    rescale_info->con_perm = safe_malloc(num_cons * sizeof(int));
+    rescale_info->var_partition = partition_by_bound_type(
+        original_problem->variable_lower_bound,
+        original_problem->variable_upper_bound, var_block, num_vars,
+        rescale_info->var_perm);
+    rescale_info->con_partition = partition_by_bound_type(
+        original_problem->constraint_lower_bound,
+        original_problem->constraint_upper_bound, con_block, num_cons,
+        rescale_info->con_perm);
+    free(var_block);
+    free(con_block);
+
+    rescale_info->scaled_problem = permute_problem(
+        original_problem, rescale_info->var_perm, rescale_info->con_perm);
     if (rescale_info->scaled_problem == NULL)
     {
         fprintf(stderr,
                 "Failed to create a copy of the problem. Aborting rescale.\n");
         return NULL;
     }
-    int num_cons = original_problem->num_constraints;
-    int num_vars = original_problem->num_variables;
 
     rescale_info->con_rescale = safe_malloc(num_cons * sizeof(double));
     rescale_info->var_rescale = safe_malloc(num_vars * sizeof(double));
@@ -247,60 +272,54 @@ rescale_info_t *rescale_problem(const pdhg_parameters_t *params,
             rescale_info->scaled_problem, params->pock_chambolle_alpha,
             rescale_info->con_rescale, rescale_info->var_rescale);
     }
-    if (params->bound_objective_rescaling)
-    {
-        double bound_norm_sq = 0.0;
-        for (int i = 0; i < num_cons; ++i)
-        {
-            if (isfinite(rescale_info->scaled_problem->constraint_lower_bound[i]) &&
-                (rescale_info->scaled_problem->constraint_lower_bound[i] !=
-                 rescale_info->scaled_problem->constraint_upper_bound[i]))
-            {
-                bound_norm_sq +=
-                    rescale_info->scaled_problem->constraint_lower_bound[i] *
-                    rescale_info->scaled_problem->constraint_lower_bound[i];
-            }
-            if (isfinite(rescale_info->scaled_problem->constraint_upper_bound[i]))
-            {
-                bound_norm_sq +=
-                    rescale_info->scaled_problem->constraint_upper_bound[i] *
-                    rescale_info->scaled_problem->constraint_upper_bound[i];
-            }
-        }
-
-        double obj_norm_sq = 0.0;
-        for (int i = 0; i < num_vars; ++i)
-        {
-            obj_norm_sq += rescale_info->scaled_problem->objective_vector[i] *
-                           rescale_info->scaled_problem->objective_vector[i];
-        }
+    rescale_bounds_and_objective(params, rescale_info);
+    split_dense_rows_and_columns(rescale_info->scaled_problem,
+                                 &rescale_info->dense);
+    encode_coefficients(rescale_info->scaled_problem, rescale_info->con_rescale,
+                        rescale_info->var_rescale, &rescale_info->codes);
+    rescale_info->rescaling_time_sec =
+        (double)(clock() - start_rescaling) / CLOCKS_PER_SEC;
+    return rescale_info;
+}
+void rescale_problem_vectors(const pdhg_parameters_t *params,
+                             const lp_problem_t *original_problem,
+                             rescale_info_t *rescale_info)
+{
+    clock_t start_rescaling = clock();
+    lp_problem_t *scaled = rescale_info->scaled_problem;
+    int num_cons = original_problem->num_constraints;
+    int num_vars = original_problem->num_variables;
 
-        rescale_info->con_bound_rescale = 1.0 / (sqrt(bound_norm_sq) + 1.0);
-        rescale_info->obj_vec_rescale = 1.0 / (sqrt(obj_norm_sq) + 1.0);
+    permute_vector(original_problem->objective_vector, rescale_info->var_perm,
+                   num_vars, scaled->objective_vector);
+    permute_vector(original_problem->variable_lower_bound,
+                   rescale_info->var_perm, num_vars,
+                   scaled->variable_lower_bound);
+    permute_vector(original_problem->variable_upper_bound,
+                   rescale_info->var_perm, num_vars,
+                   scaled->variable_upper_bound);
+    permute_vector(original_problem->constraint_lower_bound,
+                   rescale_info->con_perm, num_cons,
+                   scaled->constraint_lower_bound);
+    permute_vector(original_problem->constraint_upper_bound,
+                   rescale_info->con_perm, num_cons,
+                   scaled->constraint_upper_bound);
+    scaled->objective_constant = original_problem->objective_constant;
 
-        for (int i = 0; i < num_cons; ++i)
-        {
-            rescale_info->scaled_problem->constraint_lower_bound[i] *=
-                rescale_info->con_bound_rescale;
-            rescale_info->scaled_problem->constraint_upper_bound[i] *=
-                rescale_info->con_bound_rescale;
-        }
-        for (int i = 0; i < num_vars; ++i)
-        {
-            rescale_info->scaled_problem->variable_lower_bound[i] *=
-                rescale_info->con_bound_rescale;
-            rescale_info->scaled_problem->variable_upper_bound[i] *=
-                rescale_info->con_bound_rescale;
-            rescale_info->scaled_problem->objective_vector[i] *=
-                rescale_info->obj_vec_rescale;
-        }
+    // the matrix scaling only depends on the matrix, so its product is
+    // applied to the new vectors in one pass
+    for (int i = 0; i < num_vars; ++i)
+    {
+        scaled->objective_vector[i] /= rescale_info->var_rescale[i];
+        scaled->variable_lower_bound[i] *= rescale_info->var_rescale[i];
+        scaled->variable_upper_bound[i] *= rescale_info->var_rescale[i];
     }
-    else
+    for (int i = 0; i < num_cons; ++i)
     {
-        rescale_info->con_bound_rescale = 1.0;
-        rescale_info->obj_vec_rescale = 1.0;
+        scaled->constraint_lower_bound[i] /= rescale_info->con_rescale[i];
+        scaled->constraint_upper_bound[i] /= rescale_info->con_rescale[i];
     }
+    rescale_bounds_and_objective(params, rescale_info);
     rescale_info->rescaling_time_sec =
         (double)(clock() - start_rescaling) / CLOCKS_PER_SEC;
-    return rescale_info;
-}
\ No newline at end of file
+}
@@ -0,0 +1,433 @@
+/*
+Copyright 2025 Haihao Lu
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "setup_cache.h"
+#include "cupdlpx.h"
+#include "preconditioner.h"
+#include "structure.h"
+#include "utils.h"
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#include <windows.h>
+#define mkdir(dir, mode) _mkdir(dir)
+#define getpid _getpid
+#define atomic_increment(counter) InterlockedIncrement(counter)
+#else
+#include <unistd.h>
+#define atomic_increment(counter) __atomic_add_fetch(counter, 1, __ATOMIC_RELAXED)
+#endif
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+// the checksums start elsewhere than the keys, so a key collision does not
+// carry over to them
+#define CHECKSUM_BASIS 0x84222325cbf29ce4ULL
+
+// bumped whenever the entry layout or the setup it caches changes
+#define SETUP_CACHE_VERSION 2
+
+typedef struct
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t has_transpose;
+    uint64_t key;
+    int32_t num_variables;
+    int32_t num_constraints;
+    int32_t scaled_num_nonzeros;
+    int32_t num_blocks;
+    int32_t num_linking_rows;
+    int32_t num_linking_cols;
+    int32_t num_dense_rows;
+    int32_t num_dense_cols;
+    int32_t num_nonzeros; // of the original matrix
+    uint64_t matrix_checksum; // of the original CSR arrays
+    uint64_t payload_checksum; // of everything after the header
+    bound_partition_t var_partition;
+    bound_partition_t con_partition;
+    double step_size;
+} setup_cache_header_t;
+
+static const char SETUP_CACHE_MAGIC[8] = {'c', 'u', 'P', 'D', 'L', 'P', 'x', 'S'};
+
+// FNV-1a on 8-byte words, folding the high half back after every step so
+// that high bits reach the low ones; the tail is hashed bytewise
+static uint64_t hash_bytes(uint64_t h, const void *data, size_t bytes)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    size_t k = 0;
+    for (; k + 8 <= bytes; k += 8)
+    {
+        uint64_t word;
+        memcpy(&word, p + k, 8);
+        h = (h ^ word) * FNV_PRIME;
+        h ^= h >> 32;
+    }
+    for (; k < bytes; ++k)
+        h = (h ^ p[k]) * FNV_PRIME;
+    return h;
+}
+
+// the partition only sees which bounds are finite and which are equal
+static uint64_t hash_bound_types(uint64_t h, const double *lower,
+                                 const double *upper, int n)
+{
+    unsigned char types[256];
+    for (int begin = 0; begin < n; begin += 256)
+    {
+        int len = (n - begin < 256) ? n - begin : 256;
+        for (int i = 0; i < len; ++i)
+        {
+            double l = lower[begin + i], u = upper[begin + i];
+            types[i] = (unsigned char)(isfinite(l) | (isfinite(u) << 1) |
+                                       ((l == u) << 2));
+        }
+        h = hash_bytes(h, types, len);
+    }
+    return h;
+}
+
+uint64_t setup_cache_key(const pdhg_parameters_t *params,
+                         const lp_problem_t *problem)
+{
+    int m = problem->num_constraints;
+    int n = problem->num_variables;
+    int nnz = problem->constraint_matrix_num_nonzeros;
+    int version = SETUP_CACHE_VERSION;
+    int has_transpose = problem->constraint_matrix_t_row_pointers != NULL;
+
+    uint64_t h = FNV_OFFSET_BASIS;
+    h = hash_bytes(h, &version, sizeof(version));
+    h = hash_bytes(h, &m, sizeof(m));
+    h = hash_bytes(h, &n, sizeof(n));
+    h = hash_bytes(h, &nnz, sizeof(nnz));
+    h = hash_bytes(h, &has_transpose, sizeof(has_transpose));
+    h = hash_bytes(h, &params->l_inf_ruiz_iterations,
+                   sizeof(params->l_inf_ruiz_iterations));
+    h = hash_bytes(h, &params->has_pock_chambolle_alpha,
+                   sizeof(params->has_pock_chambolle_alpha));
+    h = hash_bytes(h, &params->pock_chambolle_alpha,
+                   sizeof(params->pock_chambolle_alpha));
+    h = hash_bytes(h, &params->sv_max_iter, sizeof(params->sv_max_iter));
+    h = hash_bytes(h, &params->sv_tol, sizeof(params->sv_tol));
+
+    h = hash_bytes(h, problem->constraint_matrix_row_pointers,
+                   (size_t)(m + 1) * sizeof(int));
+    h = hash_bytes(h, problem->constraint_matrix_col_indices,
+                   (size_t)nnz * sizeof(int));
+    h = hash_bytes(h, problem->constraint_matrix_values,
+                   (size_t)nnz * sizeof(double));
+    h = hash_bound_types(h, problem->variable_lower_bound,
+                         problem->variable_upper_bound, n);
+    h = hash_bound_types(h, problem->constraint_lower_bound,
+                         problem->constraint_upper_bound, m);
+    return h;
+}
+
+uint64_t setup_cache_pattern_key(const lp_problem_t *problem)
+{
+    int m = problem->num_constraints;
+    int n = problem->num_variables;
+    int nnz = problem->constraint_matrix_num_nonzeros;
+
+    uint64_t h = FNV_OFFSET_BASIS;
+    h = hash_bytes(h, &m, sizeof(m));
+    h = hash_bytes(h, &n, sizeof(n));
+    h = hash_bytes(h, &nnz, sizeof(nnz));
+    h = hash_bytes(h, problem->constraint_matrix_row_pointers,
+                   (size_t)(m + 1) * sizeof(int));
+    h = hash_bytes(h, problem->constraint_matrix_col_indices,
+                   (size_t)nnz * sizeof(int));
+    return h;
+}
+
+static uint64_t matrix_checksum(const lp_problem_t *problem)
+{
+    int m = problem->num_constraints;
+    int nnz = problem->constraint_matrix_num_nonzeros;
+    uint64_t h = CHECKSUM_BASIS;
+    h = hash_bytes(h, problem->constraint_matrix_row_pointers,
+                   (size_t)(m + 1) * sizeof(int));
+    h = hash_bytes(h, problem->constraint_matrix_col_indices,
+                   (size_t)nnz * sizeof(int));
+    return hash_bytes(h, problem->constraint_matrix_values,
+                      (size_t)nnz * sizeof(double));
+}
+
+// the arrays of an entry in file order, so a damaged body is caught
+// before its setup is used
+static uint64_t payload_checksum(const rescale_info_t *info)
+{
+    const lp_problem_t *scaled = info->scaled_problem;
+    int m = scaled->num_constraints;
+    int n = scaled->num_variables;
+    size_t snnz = (size_t)scaled->constraint_matrix_num_nonzeros;
+    uint64_t h = CHECKSUM_BASIS;
+    h = hash_bytes(h, info->var_perm, n * sizeof(int));
+    h = hash_bytes(h, info->con_perm, m * sizeof(int));
+    h = hash_bytes(h, info->var_rescale, n * sizeof(double));
+    h = hash_bytes(h, info->con_rescale, m * sizeof(double));
+    h = hash_bytes(h, scaled->constraint_matrix_row_pointers,
+                   (m + 1) * sizeof(int));
+    h = hash_bytes(h, scaled->constraint_matrix_col_indices, snnz * sizeof(int));
+    h = hash_bytes(h, scaled->constraint_matrix_values, snnz * sizeof(double));
+    if (scaled->constraint_matrix_t_row_pointers != NULL)
+    {
+        h = hash_bytes(h, scaled->constraint_matrix_t_row_pointers,
+                       (n + 1) * sizeof(int));
+        h = hash_bytes(h, scaled->constraint_matrix_t_col_indices,
+                       snnz * sizeof(int));
+        h = hash_bytes(h, scaled->constraint_matrix_t_values,
+                       snnz * sizeof(double));
+    }
+    if (info->dense.num_rows > 0)
+    {
+        h = hash_bytes(h, info->dense.row_index,
+                       info->dense.num_rows * sizeof(int));
+        h = hash_bytes(h, info->dense.row_vals,
+                       (size_t)info->dense.num_rows * n * sizeof(double));
+    }
+    if (info->dense.num_cols > 0)
+    {
+        h = hash_bytes(h, info->dense.col_index,
+                       info->dense.num_cols * sizeof(int));
+        h = hash_bytes(h, info->dense.col_vals,
+                       (size_t)info->dense.num_cols * m * sizeof(double));
+    }
+    return h;
+}
+
+static void cache_path(char *path, size_t size, const char *dir, uint64_t key)
+{
+    snprintf(path, size, "%s/cupdlpx_setup_%016llx.bin", dir,
+             (unsigned long long)key);
+}
+
+static bool read_array(FILE *f, void **dst, size_t count, size_t elem)
+{
+    *dst = safe_malloc(count * elem);
+    return fread(*dst, elem, count, f) == count;
+}
+
+rescale_info_t *setup_cache_load(const char *dir, uint64_t key,
+                                 const pdhg_parameters_t *params,
+                                 const lp_problem_t *problem,
+                                 double *step_size)
+{
+    clock_t start_loading = clock();
+    char path[4096];
+    cache_path(path, sizeof(path), dir, key);
+    FILE *f = fopen(path, "rb");
+    if (f == NULL)
+        return NULL;
+
+    int m = problem->num_constraints;
+    int n = problem->num_variables;
+    setup_cache_header_t header;
+    if (fread(&header, sizeof(header), 1, f) != 1 ||
+        memcmp(header.magic, SETUP_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != SETUP_CACHE_VERSION || header.key != key ||
+        header.num_variables != n || header.num_constraints != m ||
+        header.num_nonzeros != problem->constraint_matrix_num_nonzeros ||
+        header.matrix_checksum != matrix_checksum(problem))
+    {
+        fclose(f);
+        return NULL;
+    }
+
+    rescale_info_t *info = (rescale_info_t *)safe_calloc(1, sizeof(rescale_info_t));
+    lp_problem_t *scaled = (lp_problem_t *)safe_calloc(1, sizeof(lp_problem_t));
+    info->scaled_problem = scaled;
+    info->var_partition = header.var_partition;
+    info->con_partition = header.con_partition;
+    info->num_blocks = header.num_blocks;
+    info->num_linking_rows = header.num_linking_rows;
+    info->num_linking_cols = header.num_linking_cols;
+    info->dense.num_rows = header.num_dense_rows;
+    info->dense.num_cols = header.num_dense_cols;
+
+    int snnz = header.scaled_num_nonzeros;
+    scaled->num_variables = n;
+    scaled->num_constraints = m;
+    scaled->constraint_matrix_num_nonzeros = snnz;
+
+    bool ok =
+        read_array(f, (void **)&info->var_perm, n, sizeof(int)) &&
+        read_array(f, (void **)&info->con_perm, m, sizeof(int)) &&
+        read_array(f, (void **)&info->var_rescale, n, sizeof(double)) &&
+        read_array(f, (void **)&info->con_rescale, m, sizeof(double)) &&
+        read_array(f, (void **)&scaled->constraint_matrix_row_pointers, m + 1,
+                   sizeof(int)) &&
+        read_array(f, (void **)&scaled->constraint_matrix_col_indices, snnz,
+                   sizeof(int)) &&
+        read_array(f, (void **)&scaled->constraint_matrix_values, snnz,
+                   sizeof(double));
+    if (ok && header.has_transpose)
+    {
+        ok = read_array(f, (void **)&scaled->constraint_matrix_t_row_pointers,
+                        n + 1, sizeof(int)) &&
+             read_array(f, (void **)&scaled->constraint_matrix_t_col_indices,
+                        snnz, sizeof(int)) &&
+             read_array(f, (void **)&scaled->constraint_matrix_t_values, snnz,
+                        sizeof(double));
+    }
+    if (ok && info->dense.num_rows > 0)
+    {
+        ok = read_array(f, (void **)&info->dense.row_index, info->dense.num_rows,
+                        sizeof(int)) &&
+             read_array(f, (void **)&info->dense.row_vals,
+                        (size_t)info->dense.num_rows * n, sizeof(double));
+    }
+    if (ok && info->dense.num_cols > 0)
+    {
+        ok = read_array(f, (void **)&info->dense.col_index, info->dense.num_cols,
+                        sizeof(int)) &&
+             read_array(f, (void **)&info->dense.col_vals,
+                        (size_t)info->dense.num_cols * m, sizeof(double));
+    }
+    // nothing may follow the last array
+    ok = ok && fgetc(f) == EOF;
+    fclose(f);
+    if (!ok || payload_checksum(info) != header.payload_checksum)
+    {
+        fprintf(stderr, "Warning: ignoring damaged setup cache entry %s.\n",
+                path);
+        lp_problem_free(scaled);
+        free(info->var_perm);
+        free(info->con_perm);
+        free(info->var_rescale);
+        free(info->con_rescale);
+        dense_split_free(&info->dense);
+        free(info);
+        return NULL;
+    }
+
+    // the vectors are not cached, they go through the stored scaling
+    scaled->objective_vector = safe_malloc(n * sizeof(double));
+    scaled->variable_lower_bound = safe_malloc(n * sizeof(double));
+    scaled->variable_upper_bound = safe_malloc(n * sizeof(double));
+    scaled->constraint_lower_bound = safe_malloc(m * sizeof(double));
+    scaled->constraint_upper_bound = safe_malloc(m * sizeof(double));
+    rescale_problem_vectors(params, problem, info);
+    encode_coefficients(scaled, info->con_rescale, info->var_rescale,
+                        &info->codes);
+
+    *step_size = header.step_size;
+    info->rescaling_time_sec =
+        (double)(clock() - start_loading) / CLOCKS_PER_SEC;
+    return info;
+}
+
+void setup_cache_store(const char *dir, uint64_t key,
+                       const lp_problem_t *problem,
+                       const rescale_info_t *info, double step_size)
+{
+    const lp_problem_t *scaled = info->scaled_problem;
+    int m = scaled->num_constraints;
+    int n = scaled->num_variables;
+    int snnz = scaled->constraint_matrix_num_nonzeros;
+
+    setup_cache_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SETUP_CACHE_MAGIC, sizeof(header.magic));
+    header.version = SETUP_CACHE_VERSION;
+    header.has_transpose = scaled->constraint_matrix_t_row_pointers != NULL;
+    header.key = key;
+    header.num_variables = n;
+    header.num_constraints = m;
+    header.scaled_num_nonzeros = snnz;
+    header.num_blocks = info->num_blocks;
+    header.num_linking_rows = info->num_linking_rows;
+    header.num_linking_cols = info->num_linking_cols;
+    header.num_dense_rows = info->dense.num_rows;
+    header.num_dense_cols = info->dense.num_cols;
+    header.num_nonzeros = problem->constraint_matrix_num_nonzeros;
+    header.matrix_checksum = matrix_checksum(problem);
+    header.payload_checksum = payload_checksum(info);
+    header.var_partition = info->var_partition;
+    header.con_partition = info->con_partition;
+    header.step_size = step_size;
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST)
+    {
+        fprintf(stderr, "Warning: cannot create setup cache directory %s.\n", dir);
+        return;
+    }
+
+    // written under a name private to the process and the call and renamed,
+    // so a concurrent reader sees either no entry or a complete one
+    static volatile long store_count = 0;
+    char path[4096], tmp_path[4096 + 48];
+    cache_path(path, sizeof(path), dir, key);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%ld.%ld.tmp", path,
+             (long)getpid(), (long)atomic_increment(&store_count));
+    FILE *f = fopen(tmp_path, "wb");
+    if (f == NULL)
+    {
+        fprintf(stderr, "Warning: cannot write setup cache entry %s.\n", path);
+        return;
+    }
+
+    bool ok =
+        fwrite(&header, sizeof(header), 1, f) == 1 &&
+        fwrite(info->var_perm, sizeof(int), n, f) == (size_t)n &&
+        fwrite(info->con_perm, sizeof(int), m, f) == (size_t)m &&
+        fwrite(info->var_rescale, sizeof(double), n, f) == (size_t)n &&
+        fwrite(info->con_rescale, sizeof(double), m, f) == (size_t)m &&
+        fwrite(scaled->constraint_matrix_row_pointers, sizeof(int), m + 1, f) ==
+            (size_t)(m + 1) &&
+        fwrite(scaled->constraint_matrix_col_indices, sizeof(int), snnz, f) ==
+            (size_t)snnz &&
+        fwrite(scaled->constraint_matrix_values, sizeof(double), snnz, f) ==
+            (size_t)snnz;
+    if (ok && header.has_transpose)
+    {
+        ok = fwrite(scaled->constraint_matrix_t_row_pointers, sizeof(int), n + 1,
+                    f) == (size_t)(n + 1) &&
+             fwrite(scaled->constraint_matrix_t_col_indices, sizeof(int), snnz,
+                    f) == (size_t)snnz &&
+             fwrite(scaled->constraint_matrix_t_values, sizeof(double), snnz,
+                    f) == (size_t)snnz;
+    }
+    if (ok && info->dense.num_rows > 0)
+    {
+        size_t count = (size_t)info->dense.num_rows * n;
+        ok = fwrite(info->dense.row_index, sizeof(int), info->dense.num_rows,
+                    f) == (size_t)info->dense.num_rows &&
+             fwrite(info->dense.row_vals, sizeof(double), count, f) == count;
+    }
+    if (ok && info->dense.num_cols > 0)
+    {
+        size_t count = (size_t)info->dense.num_cols * m;
+        ok = fwrite(info->dense.col_index, sizeof(int), info->dense.num_cols,
+                    f) == (size_t)info->dense.num_cols &&
+             fwrite(info->dense.col_vals, sizeof(double), count, f) == count;
+    }
+    ok = (fclose(f) == 0) && ok;
+    if (!ok || rename(tmp_path, path) != 0)
+    {
+        fprintf(stderr, "Warning: cannot write setup cache entry %s.\n", path);
+        remove(tmp_path);
+    }
+}
@@ -0,0 +1,147 @@
+/*
+Copyright 2025 Haihao Lu
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "solution_store.h"
+#include "cupdlpx.h"
+#include "utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+typedef SRWLOCK store_lock_t;
+#define STORE_LOCK_INIT SRWLOCK_INIT
+#define store_lock(lock) AcquireSRWLockExclusive(lock)
+#define store_unlock(lock) ReleaseSRWLockExclusive(lock)
+#else
+#include <pthread.h>
+typedef pthread_mutex_t store_lock_t;
+#define STORE_LOCK_INIT PTHREAD_MUTEX_INITIALIZER
+#define store_lock(lock) pthread_mutex_lock(lock)
+#define store_unlock(lock) pthread_mutex_unlock(lock)
+#endif
+
+typedef struct
+{
+    uint64_t pattern_key;
+    uint64_t last_use;
+    stored_solution_t *solution;
+} store_entry_t;
+
+// shared by all solves of the process, which may run on several threads
+static store_lock_t store_mutex = STORE_LOCK_INIT;
+static store_entry_t *store_entries = NULL;
+static int store_count = 0;
+static uint64_t store_clock = 0;
+
+static stored_solution_t *copy_solution(const stored_solution_t *src)
+{
+    size_t var_bytes = (size_t)src->num_variables * sizeof(double);
+    size_t con_bytes = (size_t)src->num_constraints * sizeof(double);
+    stored_solution_t *dst =
+        (stored_solution_t *)safe_malloc(sizeof(stored_solution_t));
+    *dst = *src;
+    dst->primal_solution = (double *)safe_malloc(var_bytes);
+    dst->dual_solution = (double *)safe_malloc(con_bytes);
+    memcpy(dst->primal_solution, src->primal_solution, var_bytes);
+    memcpy(dst->dual_solution, src->dual_solution, con_bytes);
+    return dst;
+}
+
+void stored_solution_free(stored_solution_t *solution)
+{
+    if (solution == NULL)
+        return;
+    free(solution->primal_solution);
+    free(solution->dual_solution);
+    free(solution);
+}
+
+static void remove_entry(int index)
+{
+    stored_solution_free(store_entries[index].solution);
+    store_entries[index] = store_entries[--store_count];
+    if (store_count == 0)
+    {
+        free(store_entries);
+        store_entries = NULL;
+    }
+}
+
+stored_solution_t *solution_store_lookup(uint64_t pattern_key,
+                                         int num_variables,
+                                         int num_constraints)
+{
+    stored_solution_t *found = NULL;
+    store_lock(&store_mutex);
+    for (int i = 0; i < store_count; ++i)
+    {
+        const stored_solution_t *entry = store_entries[i].solution;
+        if (store_entries[i].pattern_key == pattern_key &&
+            entry->num_variables == num_variables &&
+            entry->num_constraints == num_constraints)
+        {
+            store_entries[i].last_use = ++store_clock;
+            found = copy_solution(entry);
+            break;
+        }
+    }
+    store_unlock(&store_mutex);
+    return found;
+}
+
+void solution_store_put(int capacity, uint64_t pattern_key,
+                        const stored_solution_t *solution)
+{
+    // copied before taking the lock, so other solves only wait on the
+    // bookkeeping
+    stored_solution_t *copy = copy_solution(solution);
+    stored_solution_t *replaced = NULL;
+
+    store_lock(&store_mutex);
+    int index = 0;
+    while (index < store_count && store_entries[index].pattern_key != pattern_key)
+        ++index;
+    if (index == store_count)
+    {
+        store_entries = (store_entry_t *)safe_realloc(
+            store_entries, (store_count + 1) * sizeof(store_entry_t));
+        store_entries[store_count++].solution = NULL;
+    }
+    replaced = store_entries[index].solution;
+    store_entries[index].pattern_key = pattern_key;
+    store_entries[index].last_use = ++store_clock;
+    store_entries[index].solution = copy;
+
+    while (store_count > capacity)
+    {
+        int oldest = 0;
+        for (int i = 1; i < store_count; ++i)
+            if (store_entries[i].last_use < store_entries[oldest].last_use)
+                oldest = i;
+        remove_entry(oldest);
+    }
+    store_unlock(&store_mutex);
+    stored_solution_free(replaced);
+}
+
+void cupdlpx_solution_store_clear(void)
+{
+    store_lock(&store_mutex);
+    while (store_count > 0)
+        remove_entry(store_count - 1);
+    store_unlock(&store_mutex);
+}
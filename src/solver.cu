@@ -17,14 +17,21 @@ limitations under the License.
 #include "cupdlpx.h"
 #include "internal_types.h"
 #include "preconditioner.h"
+#include "setup_cache.h"
+#include "solution_store.h"
 #include "solver.h"
+#include "structure.h"
 #include "utils.h"
+#include <cooperative_groups.h>
 #include <cublas_v2.h>
 #include <cuda_runtime.h>
 #include <cusparse.h>
+#include <limits.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
+#include <thread>
 #include <time.h>
 
 static double monotonic_time_sec()
@@ -39,28 +46,37 @@ static double monotonic_time_sec()
     return (double)clock() / CLOCKS_PER_SEC;
 }
 
+template <bool ZERO_OBJECTIVE>
 __global__ void compute_next_pdhg_primal_solution_kernel(
     const double *current_primal, double *reflected_primal,
     const double *dual_product, const double *objective, const double *var_lb,
-    const double *var_ub, int n, double step_size);
+    const double *var_ub, bound_partition_t part, int n, double step_size);
+template <bool ZERO_OBJECTIVE>
 __global__ void compute_next_pdhg_primal_solution_major_kernel(
     const double *current_primal, double *pdhg_primal, double *reflected_primal,
     const double *dual_product, const double *objective, const double *var_lb,
-    const double *var_ub, int n, double step_size, double *dual_slack);
+    const double *var_ub, bound_partition_t part, int n, double step_size,
+    double *dual_slack);
 __global__ void compute_next_pdhg_dual_solution_kernel(
     const double *current_dual, double *reflected_dual,
     const double *primal_product, const double *const_lb,
-    const double *const_ub, int n, double step_size);
+    const double *const_ub, bound_partition_t part, int n, double step_size);
 __global__ void compute_next_pdhg_dual_solution_major_kernel(
     const double *current_dual, double *pdhg_dual, double *reflected_dual,
     const double *primal_product, const double *const_lb,
-    const double *const_ub, int n, double step_size);
+    const double *const_ub, bound_partition_t part, int n, double step_size);
 __global__ void
 halpern_update_kernel(const double *initial_primal, double *current_primal,
                       const double *reflected_primal,
                       const double *initial_dual, double *current_dual,
                       const double *reflected_dual, int n_vars, int n_cons,
                       double weight, double reflection_coeff);
+__global__ void halpern_update_counted_kernel(
+    const double *initial_primal, double *current_primal,
+    const double *reflected_primal, const double *initial_dual,
+    double *current_dual, const double *reflected_dual, int n_vars, int n_cons,
+    const int *inner_count, double reflection_coeff);
+__global__ void advance_inner_count_kernel(int *inner_count);
 __global__ void rescale_solution_kernel(double *primal_solution,
                                         double *dual_solution,
                                         const double *variable_rescaling,
@@ -77,6 +93,11 @@ static void compute_next_pdhg_dual_solution(pdhg_solver_state_t *state);
 static void halpern_update(pdhg_solver_state_t *state,
                            double reflection_coefficient);
 static void rescale_solution(pdhg_solver_state_t *state);
+static void enable_plain_iteration_graph(pdhg_solver_state_t *state);
+static void disable_plain_iteration_graph(pdhg_solver_state_t *state);
+static void enable_persistent_iterations(pdhg_solver_state_t *state);
+static void run_plain_iterations(pdhg_solver_state_t *state,
+                                 const pdhg_parameters_t *params, int count);
 static cupdlpx_result_t *create_result_from_state(pdhg_solver_state_t *state);
 static void perform_restart(pdhg_solver_state_t *state,
                             const pdhg_parameters_t *params);
@@ -85,8 +106,21 @@ initialize_step_size_and_primal_weight(pdhg_solver_state_t *state,
                                        const pdhg_parameters_t *params);
 static pdhg_solver_state_t *
 initialize_solver_state(const lp_problem_t *original_problem,
-                        const rescale_info_t *rescale_info);
+                        const rescale_info_t *rescale_info,
+                        bool transpose_free);
+static void upload_problem_vectors(pdhg_solver_state_t *state,
+                                   const rescale_info_t *rescale_info);
+static void upload_starting_point(pdhg_solver_state_t *state,
+                                  const rescale_info_t *rescale_info,
+                                  const double *primal_start,
+                                  const double *dual_start);
+static void compute_problem_norms(pdhg_solver_state_t *state,
+                                  const lp_problem_t *original_problem);
+static cupdlpx_result_t *run_pdhg(const pdhg_parameters_t *params,
+                                  pdhg_solver_state_t *state);
 static void compute_fixed_point_error(pdhg_solver_state_t *state);
+static void create_spmv_descriptors(pdhg_solver_state_t *state);
+static void destroy_spmv_descriptors(pdhg_solver_state_t *state);
 void pdhg_solver_state_free(pdhg_solver_state_t *state);
 void rescale_info_free(rescale_info_t *info);
 
@@ -100,27 +134,172 @@ void feasibility_polish(const pdhg_parameters_t *params, pdhg_solver_state_t *st
 static void compute_primal_fixed_point_error(pdhg_solver_state_t *state);
 static void compute_dual_fixed_point_error(pdhg_solver_state_t *state);
 static pdhg_solver_state_t *initialize_primal_feas_polish_state(
-    const pdhg_solver_state_t *original_state);
+    pdhg_solver_state_t *original_state);
 static pdhg_solver_state_t *initialize_dual_feas_polish_state(
-    const pdhg_solver_state_t *original_state);
+    pdhg_solver_state_t *original_state);
+static void attach_feas_polish_stream(pdhg_solver_state_t *state);
+static void detach_feas_polish_stream(pdhg_solver_state_t *state);
+
+// the setup of an earlier run on the same matrix when a cache directory is
+// given and has it, a fresh one otherwise; *cached_step_size is zero unless
+// the entry was found
+static rescale_info_t *load_or_rescale(const pdhg_parameters_t *params,
+                                       const lp_problem_t *problem,
+                                       uint64_t *cache_key,
+                                       double *cached_step_size)
+{
+    *cached_step_size = 0.0;
+    if (params->setup_cache_dir == NULL)
+        return rescale_problem(params, problem);
+    *cache_key = setup_cache_key(params, problem);
+    rescale_info_t *info = setup_cache_load(params->setup_cache_dir, *cache_key,
+                                            params, problem, cached_step_size);
+    if (info != NULL)
+        return info;
+    return rescale_problem(params, problem);
+}
+
+// the latest stored solution of the sparsity pattern when the store is on
+// and the problem has no starting point of its own
+static stored_solution_t *recall_solution(const pdhg_parameters_t *params,
+                                          const lp_problem_t *problem,
+                                          uint64_t *pattern_key,
+                                          uint64_t *matrix_key)
+{
+    if (params->solution_store_size <= 0)
+        return NULL;
+    *pattern_key = setup_cache_pattern_key(problem);
+    *matrix_key = setup_cache_key(params, problem);
+    if (problem->primal_start != NULL || problem->dual_start != NULL)
+        return NULL;
+    return solution_store_lookup(*pattern_key, problem->num_variables,
+                                 problem->num_constraints);
+}
+
+// the step size only carries over to the same values, the primal weight is
+// a starting guess the restarts keep tuning
+static double recalled_step_size(const stored_solution_t *recalled,
+                                 uint64_t matrix_key)
+{
+    if (recalled == NULL || recalled->matrix_key != matrix_key)
+        return 0.0;
+    return recalled->step_size;
+}
+
+static void restore_primal_weight(pdhg_solver_state_t *state,
+                                  const stored_solution_t *recalled)
+{
+    if (recalled == NULL)
+        return;
+    state->primal_weight = recalled->primal_weight;
+    state->best_primal_weight = recalled->primal_weight;
+}
+
+static void remember_solution(const pdhg_parameters_t *params,
+                              uint64_t pattern_key, uint64_t matrix_key,
+                              const pdhg_solver_state_t *state,
+                              const cupdlpx_result_t *results)
+{
+    if (params->solution_store_size <= 0 ||
+        results->termination_reason == TERMINATION_REASON_PRIMAL_INFEASIBLE ||
+        results->termination_reason == TERMINATION_REASON_DUAL_INFEASIBLE)
+        return;
+    stored_solution_t solution;
+    solution.matrix_key = matrix_key;
+    solution.num_variables = results->num_variables;
+    solution.num_constraints = results->num_constraints;
+    solution.primal_solution = results->primal_solution;
+    solution.dual_solution = results->dual_solution;
+    solution.primal_weight = state->primal_weight;
+    solution.step_size = state->step_size;
+    solution_store_put(params->solution_store_size, pattern_key, &solution);
+}
 
 cupdlpx_result_t *optimize(const pdhg_parameters_t *params,
                            const lp_problem_t *original_problem)
 {
-    print_initial_info(params, original_problem);
-    rescale_info_t *rescale_info = rescale_problem(params, original_problem);
+    // the setup arrays are first touched after this, so they land on the
+    // device's node along with the staging of the uploads
+    void *previous_cpus =
+        params->numa_affinity ? pin_thread_to_device_cpus() : NULL;
+    uint64_t cache_key = 0, pattern_key = 0, matrix_key = 0;
+    double cached_step_size;
+    stored_solution_t *recalled = recall_solution(
+        params, original_problem, &pattern_key, &matrix_key);
+    rescale_info_t *rescale_info = load_or_rescale(
+        params, original_problem, &cache_key, &cached_step_size);
     pdhg_solver_state_t *state =
-        initialize_solver_state(original_problem, rescale_info);
-    state->debug = params->debug;
+        initialize_solver_state(original_problem, rescale_info,
+                                params->transpose_free);
+    print_initial_info(params, original_problem, rescale_info, state);
 
-    rescale_info_free(rescale_info);
+    state->step_size = cached_step_size != 0.0
+                           ? cached_step_size
+                           : recalled_step_size(recalled, matrix_key);
     initialize_step_size_and_primal_weight(state, params);
+    if (params->setup_cache_dir != NULL && cached_step_size == 0.0)
+        setup_cache_store(params->setup_cache_dir, cache_key,
+                          original_problem, rescale_info, state->step_size);
+    if (recalled != NULL)
+    {
+        upload_starting_point(state, rescale_info, recalled->primal_solution,
+                              recalled->dual_solution);
+        restore_primal_weight(state, recalled);
+        stored_solution_free(recalled);
+    }
+    rescale_info_free(rescale_info);
+    cupdlpx_result_t *results = run_pdhg(params, state);
+    remember_solution(params, pattern_key, matrix_key, state, results);
+    pdhg_solver_state_free(state);
+    restore_thread_cpus(previous_cpus);
+    return results;
+}
+
+static void report_iteration(const pdhg_parameters_t *params,
+                             pdhg_solver_state_t *state)
+{
+    cupdlpx_iteration_stats_t stats;
+    stats.iteration = state->total_count;
+    stats.elapsed_time_sec = state->cumulative_time_sec;
+    stats.primal_objective_value = state->primal_objective_value;
+    stats.dual_objective_value = state->dual_objective_value;
+    stats.relative_primal_residual = state->relative_primal_residual;
+    stats.relative_dual_residual = state->relative_dual_residual;
+    stats.relative_objective_gap = state->relative_objective_gap;
+    stats.primal_weight = state->primal_weight;
+    stats.step_size = state->step_size;
+    if (!params->iteration_callback(&stats, params->callback_user_data))
+        state->termination_reason = TERMINATION_REASON_USER_INTERRUPT;
+}
+
+// main loop, polishing and result of a state that is set up and has its
+// step size; the state can be reset and run again afterwards
+static cupdlpx_result_t *run_pdhg(const pdhg_parameters_t *params,
+                                  pdhg_solver_state_t *state)
+{
+    state->debug = params->debug;
+    if (params->persistent_iterations)
+        enable_persistent_iterations(state);
+    if (params->cuda_graph || state->persistent_blocks > 0)
+        enable_plain_iteration_graph(state);
     double start_time = monotonic_time_sec();
     bool do_restart = false;
     {
         NVTX_RANGE("mainloop");
         while (state->termination_reason == TERMINATION_REASON_UNSPECIFIED)
         {
+            if (state->inner_count_d != NULL &&
+                is_plain_iteration(state->total_count,
+                                   params->termination_evaluation_frequency))
+            {
+                run_plain_iterations(
+                    state, params,
+                    plain_iteration_run(state->total_count,
+                                        params->termination_evaluation_frequency,
+                                        INT_MAX));
+                continue;
+            }
+
             if ((state->is_this_major_iteration || state->total_count == 0) ||
                 (state->total_count % get_print_frequency(state->total_count) == 0))
             {
@@ -135,6 +314,10 @@ cupdlpx_result_t *optimize(const pdhg_parameters_t *params,
 
                 check_termination_criteria(state, &params->termination_criteria);
                 display_iteration_stats(state, params->verbose);
+                if (params->iteration_callback != NULL &&
+                    state->is_this_major_iteration &&
+                    state->termination_reason == TERMINATION_REASON_UNSPECIFIED)
+                    report_iteration(params, state);
             }
 
             if ((state->is_this_major_iteration || state->total_count == 0))
@@ -173,23 +356,431 @@ cupdlpx_result_t *optimize(const pdhg_parameters_t *params,
 
     if (params->feasibility_polishing &&
         state->termination_reason != TERMINATION_REASON_DUAL_INFEASIBLE &&
-        state->termination_reason != TERMINATION_REASON_PRIMAL_INFEASIBLE)
+        state->termination_reason != TERMINATION_REASON_PRIMAL_INFEASIBLE &&
+        state->termination_reason != TERMINATION_REASON_USER_INTERRUPT)
     {
         feasibility_polish(params, state);
     }
 
     cupdlpx_result_t *results = create_result_from_state(state);
-    pdhg_solver_state_free(state);
+    if (state->inner_count_d != NULL)
+        disable_plain_iteration_graph(state);
+    state->persistent_blocks = 0;
+    return results;
+}
+
+struct cupdlpx_solver
+{
+    lp_problem_t *problem;
+    // scaling the device state was set up with
+    pdhg_parameters_t setup_params;
+    // vectors of the scaled problem only, the matrix lives on the device
+    rescale_info_t *rescale_info;
+    pdhg_solver_state_t *state;
+    pdhg_solver_state_t initial_state;
+    double step_size;
+    bool vectors_changed;
+    double *last_primal_solution;
+    double *last_dual_solution;
+};
+
+static void release_solver_state(cupdlpx_solver_t *solver)
+{
+    pdhg_solver_state_free(solver->state);
+    rescale_info_free(solver->rescale_info);
+    solver->state = NULL;
+    solver->rescale_info = NULL;
+}
+
+static bool same_setup(const pdhg_parameters_t *a, const pdhg_parameters_t *b)
+{
+    return a->l_inf_ruiz_iterations == b->l_inf_ruiz_iterations &&
+           a->has_pock_chambolle_alpha == b->has_pock_chambolle_alpha &&
+           a->pock_chambolle_alpha == b->pock_chambolle_alpha &&
+           a->bound_objective_rescaling == b->bound_objective_rescaling &&
+           a->sv_max_iter == b->sv_max_iter && a->sv_tol == b->sv_tol &&
+           a->transpose_free == b->transpose_free;
+}
+
+static void setup_solver(cupdlpx_solver_t *solver,
+                         const pdhg_parameters_t *params,
+                         double known_step_size)
+{
+    release_solver_state(solver);
+    uint64_t cache_key = 0;
+    double cached_step_size;
+    solver->rescale_info = load_or_rescale(params, solver->problem, &cache_key,
+                                           &cached_step_size);
+    solver->state =
+        initialize_solver_state(solver->problem, solver->rescale_info,
+                                params->transpose_free);
+    print_initial_info(params, solver->problem, solver->rescale_info,
+                       solver->state);
+    solver->initial_state = *solver->state;
+    solver->state->step_size =
+        cached_step_size != 0.0 ? cached_step_size : known_step_size;
+    initialize_step_size_and_primal_weight(solver->state, params);
+    solver->step_size = solver->state->step_size;
+    solver->setup_params = *params;
+    if (params->setup_cache_dir != NULL && cached_step_size == 0.0)
+        setup_cache_store(params->setup_cache_dir, cache_key, solver->problem,
+                          solver->rescale_info, solver->step_size);
+
+    lp_problem_t *scaled = solver->rescale_info->scaled_problem;
+    free(scaled->constraint_matrix_row_pointers);
+    free(scaled->constraint_matrix_col_indices);
+    free(scaled->constraint_matrix_values);
+    free(scaled->constraint_matrix_t_row_pointers);
+    free(scaled->constraint_matrix_t_col_indices);
+    free(scaled->constraint_matrix_t_values);
+    scaled->constraint_matrix_row_pointers = NULL;
+    scaled->constraint_matrix_col_indices = NULL;
+    scaled->constraint_matrix_values = NULL;
+    scaled->constraint_matrix_t_row_pointers = NULL;
+    scaled->constraint_matrix_t_col_indices = NULL;
+    scaled->constraint_matrix_t_values = NULL;
+}
+
+// puts the state back to where setup left it, with the current vectors
+static void reset_solver(cupdlpx_solver_t *solver,
+                         const pdhg_parameters_t *params)
+{
+    pdhg_solver_state_t *state = solver->state;
+    *state = solver->initial_state;
+    CUDA_CHECK(cudaMemset(state->vector_pool, 0, state->vector_pool_bytes));
+    if (solver->vectors_changed)
+        rescale_problem_vectors(params, solver->problem, solver->rescale_info);
+    upload_problem_vectors(state, solver->rescale_info);
+    compute_problem_norms(state, solver->problem);
+    state->rescaling_time_sec = solver->rescale_info->rescaling_time_sec;
+    state->step_size = solver->step_size;
+    initialize_step_size_and_primal_weight(state, params);
+}
+
+cupdlpx_solver_t *cupdlpx_solver_create(lp_problem_t *prob)
+{
+    if (!prob)
+    {
+        fprintf(stderr, "[interface] cupdlpx_solver_create: invalid arguments.\n");
+        return NULL;
+    }
+    cupdlpx_solver_t *solver =
+        (cupdlpx_solver_t *)safe_calloc(1, sizeof(cupdlpx_solver_t));
+    solver->problem = prob;
+    return solver;
+}
+
+void cupdlpx_solver_update(cupdlpx_solver_t *solver, const double *objective_c,
+                           const double *objective_constant,
+                           const double *con_lb, const double *con_ub,
+                           const double *var_lb, const double *var_ub)
+{
+    if (!solver)
+        return;
+    lp_problem_t *prob = solver->problem;
+    int n = prob->num_variables;
+    int m = prob->num_constraints;
+
+    // the device layout groups entries by bound type
+    if ((var_lb || var_ub) &&
+        !same_bound_types(prob->variable_lower_bound, prob->variable_upper_bound,
+                          var_lb ? var_lb : prob->variable_lower_bound,
+                          var_ub ? var_ub : prob->variable_upper_bound, n))
+        release_solver_state(solver);
+    if ((con_lb || con_ub) &&
+        !same_bound_types(prob->constraint_lower_bound,
+                          prob->constraint_upper_bound,
+                          con_lb ? con_lb : prob->constraint_lower_bound,
+                          con_ub ? con_ub : prob->constraint_upper_bound, m))
+        release_solver_state(solver);
+
+    if (objective_c)
+        memcpy(prob->objective_vector, objective_c, n * sizeof(double));
+    if (objective_constant)
+        prob->objective_constant = *objective_constant;
+    if (var_lb)
+        memcpy(prob->variable_lower_bound, var_lb, n * sizeof(double));
+    if (var_ub)
+        memcpy(prob->variable_upper_bound, var_ub, n * sizeof(double));
+    if (con_lb)
+        memcpy(prob->constraint_lower_bound, con_lb, m * sizeof(double));
+    if (con_ub)
+        memcpy(prob->constraint_upper_bound, con_ub, m * sizeof(double));
+    solver->vectors_changed = true;
+}
+
+void cupdlpx_solver_set_start_values(cupdlpx_solver_t *solver,
+                                     const double *primal, const double *dual)
+{
+    if (solver)
+        set_start_values(solver->problem, primal, dual);
+}
+
+cupdlpx_result_t *cupdlpx_solver_solve(cupdlpx_solver_t *solver,
+                                       const pdhg_parameters_t *params)
+{
+    if (!solver)
+    {
+        fprintf(stderr, "[interface] cupdlpx_solver_solve: invalid arguments.\n");
+        return NULL;
+    }
+    pdhg_parameters_t local_params;
+    if (params)
+        local_params = *params;
+    else
+        set_default_parameters(&local_params);
+    void *previous_cpus =
+        local_params.numa_affinity ? pin_thread_to_device_cpus() : NULL;
+
+    lp_problem_t *prob = solver->problem;
+    uint64_t pattern_key = 0, matrix_key = 0;
+    stored_solution_t *recalled =
+        recall_solution(&local_params, prob, &pattern_key, &matrix_key);
+
+    if (solver->state == NULL || !same_setup(&solver->setup_params, &local_params))
+        setup_solver(solver, &local_params,
+                     recalled_step_size(recalled, matrix_key));
+    else
+        reset_solver(solver, &local_params);
+    solver->vectors_changed = false;
+
+    // the solution of this solver's previous solve comes before a stored one
+    if (prob->primal_start != NULL || prob->dual_start != NULL)
+        upload_starting_point(solver->state, solver->rescale_info,
+                              prob->primal_start, prob->dual_start);
+    else if (solver->last_primal_solution != NULL || recalled == NULL)
+        upload_starting_point(solver->state, solver->rescale_info,
+                              solver->last_primal_solution,
+                              solver->last_dual_solution);
+    else
+    {
+        // the weight only goes with the recalled iterates it was tuned on
+        upload_starting_point(solver->state, solver->rescale_info,
+                              recalled->primal_solution,
+                              recalled->dual_solution);
+        restore_primal_weight(solver->state, recalled);
+    }
+    stored_solution_free(recalled);
+
+    cupdlpx_result_t *results = run_pdhg(&local_params, solver->state);
+    remember_solution(&local_params, pattern_key, matrix_key, solver->state,
+                      results);
+
+    // the iterates of an infeasibility certificate are no starting point
+    bool keep = results->termination_reason != TERMINATION_REASON_PRIMAL_INFEASIBLE &&
+                results->termination_reason != TERMINATION_REASON_DUAL_INFEASIBLE;
+    free(solver->last_primal_solution);
+    free(solver->last_dual_solution);
+    solver->last_primal_solution = NULL;
+    solver->last_dual_solution = NULL;
+    if (keep)
+    {
+        solver->last_primal_solution =
+            (double *)safe_malloc(prob->num_variables * sizeof(double));
+        solver->last_dual_solution =
+            (double *)safe_malloc(prob->num_constraints * sizeof(double));
+        memcpy(solver->last_primal_solution, results->primal_solution,
+               prob->num_variables * sizeof(double));
+        memcpy(solver->last_dual_solution, results->dual_solution,
+               prob->num_constraints * sizeof(double));
+    }
+    restore_thread_cpus(previous_cpus);
     return results;
 }
 
+void cupdlpx_solver_free(cupdlpx_solver_t *solver)
+{
+    if (solver == NULL)
+        return;
+    release_solver_state(solver);
+    lp_problem_free(solver->problem);
+    free(solver->last_primal_solution);
+    free(solver->last_dual_solution);
+    free(solver);
+}
+
+// device bytes the setup of this thread has allocated; a state takes the
+// difference across its setup as its footprint, which other threads solving
+// at the same time do not change
+static thread_local size_t device_bytes_allocated = 0;
+
+template <typename T> static cudaError_t device_alloc(T **ptr, size_t bytes)
+{
+    cudaError_t status = cudaMalloc((void **)ptr, bytes);
+    if (status == cudaSuccess)
+        device_bytes_allocated += bytes;
+    return status;
+}
+
+#define POOL_ALIGNMENT 256
+
+static size_t pool_slice_bytes(size_t bytes)
+{
+    return (bytes + POOL_ALIGNMENT - 1) / POOL_ALIGNMENT * POOL_ALIGNMENT;
+}
+
+// threads per row of the coded spmv: the mean row length rounded up to a
+// power of two, at most a warp
+static int coded_spmv_lanes(int nnz, int num_rows)
+{
+    int lanes = 1;
+    while (lanes < 32 && (double)lanes * num_rows < nnz)
+        lanes <<= 1;
+    return lanes;
+}
+
+// row ends plus nonzeros each merge-path thread walks
+#define MERGE_PATH_ITEMS 32
+// rows and nonzeros of one dual scatter slice, one block each
+#define DUAL_SCATTER_ITEMS 1024
+
+// partitions are found once on the host; a matrix with even rows keeps none
+// and stays on the lanes kernel
+static void setup_merge_path(const int *row_ptr, int num_rows,
+                             merge_path_t *path)
+{
+    path->num_partitions = 0;
+    if (!csr_rows_skewed(row_ptr, num_rows))
+        return;
+    int num_partitions = merge_path_num_partitions(
+        num_rows, row_ptr[num_rows], MERGE_PATH_ITEMS);
+    size_t bytes = (num_partitions + 1) * sizeof(int);
+    int *start_row = (int *)safe_malloc(bytes);
+    int *start_nz = (int *)safe_malloc(bytes);
+    merge_path_partitions(row_ptr, num_rows, MERGE_PATH_ITEMS, num_partitions,
+                          start_row, start_nz);
+    CUDA_CHECK(device_alloc(&path->start_row, bytes));
+    CUDA_CHECK(device_alloc(&path->start_nz, bytes));
+    CUDA_CHECK(cudaMemcpy(path->start_row, start_row, bytes,
+                          cudaMemcpyHostToDevice));
+    CUDA_CHECK(cudaMemcpy(path->start_nz, start_nz, bytes,
+                          cudaMemcpyHostToDevice));
+    free(start_row);
+    free(start_nz);
+    path->num_partitions = num_partitions;
+}
+
+static void upload_ints(int **dest, const int *src, size_t count)
+{
+    CUDA_CHECK(device_alloc(dest, count * sizeof(int)));
+    CUDA_CHECK(cudaMemcpy(*dest, src, count * sizeof(int),
+                          cudaMemcpyHostToDevice));
+}
+
+// the row slices of A for the scatter that replaces the transpose, each with
+// a private window over the columns it touches. Slices start at
+// DUAL_SCATTER_ITEMS rows and nonzeros, so the parallelism grows with the
+// matrix, and double in size until the windows and their column lists take
+// at most half the memory the transpose would
+static void setup_dual_scatter(const int *row_ptr, const int *col_ind,
+                               int num_rows, int num_cols,
+                               size_t transpose_bytes, dual_scatter_t *scatter)
+{
+    int nnz = row_ptr[num_rows];
+    size_t max_entries = transpose_bytes / (2 * (sizeof(double) + sizeof(int)));
+    int items = DUAL_SCATTER_ITEMS;
+    int num_slices = 0;
+    int *start_row = NULL, *start_nz = NULL, *col_begin = NULL;
+    int *window_offset = NULL;
+    for (;;)
+    {
+        // an empty matrix still gets one empty slice, so the mode stays on
+        num_slices = merge_path_num_partitions(num_rows, nnz, items);
+        if (num_slices < 1)
+            num_slices = 1;
+        size_t bytes = (num_slices + 1) * sizeof(int);
+        start_row = (int *)safe_realloc(start_row, bytes);
+        start_nz = (int *)safe_realloc(start_nz, bytes);
+        col_begin = (int *)safe_realloc(col_begin, bytes);
+        window_offset = (int *)safe_realloc(window_offset, bytes);
+        merge_path_partitions(row_ptr, num_rows, items, num_slices, start_row,
+                              start_nz);
+        size_t entries = 0;
+        for (int p = 0; p < num_slices; ++p)
+        {
+            int lo = INT_MAX, hi = -1;
+            for (int k = start_nz[p]; k < start_nz[p + 1]; ++k)
+            {
+                if (col_ind[k] < lo)
+                    lo = col_ind[k];
+                if (col_ind[k] > hi)
+                    hi = col_ind[k];
+            }
+            col_begin[p] = (hi < 0) ? 0 : lo;
+            window_offset[p] = (int)entries;
+            entries += (hi < 0) ? 0 : hi + 1 - lo;
+        }
+        window_offset[num_slices] = (int)entries;
+        if (entries <= max_entries || num_slices == 1)
+            break;
+        items *= 2;
+    }
+
+    // the window entries of each column in slice order
+    int entries = window_offset[num_slices];
+    int *column_ptr = (int *)safe_calloc(num_cols + 1, sizeof(int));
+    int *column_windows = (int *)safe_malloc(
+        (entries > 0 ? entries : 1) * sizeof(int));
+    for (int p = 0; p < num_slices; ++p)
+    {
+        int width = window_offset[p + 1] - window_offset[p];
+        for (int j = 0; j < width; ++j)
+            column_ptr[col_begin[p] + j + 1]++;
+    }
+    for (int j = 0; j < num_cols; ++j)
+        column_ptr[j + 1] += column_ptr[j];
+    int *next = (int *)safe_malloc((num_cols + 1) * sizeof(int));
+    memcpy(next, column_ptr, (num_cols + 1) * sizeof(int));
+    for (int p = 0; p < num_slices; ++p)
+    {
+        int width = window_offset[p + 1] - window_offset[p];
+        for (int j = 0; j < width; ++j)
+            column_windows[next[col_begin[p] + j]++] = window_offset[p] + j;
+    }
+    free(next);
+
+    upload_ints(&scatter->slices.start_row, start_row, num_slices + 1);
+    upload_ints(&scatter->slices.start_nz, start_nz, num_slices + 1);
+    upload_ints(&scatter->col_begin, col_begin, num_slices);
+    upload_ints(&scatter->window_offset, window_offset, num_slices + 1);
+    upload_ints(&scatter->column_ptr, column_ptr, num_cols + 1);
+    upload_ints(&scatter->column_windows, column_windows, entries);
+    CUDA_CHECK(device_alloc(&scatter->partials, entries * sizeof(double)));
+    free(start_row);
+    free(start_nz);
+    free(col_begin);
+    free(window_offset);
+    free(column_ptr);
+    free(column_windows);
+    scatter->slices.num_partitions = num_slices;
+    scatter->num_window_entries = entries;
+}
+
+// the divided SpMV input, then one carry per merge-path partition
+static size_t coded_spmv_scratch_size(const pdhg_solver_state_t *state)
+{
+    int n = (state->num_variables > state->num_constraints)
+                ? state->num_variables
+                : state->num_constraints;
+    int partitions = (state->row_merge_path.num_partitions >
+                      state->col_merge_path.num_partitions)
+                         ? state->row_merge_path.num_partitions
+                         : state->col_merge_path.num_partitions;
+    return (size_t)n + partitions;
+}
+
 static pdhg_solver_state_t *
 initialize_solver_state(const lp_problem_t *original_problem,
-                        const rescale_info_t *rescale_info)
+                        const rescale_info_t *rescale_info,
+                        bool transpose_free)
 {
     pdhg_solver_state_t *state =
         (pdhg_solver_state_t *)safe_calloc(1, sizeof(pdhg_solver_state_t));
 
+    size_t free_before, total_memory;
+    CUDA_CHECK(cudaMemGetInfo(&free_before, &total_memory));
+    size_t allocated_before = device_bytes_allocated;
+
     int n_vars = original_problem->num_variables;
     int n_cons = original_problem->num_constraints;
     size_t var_bytes = n_vars * sizeof(double);
@@ -197,8 +788,6 @@ initialize_solver_state(const lp_problem_t *original_problem,
 
     state->num_variables = n_vars;
     state->num_constraints = n_cons;
-    state->objective_constant = original_problem->objective_constant;
-
     state->constraint_matrix =
         (cu_sparse_matrix_csr_t *)safe_malloc(sizeof(cu_sparse_matrix_csr_t));
     state->constraint_matrix_t =
@@ -207,19 +796,19 @@ initialize_solver_state(const lp_problem_t *original_problem,
     state->constraint_matrix->num_rows = n_cons;
     state->constraint_matrix->num_cols = n_vars;
     state->constraint_matrix->num_nonzeros =
-        original_problem->constraint_matrix_num_nonzeros;
+        rescale_info->scaled_problem->constraint_matrix_num_nonzeros;
 
     state->constraint_matrix_t->num_rows = n_vars;
     state->constraint_matrix_t->num_cols = n_cons;
     state->constraint_matrix_t->num_nonzeros =
-        original_problem->constraint_matrix_num_nonzeros;
+        rescale_info->scaled_problem->constraint_matrix_num_nonzeros;
 
     state->termination_reason = TERMINATION_REASON_UNSPECIFIED;
 
     state->rescaling_time_sec = rescale_info->rescaling_time_sec;
 
 #define ALLOC_AND_COPY(dest, src, bytes)  \
-    CUDA_CHECK(cudaMalloc(&dest, bytes)); \
+    CUDA_CHECK(device_alloc(&dest, bytes)); \
     CUDA_CHECK(cudaMemcpy(dest, src, bytes, cudaMemcpyHostToDevice));
 
     ALLOC_AND_COPY(state->constraint_matrix->row_ptr,
@@ -229,155 +818,323 @@ initialize_solver_state(const lp_problem_t *original_problem,
                    rescale_info->scaled_problem->constraint_matrix_col_indices,
                    rescale_info->scaled_problem->constraint_matrix_num_nonzeros *
                        sizeof(int));
-    ALLOC_AND_COPY(state->constraint_matrix->val,
-                   rescale_info->scaled_problem->constraint_matrix_values,
-                   rescale_info->scaled_problem->constraint_matrix_num_nonzeros *
-                       sizeof(double));
+    // a coded matrix is read through its byte codes only, so its values
+    // never reach the device
+    bool coded = rescale_info->codes.num_values > 0;
+    state->constraint_matrix->val = NULL;
+    if (!coded)
+    {
+        ALLOC_AND_COPY(state->constraint_matrix->val,
+                       rescale_info->scaled_problem->constraint_matrix_values,
+                       rescale_info->scaled_problem->constraint_matrix_num_nonzeros *
+                           sizeof(double));
+    }
 
-    CUDA_CHECK(cudaMalloc(&state->constraint_matrix_t->row_ptr,
-                          (n_vars + 1) * sizeof(int)));
-    CUDA_CHECK(
-        cudaMalloc(&state->constraint_matrix_t->col_ind,
-                   rescale_info->scaled_problem->constraint_matrix_num_nonzeros *
-                       sizeof(int)));
-    CUDA_CHECK(
-        cudaMalloc(&state->constraint_matrix_t->val,
-                   rescale_info->scaled_problem->constraint_matrix_num_nonzeros *
-                       sizeof(double)));
+    // the transpose doubles the matrix memory; it is kept when it fits
+    // next to the vectors together with the buffer that builds it, otherwise
+    // A^T y is scattered from the rows of A
+    const lp_problem_t *scaled = rescale_info->scaled_problem;
+    size_t nnz_bytes = (size_t)scaled->constraint_matrix_num_nonzeros *
+                       ((coded ? sizeof(unsigned char) : sizeof(double)) +
+                        sizeof(int));
+    size_t transpose_bytes = nnz_bytes + (n_vars + 1) * sizeof(int);
+    size_t vector_bytes = 11 * var_bytes + 10 * con_bytes;
+    bool transposed =
+        !transpose_free &&
+        free_before > nnz_bytes + 2 * transpose_bytes + vector_bytes;
+    if (!transposed)
+    {
+        setup_dual_scatter(scaled->constraint_matrix_row_pointers,
+                           scaled->constraint_matrix_col_indices, n_cons,
+                           n_vars, transpose_bytes, &state->dual_scatter);
+    }
+
+    // a transpose that came with the problem is uploaded as it is,
+    // otherwise it is built on the device once the handles exist
+    bool has_transpose = scaled->constraint_matrix_t_row_pointers != NULL;
+    state->constraint_matrix_t->val = NULL;
+    if (!transposed)
+    {
+        state->constraint_matrix_t->row_ptr = NULL;
+        state->constraint_matrix_t->col_ind = NULL;
+    }
+    else if (has_transpose)
+    {
+        ALLOC_AND_COPY(state->constraint_matrix_t->row_ptr,
+                       scaled->constraint_matrix_t_row_pointers,
+                       (n_vars + 1) * sizeof(int));
+        ALLOC_AND_COPY(state->constraint_matrix_t->col_ind,
+                       scaled->constraint_matrix_t_col_indices,
+                       scaled->constraint_matrix_num_nonzeros * sizeof(int));
+        if (!coded)
+        {
+            ALLOC_AND_COPY(state->constraint_matrix_t->val,
+                           scaled->constraint_matrix_t_values,
+                           scaled->constraint_matrix_num_nonzeros * sizeof(double));
+        }
+    }
+    else
+    {
+        CUDA_CHECK(device_alloc(&state->constraint_matrix_t->row_ptr,
+                              (n_vars + 1) * sizeof(int)));
+        CUDA_CHECK(device_alloc(&state->constraint_matrix_t->col_ind,
+                              scaled->constraint_matrix_num_nonzeros * sizeof(int)));
+        if (!coded)
+        {
+            CUDA_CHECK(device_alloc(&state->constraint_matrix_t->val,
+                                  scaled->constraint_matrix_num_nonzeros *
+                                      sizeof(double)));
+        }
+    }
+
+    state->num_dense_rows = rescale_info->dense.num_rows;
+    state->num_dense_cols = rescale_info->dense.num_cols;
+    if (state->num_dense_rows > 0)
+    {
+        ALLOC_AND_COPY(state->dense_row_index, rescale_info->dense.row_index,
+                       state->num_dense_rows * sizeof(int));
+        ALLOC_AND_COPY(state->dense_rows, rescale_info->dense.row_vals,
+                       (size_t)state->num_dense_rows * var_bytes);
+    }
+    if (state->num_dense_cols > 0)
+    {
+        ALLOC_AND_COPY(state->dense_col_index, rescale_info->dense.col_index,
+                       state->num_dense_cols * sizeof(int));
+        ALLOC_AND_COPY(state->dense_cols, rescale_info->dense.col_vals,
+                       (size_t)state->num_dense_cols * con_bytes);
+    }
 
+    // solves on different host threads only order against their own work
+    state->stream = cudaStreamPerThread;
     CUSPARSE_CHECK(cusparseCreate(&state->sparse_handle));
+    CUSPARSE_CHECK(cusparseSetStream(state->sparse_handle, state->stream));
     CUBLAS_CHECK(cublasCreate(&state->blas_handle));
     CUBLAS_CHECK(
         cublasSetPointerMode(state->blas_handle, CUBLAS_POINTER_MODE_HOST));
+    CUBLAS_CHECK(cublasSetStream(state->blas_handle, state->stream));
 
+    // the transpose of a coded matrix is built from its codes below
     size_t buffer_size = 0;
     void *buffer = nullptr;
-    CUSPARSE_CHECK(cusparseCsr2cscEx2_bufferSize(
-        state->sparse_handle, state->constraint_matrix->num_rows,
-        state->constraint_matrix->num_cols,
-        state->constraint_matrix->num_nonzeros, state->constraint_matrix->val,
-        state->constraint_matrix->row_ptr, state->constraint_matrix->col_ind,
-        state->constraint_matrix_t->val, state->constraint_matrix_t->row_ptr,
-        state->constraint_matrix_t->col_ind, CUDA_R_64F, CUSPARSE_ACTION_NUMERIC,
-        CUSPARSE_INDEX_BASE_ZERO, CUSPARSE_CSR2CSC_ALG_DEFAULT, &buffer_size));
-    CUDA_CHECK(cudaMalloc(&buffer, buffer_size));
-
-    CUSPARSE_CHECK(cusparseCsr2cscEx2(
-        state->sparse_handle, state->constraint_matrix->num_rows,
-        state->constraint_matrix->num_cols,
-        state->constraint_matrix->num_nonzeros, state->constraint_matrix->val,
-        state->constraint_matrix->row_ptr, state->constraint_matrix->col_ind,
-        state->constraint_matrix_t->val, state->constraint_matrix_t->row_ptr,
-        state->constraint_matrix_t->col_ind, CUDA_R_64F, CUSPARSE_ACTION_NUMERIC,
-        CUSPARSE_INDEX_BASE_ZERO, CUSPARSE_CSR2CSC_ALG_DEFAULT, buffer));
-
-    CUDA_CHECK(cudaFree(buffer));
-
-    ALLOC_AND_COPY(state->variable_lower_bound,
+    if (transposed && !has_transpose && !coded)
+    {
+        CUSPARSE_CHECK(cusparseCsr2cscEx2_bufferSize(
+            state->sparse_handle, state->constraint_matrix->num_rows,
+            state->constraint_matrix->num_cols,
+            state->constraint_matrix->num_nonzeros, state->constraint_matrix->val,
+            state->constraint_matrix->row_ptr, state->constraint_matrix->col_ind,
+            state->constraint_matrix_t->val, state->constraint_matrix_t->row_ptr,
+            state->constraint_matrix_t->col_ind, CUDA_R_64F, CUSPARSE_ACTION_NUMERIC,
+            CUSPARSE_INDEX_BASE_ZERO, CUSPARSE_CSR2CSC_ALG_DEFAULT, &buffer_size));
+        CUDA_CHECK(cudaMalloc(&buffer, buffer_size));
+
+        CUSPARSE_CHECK(cusparseCsr2cscEx2(
+            state->sparse_handle, state->constraint_matrix->num_rows,
+            state->constraint_matrix->num_cols,
+            state->constraint_matrix->num_nonzeros, state->constraint_matrix->val,
+            state->constraint_matrix->row_ptr, state->constraint_matrix->col_ind,
+            state->constraint_matrix_t->val, state->constraint_matrix_t->row_ptr,
+            state->constraint_matrix_t->col_ind, CUDA_R_64F, CUSPARSE_ACTION_NUMERIC,
+            CUSPARSE_INDEX_BASE_ZERO, CUSPARSE_CSR2CSC_ALG_DEFAULT, buffer));
+
+        CUDA_CHECK(cudaFree(buffer));
+    }
+
+    // a small coefficient alphabet is read as one byte per nonzero; the
+    // transpose only moves entries, so its codes go through the same csr2csc
+    state->num_coefficient_values = rescale_info->codes.num_values;
+    if (state->num_coefficient_values > 0)
+    {
+        int nnz = state->constraint_matrix->num_nonzeros;
+        ALLOC_AND_COPY(state->coefficient_values, rescale_info->codes.values,
+                       state->num_coefficient_values * sizeof(double));
+        ALLOC_AND_COPY(state->constraint_matrix_codes, rescale_info->codes.codes,
+                       nnz * sizeof(unsigned char));
+        state->coded_row_lanes = coded_spmv_lanes(nnz, n_cons);
+        setup_merge_path(scaled->constraint_matrix_row_pointers, n_cons,
+                         &state->row_merge_path);
+        if (transposed)
+        {
+            CUDA_CHECK(device_alloc(&state->constraint_matrix_t_codes,
+                                  nnz * sizeof(unsigned char)));
+
+            CUSPARSE_CHECK(cusparseCsr2cscEx2_bufferSize(
+                state->sparse_handle, n_cons, n_vars, nnz,
+                state->constraint_matrix_codes, state->constraint_matrix->row_ptr,
+                state->constraint_matrix->col_ind, state->constraint_matrix_t_codes,
+                state->constraint_matrix_t->row_ptr,
+                state->constraint_matrix_t->col_ind, CUDA_R_8I,
+                CUSPARSE_ACTION_NUMERIC, CUSPARSE_INDEX_BASE_ZERO,
+                CUSPARSE_CSR2CSC_ALG_DEFAULT, &buffer_size));
+            CUDA_CHECK(cudaMalloc(&buffer, buffer_size));
+            CUSPARSE_CHECK(cusparseCsr2cscEx2(
+                state->sparse_handle, n_cons, n_vars, nnz,
+                state->constraint_matrix_codes, state->constraint_matrix->row_ptr,
+                state->constraint_matrix->col_ind, state->constraint_matrix_t_codes,
+                state->constraint_matrix_t->row_ptr,
+                state->constraint_matrix_t->col_ind, CUDA_R_8I,
+                CUSPARSE_ACTION_NUMERIC, CUSPARSE_INDEX_BASE_ZERO,
+                CUSPARSE_CSR2CSC_ALG_DEFAULT, buffer));
+            CUDA_CHECK(cudaFree(buffer));
+
+            state->coded_col_lanes = coded_spmv_lanes(nnz, n_vars);
+
+            // the transpose was built on the device, so its row pointers come
+            // back for the partition search
+            int *t_row_ptr = (int *)safe_malloc((n_vars + 1) * sizeof(int));
+            CUDA_CHECK(cudaMemcpy(t_row_ptr, state->constraint_matrix_t->row_ptr,
+                                  (n_vars + 1) * sizeof(int),
+                                  cudaMemcpyDeviceToHost));
+            setup_merge_path(t_row_ptr, n_vars, &state->col_merge_path);
+            free(t_row_ptr);
+        }
+        CUDA_CHECK(device_alloc(&state->coded_spmv_input,
+                              coded_spmv_scratch_size(state) * sizeof(double)));
+    }
+
+    // one allocation for every vector of the state, each slice aligned so
+    // that vectorized and coalesced accesses start on a segment boundary
+    double **var_vectors[] = {
+        &state->variable_lower_bound, &state->variable_upper_bound,
+        &state->objective_vector, &state->variable_rescaling,
+        &state->initial_primal_solution, &state->current_primal_solution,
+        &state->pdhg_primal_solution, &state->reflected_primal_solution,
+        &state->dual_product, &state->dual_slack,
+        &state->delta_primal_solution};
+    double **con_vectors[] = {
+        &state->constraint_lower_bound, &state->constraint_upper_bound,
+        &state->constraint_rescaling, &state->initial_dual_solution,
+        &state->current_dual_solution, &state->pdhg_dual_solution,
+        &state->reflected_dual_solution, &state->primal_product,
+        &state->primal_slack, &state->delta_dual_solution};
+    int num_var_vectors = sizeof(var_vectors) / sizeof(var_vectors[0]);
+    int num_con_vectors = sizeof(con_vectors) / sizeof(con_vectors[0]);
+    size_t var_slice = pool_slice_bytes(var_bytes);
+    size_t con_slice = pool_slice_bytes(con_bytes);
+    state->vector_pool_bytes =
+        num_var_vectors * var_slice + num_con_vectors * con_slice;
+    CUDA_CHECK(device_alloc(&state->vector_pool, state->vector_pool_bytes));
+    CUDA_CHECK(cudaMemset(state->vector_pool, 0, state->vector_pool_bytes));
+    char *slice = (char *)state->vector_pool;
+    for (int k = 0; k < num_var_vectors; ++k, slice += var_slice)
+        *var_vectors[k] = (double *)slice;
+    for (int k = 0; k < num_con_vectors; ++k, slice += con_slice)
+        *con_vectors[k] = (double *)slice;
+
+    upload_problem_vectors(state, rescale_info);
+    CUDA_CHECK(device_alloc(&state->reduction_buffer,
+                          REDUCTION_BUFFER_SIZE * sizeof(double)));
+
+    state->variable_partition = rescale_info->var_partition;
+    state->constraint_partition = rescale_info->con_partition;
+    state->variable_permutation = (int *)safe_malloc(n_vars * sizeof(int));
+    state->constraint_permutation = (int *)safe_malloc(n_cons * sizeof(int));
+    memcpy(state->variable_permutation, rescale_info->var_perm,
+           n_vars * sizeof(int));
+    memcpy(state->constraint_permutation, rescale_info->con_perm,
+           n_cons * sizeof(int));
+
+    upload_starting_point(state, rescale_info, original_problem->primal_start,
+                          original_problem->dual_start);
+    compute_problem_norms(state, original_problem);
+
+    state->num_blocks_primal =
+        (state->num_variables + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+    state->num_blocks_dual =
+        (state->num_constraints + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+    state->num_blocks_primal_dual =
+        (state->num_variables + state->num_constraints + THREADS_PER_BLOCK - 1) /
+        THREADS_PER_BLOCK;
+
+    state->best_primal_dual_residual_gap = INFINITY;
+    state->last_trial_fixed_point_error = INFINITY;
+    state->step_size = 0.0;
+    state->is_this_major_iteration = false;
+
+    create_spmv_descriptors(state);
+
+    state->device_memory_bytes = device_bytes_allocated - allocated_before;
+
+    return state;
+}
+
+#define COPY_TO_DEVICE(dest, src, bytes) \
+    CUDA_CHECK(cudaMemcpy(dest, src, bytes, cudaMemcpyHostToDevice));
+
+// bounds, objective and rescaling of the scaled problem into the vector pool
+static void upload_problem_vectors(pdhg_solver_state_t *state,
+                                   const rescale_info_t *rescale_info)
+{
+    size_t var_bytes = state->num_variables * sizeof(double);
+    size_t con_bytes = state->num_constraints * sizeof(double);
+
+    COPY_TO_DEVICE(state->variable_lower_bound,
                    rescale_info->scaled_problem->variable_lower_bound, var_bytes);
-    ALLOC_AND_COPY(state->variable_upper_bound,
+    COPY_TO_DEVICE(state->variable_upper_bound,
                    rescale_info->scaled_problem->variable_upper_bound, var_bytes);
-    ALLOC_AND_COPY(state->objective_vector,
+    COPY_TO_DEVICE(state->objective_vector,
                    rescale_info->scaled_problem->objective_vector, var_bytes);
-    ALLOC_AND_COPY(state->constraint_lower_bound,
+    COPY_TO_DEVICE(state->constraint_lower_bound,
                    rescale_info->scaled_problem->constraint_lower_bound,
                    con_bytes);
-    ALLOC_AND_COPY(state->constraint_upper_bound,
+    COPY_TO_DEVICE(state->constraint_upper_bound,
                    rescale_info->scaled_problem->constraint_upper_bound,
                    con_bytes);
-    ALLOC_AND_COPY(state->constraint_rescaling, rescale_info->con_rescale,
+    COPY_TO_DEVICE(state->constraint_rescaling, rescale_info->con_rescale,
                    con_bytes);
-    ALLOC_AND_COPY(state->variable_rescaling, rescale_info->var_rescale,
+    COPY_TO_DEVICE(state->variable_rescaling, rescale_info->var_rescale,
                    var_bytes);
 
     state->constraint_bound_rescaling = rescale_info->con_bound_rescale;
     state->objective_vector_rescaling = rescale_info->obj_vec_rescale;
+}
 
-#define ALLOC_ZERO(dest, bytes)           \
-    CUDA_CHECK(cudaMalloc(&dest, bytes)); \
-    CUDA_CHECK(cudaMemset(dest, 0, bytes));
+// starting points come in the original order and are permuted and scaled
+// like the problem; a missing one stays at zero
+static void upload_starting_point(pdhg_solver_state_t *state,
+                                  const rescale_info_t *rescale_info,
+                                  const double *primal_start,
+                                  const double *dual_start)
+{
+    int n_vars = state->num_variables;
+    int n_cons = state->num_constraints;
+    size_t var_bytes = n_vars * sizeof(double);
+    size_t con_bytes = n_cons * sizeof(double);
 
-    ALLOC_ZERO(state->initial_primal_solution, var_bytes);
-    ALLOC_ZERO(state->current_primal_solution, var_bytes);
-    ALLOC_ZERO(state->pdhg_primal_solution, var_bytes);
-    ALLOC_ZERO(state->reflected_primal_solution, var_bytes);
-    ALLOC_ZERO(state->dual_product, var_bytes);
-    ALLOC_ZERO(state->dual_slack, var_bytes);
-    ALLOC_ZERO(state->dual_residual, var_bytes);
-    ALLOC_ZERO(state->delta_primal_solution, var_bytes);
-
-    ALLOC_ZERO(state->initial_dual_solution, con_bytes);
-    ALLOC_ZERO(state->current_dual_solution, con_bytes);
-    ALLOC_ZERO(state->pdhg_dual_solution, con_bytes);
-    ALLOC_ZERO(state->reflected_dual_solution, con_bytes);
-    ALLOC_ZERO(state->primal_product, con_bytes);
-    ALLOC_ZERO(state->primal_slack, con_bytes);
-    ALLOC_ZERO(state->primal_residual, con_bytes);
-    ALLOC_ZERO(state->delta_dual_solution, con_bytes);
-
-    if (original_problem->primal_start)
+    if (primal_start)
     {
         double *rescaled = (double *)safe_malloc(var_bytes);
+        permute_vector(primal_start, rescale_info->var_perm, n_vars, rescaled);
         for (int i = 0; i < n_vars; ++i)
-            rescaled[i] = original_problem->primal_start[i] *
-                          rescale_info->var_rescale[i] *
+            rescaled[i] = rescaled[i] * rescale_info->var_rescale[i] *
                           rescale_info->con_bound_rescale;
-        CUDA_CHECK(cudaMemcpy(state->initial_primal_solution, rescaled, var_bytes,
-                              cudaMemcpyHostToDevice));
-        CUDA_CHECK(cudaMemcpy(state->current_primal_solution, rescaled, var_bytes,
-                              cudaMemcpyHostToDevice));
-        CUDA_CHECK(cudaMemcpy(state->pdhg_primal_solution, rescaled, var_bytes,
-                              cudaMemcpyHostToDevice));
+        COPY_TO_DEVICE(state->initial_primal_solution, rescaled, var_bytes);
+        COPY_TO_DEVICE(state->current_primal_solution, rescaled, var_bytes);
+        COPY_TO_DEVICE(state->pdhg_primal_solution, rescaled, var_bytes);
         free(rescaled);
     }
-    if (original_problem->dual_start)
+    if (dual_start)
     {
         double *rescaled = (double *)safe_malloc(con_bytes);
+        permute_vector(dual_start, rescale_info->con_perm, n_cons, rescaled);
         for (int i = 0; i < n_cons; ++i)
-            rescaled[i] = original_problem->dual_start[i] *
-                          rescale_info->con_rescale[i] *
+            rescaled[i] = rescaled[i] * rescale_info->con_rescale[i] *
                           rescale_info->obj_vec_rescale;
-        CUDA_CHECK(cudaMemcpy(state->initial_dual_solution, rescaled, con_bytes,
-                              cudaMemcpyHostToDevice));
-        CUDA_CHECK(cudaMemcpy(state->current_dual_solution, rescaled, con_bytes,
-                              cudaMemcpyHostToDevice));
-        CUDA_CHECK(cudaMemcpy(state->pdhg_dual_solution, rescaled, con_bytes,
-                              cudaMemcpyHostToDevice));
+        COPY_TO_DEVICE(state->initial_dual_solution, rescaled, con_bytes);
+        COPY_TO_DEVICE(state->current_dual_solution, rescaled, con_bytes);
+        COPY_TO_DEVICE(state->pdhg_dual_solution, rescaled, con_bytes);
         free(rescaled);
     }
+}
 
-    double *temp_host = (double *)safe_malloc(fmax(var_bytes, con_bytes));
-    for (int i = 0; i < n_cons; ++i)
-        temp_host[i] =
-            isfinite(rescale_info->scaled_problem->constraint_lower_bound[i])
-                ? rescale_info->scaled_problem->constraint_lower_bound[i]
-                : 0.0;
-    ALLOC_AND_COPY(state->constraint_lower_bound_finite_val, temp_host,
-                   con_bytes);
-    for (int i = 0; i < n_cons; ++i)
-        temp_host[i] =
-            isfinite(rescale_info->scaled_problem->constraint_upper_bound[i])
-                ? rescale_info->scaled_problem->constraint_upper_bound[i]
-                : 0.0;
-    ALLOC_AND_COPY(state->constraint_upper_bound_finite_val, temp_host,
-                   con_bytes);
-    for (int i = 0; i < n_vars; ++i)
-        temp_host[i] =
-            isfinite(rescale_info->scaled_problem->variable_lower_bound[i])
-                ? rescale_info->scaled_problem->variable_lower_bound[i]
-                : 0.0;
-    ALLOC_AND_COPY(state->variable_lower_bound_finite_val, temp_host, var_bytes);
-    for (int i = 0; i < n_vars; ++i)
-        temp_host[i] =
-            isfinite(rescale_info->scaled_problem->variable_upper_bound[i])
-                ? rescale_info->scaled_problem->variable_upper_bound[i]
-                : 0.0;
-    ALLOC_AND_COPY(state->variable_upper_bound_finite_val, temp_host, var_bytes);
-    free(temp_host);
+static void compute_problem_norms(pdhg_solver_state_t *state,
+                                  const lp_problem_t *original_problem)
+{
+    state->objective_constant = original_problem->objective_constant;
 
     double sum_of_squares = 0.0;
 
-    for (int i = 0; i < n_vars; ++i)
+    for (int i = 0; i < original_problem->num_variables; ++i)
     {
         sum_of_squares += original_problem->objective_vector[i] *
                           original_problem->objective_vector[i];
@@ -386,7 +1143,7 @@ initialize_solver_state(const lp_problem_t *original_problem,
 
     sum_of_squares = 0.0;
 
-    for (int i = 0; i < n_cons; ++i)
+    for (int i = 0; i < original_problem->num_constraints; ++i)
     {
         double lower = original_problem->constraint_lower_bound[i];
         double upper = original_problem->constraint_upper_bound[i];
@@ -403,22 +1160,13 @@ initialize_solver_state(const lp_problem_t *original_problem,
     }
 
     state->constraint_bound_norm = sqrt(sum_of_squares);
-    state->num_blocks_primal =
-        (state->num_variables + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
-    state->num_blocks_dual =
-        (state->num_constraints + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
-    state->num_blocks_primal_dual =
-        (state->num_variables + state->num_constraints + THREADS_PER_BLOCK - 1) /
-        THREADS_PER_BLOCK;
-
-    state->best_primal_dual_residual_gap = INFINITY;
-    state->last_trial_fixed_point_error = INFINITY;
-    state->step_size = 0.0;
-    state->is_this_major_iteration = false;
-
-    size_t primal_spmv_buffer_size;
-    size_t dual_spmv_buffer_size;
+}
 
+// a coded matrix has no values on the device and never calls cuSPARSE SpMV
+static void create_spmv_descriptors(pdhg_solver_state_t *state)
+{
+    if (state->num_coefficient_values > 0)
+        return;
     CUSPARSE_CHECK(cusparseCreateCsr(
         &state->matA, state->num_constraints, state->num_variables,
         state->constraint_matrix->num_nonzeros, state->constraint_matrix->row_ptr,
@@ -428,13 +1176,17 @@ initialize_solver_state(const lp_problem_t *original_problem,
 
     CUDA_CHECK(cudaGetLastError());
 
-    CUSPARSE_CHECK(cusparseCreateCsr(
-        &state->matAt, state->num_variables, state->num_constraints,
-        state->constraint_matrix_t->num_nonzeros,
-        state->constraint_matrix_t->row_ptr, state->constraint_matrix_t->col_ind,
-        state->constraint_matrix_t->val, CUSPARSE_INDEX_32I, CUSPARSE_INDEX_32I,
-        CUSPARSE_INDEX_BASE_ZERO, CUDA_R_64F));
-    CUDA_CHECK(cudaGetLastError());
+    bool transposed = state->dual_scatter.slices.num_partitions == 0;
+    if (transposed)
+    {
+        CUSPARSE_CHECK(cusparseCreateCsr(
+            &state->matAt, state->num_variables, state->num_constraints,
+            state->constraint_matrix_t->num_nonzeros,
+            state->constraint_matrix_t->row_ptr, state->constraint_matrix_t->col_ind,
+            state->constraint_matrix_t->val, CUSPARSE_INDEX_32I, CUSPARSE_INDEX_32I,
+            CUSPARSE_INDEX_BASE_ZERO, CUDA_R_64F));
+        CUDA_CHECK(cudaGetLastError());
+    }
 
     CUSPARSE_CHECK(cusparseCreateDnVec(&state->vec_primal_sol,
                                        state->num_variables,
@@ -451,110 +1203,232 @@ initialize_solver_state(const lp_problem_t *original_problem,
     CUSPARSE_CHECK(cusparseSpMV_bufferSize(
         state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
         state->matA, state->vec_primal_sol, &HOST_ZERO, state->vec_primal_prod,
-        CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, &primal_spmv_buffer_size));
-
-    CUSPARSE_CHECK(cusparseSpMV_bufferSize(
-        state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
-        state->matAt, state->vec_dual_sol, &HOST_ZERO, state->vec_dual_prod,
-        CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, &dual_spmv_buffer_size));
-    CUDA_CHECK(cudaMalloc(&state->primal_spmv_buffer, primal_spmv_buffer_size));
+        CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, &state->primal_spmv_buffer_size));
+    CUDA_CHECK(device_alloc(&state->primal_spmv_buffer,
+                          state->primal_spmv_buffer_size));
     CUSPARSE_CHECK(cusparseSpMV_preprocess(
         state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
         state->matA, state->vec_primal_sol, &HOST_ZERO, state->vec_primal_prod,
         CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->primal_spmv_buffer));
 
-    CUDA_CHECK(cudaMalloc(&state->dual_spmv_buffer, dual_spmv_buffer_size));
-    CUSPARSE_CHECK(cusparseSpMV_preprocess(
-        state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
-        state->matAt, state->vec_dual_sol, &HOST_ZERO, state->vec_dual_prod,
-        CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->dual_spmv_buffer));
+    state->dual_spmv_buffer = NULL;
+    if (transposed)
+    {
+        CUSPARSE_CHECK(cusparseSpMV_bufferSize(
+            state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
+            state->matAt, state->vec_dual_sol, &HOST_ZERO, state->vec_dual_prod,
+            CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, &state->dual_spmv_buffer_size));
+        CUDA_CHECK(
+            device_alloc(&state->dual_spmv_buffer, state->dual_spmv_buffer_size));
+        CUSPARSE_CHECK(cusparseSpMV_preprocess(
+            state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
+            state->matAt, state->vec_dual_sol, &HOST_ZERO, state->vec_dual_prod,
+            CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->dual_spmv_buffer));
+    }
+}
 
-    CUDA_CHECK(
-        cudaMalloc(&state->ones_primal_d, state->num_variables * sizeof(double)));
-    CUDA_CHECK(
-        cudaMalloc(&state->ones_dual_d, state->num_constraints * sizeof(double)));
+static void destroy_spmv_descriptors(pdhg_solver_state_t *state)
+{
+    if (state->num_coefficient_values > 0)
+        return;
+    CUSPARSE_CHECK(cusparseDestroySpMat(state->matA));
+    if (state->dual_scatter.slices.num_partitions == 0)
+        CUSPARSE_CHECK(cusparseDestroySpMat(state->matAt));
+    CUSPARSE_CHECK(cusparseDestroyDnVec(state->vec_primal_sol));
+    CUSPARSE_CHECK(cusparseDestroyDnVec(state->vec_dual_sol));
+    CUSPARSE_CHECK(cusparseDestroyDnVec(state->vec_primal_prod));
+    CUSPARSE_CHECK(cusparseDestroyDnVec(state->vec_dual_prod));
+    CUDA_CHECK(cudaFree(state->primal_spmv_buffer));
+    if (state->dual_spmv_buffer)
+        CUDA_CHECK(cudaFree(state->dual_spmv_buffer));
+}
 
-    double *ones_primal_h =
-        (double *)safe_malloc(state->num_variables * sizeof(double));
-    for (int i = 0; i < state->num_variables; ++i)
-        ones_primal_h[i] = 1.0;
-    CUDA_CHECK(cudaMemcpy(state->ones_primal_d, ones_primal_h,
-                          state->num_variables * sizeof(double),
-                          cudaMemcpyHostToDevice));
-    free(ones_primal_h);
+// the partition groups indices by bound type, so each group only loads the
+// bounds it has and warps diverge at no more than four group boundaries
+__device__ __forceinline__ double project_onto_bounds(double x,
+                                                      const double *lb,
+                                                      const double *ub, int i,
+                                                      bound_partition_t part)
+{
+    if (i < part.free_end)
+        return x;
+    if (i < part.lower_end)
+        return fmax(lb[i], x);
+    if (i < part.upper_end)
+        return fmin(x, ub[i]);
+    if (i < part.boxed_end)
+        return fmax(lb[i], fmin(x, ub[i]));
+    return lb[i];
+}
 
-    double *ones_dual_h =
-        (double *)safe_malloc(state->num_constraints * sizeof(double));
-    for (int i = 0; i < state->num_constraints; ++i)
-        ones_dual_h[i] = 1.0;
-    CUDA_CHECK(cudaMemcpy(state->ones_dual_d, ones_dual_h,
-                          state->num_constraints * sizeof(double),
-                          cudaMemcpyHostToDevice));
-    free(ones_dual_h);
+// the plain-iteration kernels take two entries per thread through 16-byte
+// loads and stores; every vector is a pool slice or a cudaMalloc allocation,
+// so an even index is always aligned, and an odd last entry goes alone
+__device__ __forceinline__ double2 load_pair(const double *v, int i)
+{
+    return *reinterpret_cast<const double2 *>(v + i);
+}
 
-    return state;
+__device__ __forceinline__ void store_pair(double *v, int i, double2 value)
+{
+    *reinterpret_cast<double2 *>(v + i) = value;
+}
+
+__device__ __forceinline__ double
+reflect_primal_entry(double x, double c, double dual_product, const double *lb,
+                     const double *ub, int i, bound_partition_t part,
+                     double step_size)
+{
+    double temp = x - step_size * (c - dual_product);
+    return 2.0 * project_onto_bounds(temp, lb, ub, i, part) - x;
 }
 
+// ZERO_OBJECTIVE is the feasibility problem of the primal polish, which has
+// no objective vector at all
+template <bool ZERO_OBJECTIVE>
 __global__ void compute_next_pdhg_primal_solution_kernel(
     const double *current_primal, double *reflected_primal,
     const double *dual_product, const double *objective, const double *var_lb,
-    const double *var_ub, int n, double step_size)
+    const double *var_ub, bound_partition_t part, int n, double step_size)
 {
-    int i = blockIdx.x * blockDim.x + threadIdx.x;
-    if (i < n)
+    int i = 2 * (blockIdx.x * blockDim.x + threadIdx.x);
+    if (i + 1 < n)
     {
-        double temp =
-            current_primal[i] - step_size * (objective[i] - dual_product[i]);
-        double temp_proj = fmax(var_lb[i], fmin(temp, var_ub[i]));
-        reflected_primal[i] = 2.0 * temp_proj - current_primal[i];
+        double2 x = load_pair(current_primal, i);
+        double2 g = load_pair(dual_product, i);
+        double2 c = ZERO_OBJECTIVE ? make_double2(0.0, 0.0)
+                                   : load_pair(objective, i);
+        double2 r;
+        r.x = reflect_primal_entry(x.x, c.x, g.x, var_lb, var_ub, i, part,
+                                   step_size);
+        r.y = reflect_primal_entry(x.y, c.y, g.y, var_lb, var_ub, i + 1, part,
+                                   step_size);
+        store_pair(reflected_primal, i, r);
+    }
+    else if (i < n)
+    {
+        reflected_primal[i] = reflect_primal_entry(
+            current_primal[i], ZERO_OBJECTIVE ? 0.0 : objective[i],
+            dual_product[i], var_lb, var_ub, i, part, step_size);
     }
 }
 
+template <bool ZERO_OBJECTIVE>
 __global__ void compute_next_pdhg_primal_solution_major_kernel(
     const double *current_primal, double *pdhg_primal, double *reflected_primal,
     const double *dual_product, const double *objective, const double *var_lb,
-    const double *var_ub, int n, double step_size, double *dual_slack)
+    const double *var_ub, bound_partition_t part, int n, double step_size,
+    double *dual_slack)
 {
     int i = blockIdx.x * blockDim.x + threadIdx.x;
     if (i < n)
     {
-        double temp =
-            current_primal[i] - step_size * (objective[i] - dual_product[i]);
-        pdhg_primal[i] = fmax(var_lb[i], fmin(temp, var_ub[i]));
+        double c = ZERO_OBJECTIVE ? 0.0 : objective[i];
+        double temp = current_primal[i] - step_size * (c - dual_product[i]);
+        pdhg_primal[i] = project_onto_bounds(temp, var_lb, var_ub, i, part);
         dual_slack[i] = (pdhg_primal[i] - temp) / step_size;
         reflected_primal[i] = 2.0 * pdhg_primal[i] - current_primal[i];
     }
 }
 
+__device__ __forceinline__ double
+reflect_dual_entry(double y, double primal_product, const double *lb,
+                   const double *ub, int i, bound_partition_t part,
+                   double step_size)
+{
+    double temp = y / step_size - primal_product;
+    double temp_proj = -project_onto_bounds(-temp, lb, ub, i, part);
+    return 2.0 * (temp - temp_proj) * step_size - y;
+}
+
 __global__ void compute_next_pdhg_dual_solution_kernel(
     const double *current_dual, double *reflected_dual,
     const double *primal_product, const double *const_lb,
-    const double *const_ub, int n, double step_size)
+    const double *const_ub, bound_partition_t part, int n, double step_size)
 {
-    int i = blockIdx.x * blockDim.x + threadIdx.x;
-    if (i < n)
+    int i = 2 * (blockIdx.x * blockDim.x + threadIdx.x);
+    if (i + 1 < n)
     {
-        double temp = current_dual[i] / step_size - primal_product[i];
-        double temp_proj = fmax(-const_ub[i], fmin(temp, -const_lb[i]));
-        reflected_dual[i] = 2.0 * (temp - temp_proj) * step_size - current_dual[i];
+        double2 y = load_pair(current_dual, i);
+        double2 a = load_pair(primal_product, i);
+        double2 r;
+        r.x = reflect_dual_entry(y.x, a.x, const_lb, const_ub, i, part,
+                                 step_size);
+        r.y = reflect_dual_entry(y.y, a.y, const_lb, const_ub, i + 1, part,
+                                 step_size);
+        store_pair(reflected_dual, i, r);
+    }
+    else if (i < n)
+    {
+        reflected_dual[i] = reflect_dual_entry(current_dual[i], primal_product[i],
+                                               const_lb, const_ub, i, part,
+                                               step_size);
     }
 }
 
 __global__ void compute_next_pdhg_dual_solution_major_kernel(
     const double *current_dual, double *pdhg_dual, double *reflected_dual,
     const double *primal_product, const double *const_lb,
-    const double *const_ub, int n, double step_size)
+    const double *const_ub, bound_partition_t part, int n, double step_size)
 {
     int i = blockIdx.x * blockDim.x + threadIdx.x;
     if (i < n)
     {
         double temp = current_dual[i] / step_size - primal_product[i];
-        double temp_proj = fmax(-const_ub[i], fmin(temp, -const_lb[i]));
+        double temp_proj = -project_onto_bounds(-temp, const_lb, const_ub, i, part);
         pdhg_dual[i] = (temp - temp_proj) * step_size;
         reflected_dual[i] = 2.0 * pdhg_dual[i] - current_dual[i];
     }
 }
 
+__device__ __forceinline__ double halpern_entry(double initial, double current,
+                                                double reflected, double weight,
+                                                double reflection_coeff)
+{
+    double relaxed =
+        reflection_coeff * reflected + (1.0 - reflection_coeff) * current;
+    return weight * relaxed + (1.0 - weight) * initial;
+}
+
+__device__ __forceinline__ void
+halpern_update_pair(int i, int n, const double *initial, double *current,
+                    const double *reflected, double weight,
+                    double reflection_coeff)
+{
+    if (i + 1 < n)
+    {
+        double2 x0 = load_pair(initial, i);
+        double2 x = load_pair(current, i);
+        double2 r = load_pair(reflected, i);
+        x.x = halpern_entry(x0.x, x.x, r.x, weight, reflection_coeff);
+        x.y = halpern_entry(x0.y, x.y, r.y, weight, reflection_coeff);
+        store_pair(current, i, x);
+    }
+    else if (i < n)
+    {
+        current[i] = halpern_entry(initial[i], current[i], reflected[i], weight,
+                                   reflection_coeff);
+    }
+}
+
+// threads [0, primal pairs) update the primal entries, the rest the dual ones
+__device__ __forceinline__ void
+halpern_update_entry(int t, const double *initial_primal, double *current_primal,
+                     const double *reflected_primal, const double *initial_dual,
+                     double *current_dual, const double *reflected_dual,
+                     int n_vars, int n_cons, double weight,
+                     double reflection_coeff)
+{
+    int primal_pairs = (n_vars + 1) / 2;
+    if (t < primal_pairs)
+        halpern_update_pair(2 * t, n_vars, initial_primal, current_primal,
+                            reflected_primal, weight, reflection_coeff);
+    else
+        halpern_update_pair(2 * (t - primal_pairs), n_cons, initial_dual,
+                            current_dual, reflected_dual, weight,
+                            reflection_coeff);
+}
+
 __global__ void
 halpern_update_kernel(const double *initial_primal, double *current_primal,
                       const double *reflected_primal,
@@ -562,20 +1436,31 @@ halpern_update_kernel(const double *initial_primal, double *current_primal,
                       const double *reflected_dual, int n_vars, int n_cons,
                       double weight, double reflection_coeff)
 {
-    int i = blockIdx.x * blockDim.x + threadIdx.x;
-    if (i < n_vars)
-    {
-        double reflected = reflection_coeff * reflected_primal[i] +
-                           (1.0 - reflection_coeff) * current_primal[i];
-        current_primal[i] = weight * reflected + (1.0 - weight) * initial_primal[i];
-    }
-    else if (i < n_vars + n_cons)
-    {
-        int idx = i - n_vars;
-        double reflected = reflection_coeff * reflected_dual[idx] +
-                           (1.0 - reflection_coeff) * current_dual[idx];
-        current_dual[idx] = weight * reflected + (1.0 - weight) * initial_dual[idx];
-    }
+    halpern_update_entry(blockIdx.x * blockDim.x + threadIdx.x, initial_primal,
+                         current_primal, reflected_primal, initial_dual,
+                         current_dual, reflected_dual, n_vars, n_cons, weight,
+                         reflection_coeff);
+}
+
+// same update with the weight taken from the device-side inner count, so a
+// captured graph can be replayed without changing its parameters
+__global__ void halpern_update_counted_kernel(
+    const double *initial_primal, double *current_primal,
+    const double *reflected_primal, const double *initial_dual,
+    double *current_dual, const double *reflected_dual, int n_vars, int n_cons,
+    const int *inner_count, double reflection_coeff)
+{
+    int k = *inner_count;
+    double weight = (double)(k + 1) / (k + 2);
+    halpern_update_entry(blockIdx.x * blockDim.x + threadIdx.x, initial_primal,
+                         current_primal, reflected_primal, initial_dual,
+                         current_dual, reflected_dual, n_vars, n_cons, weight,
+                         reflection_coeff);
+}
+
+__global__ void advance_inner_count_kernel(int *inner_count)
+{
+    (*inner_count)++;
 }
 
 __global__ void rescale_solution_kernel(double *primal_solution,
@@ -617,56 +1502,62 @@ __global__ void compute_delta_solution_kernel(
     }
 }
 
+// grids of the kernels that take a pair of entries per thread
+static int pair_blocks(int n)
+{
+    return ((n + 1) / 2 + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+}
+
+static int pair_blocks_primal_dual(int n_vars, int n_cons)
+{
+    return ((n_vars + 1) / 2 + (n_cons + 1) / 2 + THREADS_PER_BLOCK - 1) /
+           THREADS_PER_BLOCK;
+}
+
 static void compute_next_pdhg_primal_solution(pdhg_solver_state_t *state)
 {
     NVTX_RANGE("updateprimal");
-    CUSPARSE_CHECK(cusparseDnVecSetValues(state->vec_dual_sol,
-                                          state->current_dual_solution));
-    CUSPARSE_CHECK(
-        cusparseDnVecSetValues(state->vec_dual_prod, state->dual_product));
-
-    CUSPARSE_CHECK(cusparseSpMV(
-        state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
-        state->matAt, state->vec_dual_sol, &HOST_ZERO, state->vec_dual_prod,
-        CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->dual_spmv_buffer));
+    compute_dual_product(state, state->current_dual_solution,
+                         state->dual_product);
 
     double step = state->step_size / state->primal_weight;
+    // the primal polish state has no objective vector
+    bool zero_objective = state->objective_vector == NULL;
 
     if (state->is_this_major_iteration ||
         ((state->total_count + 2) %
          get_print_frequency(state->total_count + 2)) == 0)
     {
-        compute_next_pdhg_primal_solution_major_kernel<<<state->num_blocks_primal,
-                                                         THREADS_PER_BLOCK>>>(
+        auto kernel = zero_objective
+                          ? compute_next_pdhg_primal_solution_major_kernel<true>
+                          : compute_next_pdhg_primal_solution_major_kernel<false>;
+        kernel<<<state->num_blocks_primal, THREADS_PER_BLOCK, 0,
+                 state->stream>>>(
             state->current_primal_solution, state->pdhg_primal_solution,
             state->reflected_primal_solution, state->dual_product,
             state->objective_vector, state->variable_lower_bound,
-            state->variable_upper_bound, state->num_variables, step,
-            state->dual_slack);
+            state->variable_upper_bound, state->variable_partition,
+            state->num_variables, step, state->dual_slack);
     }
     else
     {
-        compute_next_pdhg_primal_solution_kernel<<<state->num_blocks_primal,
-                                                   THREADS_PER_BLOCK>>>(
+        auto kernel = zero_objective
+                          ? compute_next_pdhg_primal_solution_kernel<true>
+                          : compute_next_pdhg_primal_solution_kernel<false>;
+        kernel<<<pair_blocks(state->num_variables), THREADS_PER_BLOCK, 0,
+                 state->stream>>>(
             state->current_primal_solution, state->reflected_primal_solution,
             state->dual_product, state->objective_vector,
             state->variable_lower_bound, state->variable_upper_bound,
-            state->num_variables, step);
+            state->variable_partition, state->num_variables, step);
     }
 }
 
 static void compute_next_pdhg_dual_solution(pdhg_solver_state_t *state)
 {
     NVTX_RANGE("updatedual");
-    CUSPARSE_CHECK(cusparseDnVecSetValues(state->vec_primal_sol,
-                                          state->reflected_primal_solution));
-    CUSPARSE_CHECK(
-        cusparseDnVecSetValues(state->vec_primal_prod, state->primal_product));
-
-    CUSPARSE_CHECK(cusparseSpMV(
-        state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
-        state->matA, state->vec_primal_sol, &HOST_ZERO, state->vec_primal_prod,
-        CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->primal_spmv_buffer));
+    compute_primal_product(state, state->reflected_primal_solution,
+                           state->primal_product);
 
     double step = state->step_size * state->primal_weight;
 
@@ -675,19 +1566,22 @@ static void compute_next_pdhg_dual_solution(pdhg_solver_state_t *state)
          get_print_frequency(state->total_count + 2)) == 0)
     {
         compute_next_pdhg_dual_solution_major_kernel<<<state->num_blocks_dual,
-                                                       THREADS_PER_BLOCK>>>(
+                                                       THREADS_PER_BLOCK, 0,
+                                                       state->stream>>>(
             state->current_dual_solution, state->pdhg_dual_solution,
             state->reflected_dual_solution, state->primal_product,
             state->constraint_lower_bound, state->constraint_upper_bound,
-            state->num_constraints, step);
+            state->constraint_partition, state->num_constraints, step);
     }
     else
     {
-        compute_next_pdhg_dual_solution_kernel<<<state->num_blocks_dual,
-                                                 THREADS_PER_BLOCK>>>(
+        compute_next_pdhg_dual_solution_kernel<<<
+            pair_blocks(state->num_constraints), THREADS_PER_BLOCK, 0,
+            state->stream>>>(
             state->current_dual_solution, state->reflected_dual_solution,
             state->primal_product, state->constraint_lower_bound,
-            state->constraint_upper_bound, state->num_constraints, step);
+            state->constraint_upper_bound, state->constraint_partition,
+            state->num_constraints, step);
     }
 }
 
@@ -696,7 +1590,9 @@ static void halpern_update(pdhg_solver_state_t *state,
 {
     NVTX_RANGE("halpernupdate");
     double weight = (double)(state->inner_count + 1) / (state->inner_count + 2);
-    halpern_update_kernel<<<state->num_blocks_primal_dual, THREADS_PER_BLOCK>>>(
+    halpern_update_kernel<<<
+        pair_blocks_primal_dual(state->num_variables, state->num_constraints),
+        THREADS_PER_BLOCK, 0, state->stream>>>(
         state->initial_primal_solution, state->current_primal_solution,
         state->reflected_primal_solution, state->initial_dual_solution,
         state->current_dual_solution, state->reflected_dual_solution,
@@ -704,9 +1600,226 @@ static void halpern_update(pdhg_solver_state_t *state,
         reflection_coefficient);
 }
 
+// the main state runs on the per-thread default stream, which unlike the
+// legacy one can be captured
+static void enable_plain_iteration_graph(pdhg_solver_state_t *state)
+{
+    CUDA_CHECK(cudaMalloc(&state->inner_count_d, sizeof(int)));
+}
+
+static void disable_plain_iteration_graph(pdhg_solver_state_t *state)
+{
+    if (state->plain_iteration_graph)
+        CUDA_CHECK(cudaGraphExecDestroy(state->plain_iteration_graph));
+    CUDA_CHECK(cudaFree(state->inner_count_d));
+    state->plain_iteration_graph = NULL;
+    state->inner_count_d = NULL;
+}
+
+// the body of a plain iteration: non-major updates and the halpern step
+static void launch_plain_iteration(pdhg_solver_state_t *state,
+                                   double reflection_coefficient)
+{
+    compute_dual_product(state, state->current_dual_solution,
+                         state->dual_product);
+    compute_next_pdhg_primal_solution_kernel<false><<<
+        pair_blocks(state->num_variables), THREADS_PER_BLOCK, 0,
+        state->stream>>>(
+        state->current_primal_solution, state->reflected_primal_solution,
+        state->dual_product, state->objective_vector,
+        state->variable_lower_bound, state->variable_upper_bound,
+        state->variable_partition, state->num_variables,
+        state->step_size / state->primal_weight);
+
+    compute_primal_product(state, state->reflected_primal_solution,
+                           state->primal_product);
+    compute_next_pdhg_dual_solution_kernel<<<
+        pair_blocks(state->num_constraints), THREADS_PER_BLOCK, 0,
+        state->stream>>>(
+        state->current_dual_solution, state->reflected_dual_solution,
+        state->primal_product, state->constraint_lower_bound,
+        state->constraint_upper_bound, state->constraint_partition,
+        state->num_constraints, state->step_size * state->primal_weight);
+
+    halpern_update_counted_kernel<<<
+        pair_blocks_primal_dual(state->num_variables, state->num_constraints),
+        THREADS_PER_BLOCK, 0, state->stream>>>(
+        state->initial_primal_solution, state->current_primal_solution,
+        state->reflected_primal_solution, state->initial_dual_solution,
+        state->current_dual_solution, state->reflected_dual_solution,
+        state->num_variables, state->num_constraints, state->inner_count_d,
+        reflection_coefficient);
+    advance_inner_count_kernel<<<1, 1, 0, state->stream>>>(state->inner_count_d);
+}
+
+static void capture_plain_iteration(pdhg_solver_state_t *state,
+                                    double reflection_coefficient)
+{
+    NVTX_RANGE("capturegraph");
+    if (state->plain_iteration_graph)
+        CUDA_CHECK(cudaGraphExecDestroy(state->plain_iteration_graph));
+
+    cudaGraph_t graph;
+    CUDA_CHECK(cudaStreamBeginCapture(state->stream,
+                                      cudaStreamCaptureModeThreadLocal));
+    launch_plain_iteration(state, reflection_coefficient);
+    CUDA_CHECK(cudaStreamEndCapture(state->stream, &graph));
+    CUDA_CHECK(cudaGraphInstantiateWithFlags(&state->plain_iteration_graph,
+                                             graph, 0));
+    CUDA_CHECK(cudaGraphDestroy(graph));
+
+    state->graph_step_size = state->step_size;
+    state->graph_primal_weight = state->primal_weight;
+}
+
+namespace cg = cooperative_groups;
+
+// count plain iterations in one launch: each thread keeps the same entries
+// throughout and grid barriers separate A^T y with the primal update from
+// A x with the dual and halpern updates; the products are summed row by
+// row in order, so runs are reproducible but not bitwise equal to cuSPARSE
+__global__ void persistent_plain_iterations_kernel(
+    int n_vars, int n_cons, const int *__restrict__ row_ptr,
+    const int *__restrict__ col_ind, const double *__restrict__ val,
+    const int *__restrict__ t_row_ptr, const int *__restrict__ t_col_ind,
+    const double *__restrict__ t_val, const double *objective,
+    const double *var_lb, const double *var_ub, bound_partition_t var_part,
+    const double *con_lb, const double *con_ub, bound_partition_t con_part,
+    const double *initial_primal, double *current_primal,
+    double *reflected_primal, const double *initial_dual, double *current_dual,
+    double *reflected_dual, int inner_count, int count, double primal_step,
+    double dual_step, double reflection_coeff)
+{
+    cg::grid_group grid = cg::this_grid();
+    int stride = gridDim.x * blockDim.x;
+    int first = blockIdx.x * blockDim.x + threadIdx.x;
+    for (int it = 0; it < count; ++it)
+    {
+        for (int j = first; j < n_vars; j += stride)
+        {
+            double dual_product = 0.0;
+            for (int k = t_row_ptr[j]; k < t_row_ptr[j + 1]; ++k)
+                dual_product += t_val[k] * current_dual[t_col_ind[k]];
+            reflected_primal[j] = reflect_primal_entry(
+                current_primal[j], objective[j], dual_product, var_lb, var_ub, j,
+                var_part, primal_step);
+        }
+        grid.sync();
+
+        // the primal halpern step rides along: nothing in this phase reads
+        // the current primal iterate
+        double weight = (double)(inner_count + it + 1) / (inner_count + it + 2);
+        for (int i = first; i < n_cons; i += stride)
+        {
+            double primal_product = 0.0;
+            for (int k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+                primal_product += val[k] * reflected_primal[col_ind[k]];
+            double reflected = reflect_dual_entry(current_dual[i], primal_product,
+                                                  con_lb, con_ub, i, con_part,
+                                                  dual_step);
+            reflected_dual[i] = reflected;
+            current_dual[i] = halpern_entry(initial_dual[i], current_dual[i],
+                                            reflected, weight, reflection_coeff);
+        }
+        for (int j = first; j < n_vars; j += stride)
+            current_primal[j] =
+                halpern_entry(initial_primal[j], current_primal[j],
+                              reflected_primal[j], weight, reflection_coeff);
+        grid.sync();
+    }
+}
+
+// the kernel reads both A and its transpose as sparse values, so split
+// dense rows and columns, a missing transpose or a coded matrix keep the
+// regular path, as does a device without cooperative launch
+static void enable_persistent_iterations(pdhg_solver_state_t *state)
+{
+    state->persistent_blocks = 0;
+    if (state->num_dense_rows > 0 || state->num_dense_cols > 0 ||
+        state->dual_scatter.slices.num_partitions > 0 ||
+        state->num_coefficient_values > 0)
+        return;
+    int device, cooperative, sms, blocks_per_sm;
+    CUDA_CHECK(cudaGetDevice(&device));
+    CUDA_CHECK(cudaDeviceGetAttribute(&cooperative,
+                                      cudaDevAttrCooperativeLaunch, device));
+    if (!cooperative)
+        return;
+    CUDA_CHECK(cudaDeviceGetAttribute(&sms, cudaDevAttrMultiProcessorCount,
+                                      device));
+    CUDA_CHECK(cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+        &blocks_per_sm, persistent_plain_iterations_kernel, THREADS_PER_BLOCK,
+        0));
+    int needed = (state->num_variables > state->num_constraints)
+                     ? state->num_blocks_primal
+                     : state->num_blocks_dual;
+    int resident = blocks_per_sm * sms;
+    state->persistent_blocks = (needed < resident) ? needed : resident;
+}
+
+static void run_persistent_iterations(pdhg_solver_state_t *state,
+                                      const pdhg_parameters_t *params,
+                                      int count)
+{
+    int n_vars = state->num_variables;
+    int n_cons = state->num_constraints;
+    const int *row_ptr = state->constraint_matrix->row_ptr;
+    const int *col_ind = state->constraint_matrix->col_ind;
+    const double *val = state->constraint_matrix->val;
+    const int *t_row_ptr = state->constraint_matrix_t->row_ptr;
+    const int *t_col_ind = state->constraint_matrix_t->col_ind;
+    const double *t_val = state->constraint_matrix_t->val;
+    int inner_count = state->inner_count;
+    double primal_step = state->step_size / state->primal_weight;
+    double dual_step = state->step_size * state->primal_weight;
+    double reflection_coeff = params->reflection_coefficient;
+    void *args[] = {
+        &n_vars, &n_cons, &row_ptr, &col_ind, &val, &t_row_ptr, &t_col_ind,
+        &t_val, &state->objective_vector, &state->variable_lower_bound,
+        &state->variable_upper_bound, &state->variable_partition,
+        &state->constraint_lower_bound, &state->constraint_upper_bound,
+        &state->constraint_partition, &state->initial_primal_solution,
+        &state->current_primal_solution, &state->reflected_primal_solution,
+        &state->initial_dual_solution, &state->current_dual_solution,
+        &state->reflected_dual_solution, &inner_count, &count, &primal_step,
+        &dual_step, &reflection_coeff};
+    CUDA_CHECK(cudaLaunchCooperativeKernel(
+        (void *)persistent_plain_iterations_kernel, state->persistent_blocks,
+        THREADS_PER_BLOCK, args, 0, state->stream));
+}
+
+// replays count plain iterations; the graph bakes in the step sizes, so it
+// is captured again after a restart changed the primal weight
+static void run_plain_iterations(pdhg_solver_state_t *state,
+                                 const pdhg_parameters_t *params, int count)
+{
+    NVTX_RANGE("plainiterations");
+    if (state->persistent_blocks > 0)
+    {
+        run_persistent_iterations(state, params, count);
+        state->inner_count += count;
+        state->total_count += count;
+        return;
+    }
+    if (state->plain_iteration_graph == NULL ||
+        state->graph_step_size != state->step_size ||
+        state->graph_primal_weight != state->primal_weight)
+        capture_plain_iteration(state, params->reflection_coefficient);
+
+    CUDA_CHECK(cudaMemcpyAsync(state->inner_count_d, &state->inner_count,
+                               sizeof(int), cudaMemcpyHostToDevice,
+                               state->stream));
+    for (int k = 0; k < count; ++k)
+        CUDA_CHECK(cudaGraphLaunch(state->plain_iteration_graph, state->stream));
+
+    state->inner_count += count;
+    state->total_count += count;
+}
+
 static void rescale_solution(pdhg_solver_state_t *state)
 {
-    rescale_solution_kernel<<<state->num_blocks_primal_dual, THREADS_PER_BLOCK>>>(
+    rescale_solution_kernel<<<state->num_blocks_primal_dual, THREADS_PER_BLOCK, 0,
+                              state->stream>>>(
         state->pdhg_primal_solution, state->pdhg_dual_solution,
         state->variable_rescaling, state->constraint_rescaling,
         state->objective_vector_rescaling, state->constraint_bound_rescaling,
@@ -725,18 +1838,16 @@ static void perform_restart(pdhg_solver_state_t *state,
     double delta_error = 0.0;
     bool weight_updated = false;
     compute_delta_solution_kernel<<<state->num_blocks_primal_dual,
-                                    THREADS_PER_BLOCK>>>(
+                                    THREADS_PER_BLOCK, 0, state->stream>>>(
         state->initial_primal_solution, state->pdhg_primal_solution,
         state->delta_primal_solution, state->initial_dual_solution,
         state->pdhg_dual_solution, state->delta_dual_solution,
         state->num_variables, state->num_constraints);
 
-    double primal_dist, dual_dist;
-    CUBLAS_CHECK(cublasDnrm2_v2_64(state->blas_handle, state->num_variables,
-                                   state->delta_primal_solution, 1,
-                                   &primal_dist));
-    CUBLAS_CHECK(cublasDnrm2_v2_64(state->blas_handle, state->num_constraints,
-                                   state->delta_dual_solution, 1, &dual_dist));
+    double primal_dist = get_vector_norm(state, state->num_variables,
+                                         state->delta_primal_solution);
+    double dual_dist = get_vector_norm(state, state->num_constraints,
+                                       state->delta_dual_solution);
 
     double ratio_infeas =
         state->relative_dual_residual / state->relative_primal_residual;
@@ -785,18 +1896,22 @@ static void perform_restart(pdhg_solver_state_t *state,
         }
     }
 
-    CUDA_CHECK(cudaMemcpy(
+    CUDA_CHECK(cudaMemcpyAsync(
         state->initial_primal_solution, state->pdhg_primal_solution,
-        state->num_variables * sizeof(double), cudaMemcpyDeviceToDevice));
-    CUDA_CHECK(cudaMemcpy(
+        state->num_variables * sizeof(double), cudaMemcpyDeviceToDevice,
+        state->stream));
+    CUDA_CHECK(cudaMemcpyAsync(
         state->current_primal_solution, state->pdhg_primal_solution,
-        state->num_variables * sizeof(double), cudaMemcpyDeviceToDevice));
-    CUDA_CHECK(cudaMemcpy(state->initial_dual_solution, state->pdhg_dual_solution,
-                          state->num_constraints * sizeof(double),
-                          cudaMemcpyDeviceToDevice));
-    CUDA_CHECK(cudaMemcpy(state->current_dual_solution, state->pdhg_dual_solution,
-                          state->num_constraints * sizeof(double),
-                          cudaMemcpyDeviceToDevice));
+        state->num_variables * sizeof(double), cudaMemcpyDeviceToDevice,
+        state->stream));
+    CUDA_CHECK(cudaMemcpyAsync(
+        state->initial_dual_solution, state->pdhg_dual_solution,
+        state->num_constraints * sizeof(double), cudaMemcpyDeviceToDevice,
+        state->stream));
+    CUDA_CHECK(cudaMemcpyAsync(
+        state->current_dual_solution, state->pdhg_dual_solution,
+        state->num_constraints * sizeof(double), cudaMemcpyDeviceToDevice,
+        state->stream));
 
     state->inner_count = 0;
     state->last_trial_fixed_point_error = INFINITY;
@@ -806,16 +1921,20 @@ static void
 initialize_step_size_and_primal_weight(pdhg_solver_state_t *state,
                                        const pdhg_parameters_t *params)
 {
-    if (state->constraint_matrix->num_nonzeros == 0)
-    {
-        state->step_size = 1.0;
-    }
-    else
+    // a step size already set comes from an earlier setup of the same matrix
+    if (state->step_size == 0.0)
     {
-        double max_sv = estimate_maximum_singular_value(
-            state->sparse_handle, state->blas_handle, state->constraint_matrix,
-            state->constraint_matrix_t, params->sv_max_iter, params->sv_tol);
-        state->step_size = 0.998 / max_sv;
+        if (state->constraint_matrix->num_nonzeros == 0 &&
+            state->num_dense_rows == 0 && state->num_dense_cols == 0)
+        {
+            state->step_size = 1.0;
+        }
+        else
+        {
+            double max_sv = estimate_maximum_singular_value(
+                state, params->sv_max_iter, params->sv_tol);
+            state->step_size = 0.998 / max_sv;
+        }
     }
 
     if (params->bound_objective_rescaling)
@@ -834,39 +1953,21 @@ static void compute_fixed_point_error(pdhg_solver_state_t *state)
 {
     NVTX_RANGE("fixedpointerror");
     compute_delta_solution_kernel<<<state->num_blocks_primal_dual,
-                                    THREADS_PER_BLOCK>>>(
+                                    THREADS_PER_BLOCK, 0, state->stream>>>(
         state->current_primal_solution, state->reflected_primal_solution,
         state->delta_primal_solution, state->current_dual_solution,
         state->reflected_dual_solution, state->delta_dual_solution,
         state->num_variables, state->num_constraints);
 
-    CUSPARSE_CHECK(
-        cusparseDnVecSetValues(state->vec_dual_sol, state->delta_dual_solution));
-    CUSPARSE_CHECK(
-        cusparseDnVecSetValues(state->vec_dual_prod, state->dual_product));
-
-    CUSPARSE_CHECK(cusparseSpMV(
-        state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
-        state->matAt, state->vec_dual_sol, &HOST_ZERO, state->vec_dual_prod,
-        CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->dual_spmv_buffer));
+    compute_dual_product(state, state->delta_dual_solution, state->dual_product);
 
     double interaction, movement;
 
-    double primal_norm = 0.0;
-    double dual_norm = 0.0;
-    double cross_term = 0.0;
-
-    CUBLAS_CHECK(cublasDnrm2_v2_64(state->blas_handle, state->num_constraints,
-                                   state->delta_dual_solution, 1, &dual_norm));
-    CUBLAS_CHECK(cublasDnrm2_v2_64(state->blas_handle, state->num_variables,
-                                   state->delta_primal_solution, 1,
-                                   &primal_norm));
-    movement = primal_norm * primal_norm * state->primal_weight +
-               dual_norm * dual_norm / state->primal_weight;
-
-    CUBLAS_CHECK(cublasDdot(state->blas_handle, state->num_variables,
-                            state->dual_product, 1, state->delta_primal_solution,
-                            1, &cross_term));
+    double primal_sq, dual_sq, cross_term;
+    get_movement_sums(state, &primal_sq, &dual_sq, &cross_term);
+    double primal_norm = sqrt(primal_sq);
+    double dual_norm = sqrt(dual_sq);
+    movement = primal_sq * state->primal_weight + dual_sq / state->primal_weight;
     interaction = 2 * state->step_size * cross_term;
 
     state->fixed_point_error = sqrt(movement + interaction);
@@ -888,12 +1989,10 @@ void pdhg_solver_state_free(pdhg_solver_state_t *state)
         return;
     }
 
-    if (state->variable_lower_bound)
-        CUDA_CHECK(cudaFree(state->variable_lower_bound));
-    if (state->variable_upper_bound)
-        CUDA_CHECK(cudaFree(state->variable_upper_bound));
-    if (state->objective_vector)
-        CUDA_CHECK(cudaFree(state->objective_vector));
+    if (state->vector_pool)
+        CUDA_CHECK(cudaFree(state->vector_pool));
+    if (state->reduction_buffer)
+        CUDA_CHECK(cudaFree(state->reduction_buffer));
     if (state->constraint_matrix->row_ptr)
         CUDA_CHECK(cudaFree(state->constraint_matrix->row_ptr));
     if (state->constraint_matrix->col_ind)
@@ -906,59 +2005,54 @@ void pdhg_solver_state_free(pdhg_solver_state_t *state)
         CUDA_CHECK(cudaFree(state->constraint_matrix_t->col_ind));
     if (state->constraint_matrix_t->val)
         CUDA_CHECK(cudaFree(state->constraint_matrix_t->val));
-    if (state->constraint_lower_bound)
-        CUDA_CHECK(cudaFree(state->constraint_lower_bound));
-    if (state->constraint_upper_bound)
-        CUDA_CHECK(cudaFree(state->constraint_upper_bound));
-    if (state->constraint_lower_bound_finite_val)
-        CUDA_CHECK(cudaFree(state->constraint_lower_bound_finite_val));
-    if (state->constraint_upper_bound_finite_val)
-        CUDA_CHECK(cudaFree(state->constraint_upper_bound_finite_val));
-    if (state->variable_lower_bound_finite_val)
-        CUDA_CHECK(cudaFree(state->variable_lower_bound_finite_val));
-    if (state->variable_upper_bound_finite_val)
-        CUDA_CHECK(cudaFree(state->variable_upper_bound_finite_val));
-    if (state->initial_primal_solution)
-        CUDA_CHECK(cudaFree(state->initial_primal_solution));
-    if (state->current_primal_solution)
-        CUDA_CHECK(cudaFree(state->current_primal_solution));
-    if (state->pdhg_primal_solution)
-        CUDA_CHECK(cudaFree(state->pdhg_primal_solution));
-    if (state->reflected_primal_solution)
-        CUDA_CHECK(cudaFree(state->reflected_primal_solution));
-    if (state->dual_product)
-        CUDA_CHECK(cudaFree(state->dual_product));
-    if (state->initial_dual_solution)
-        CUDA_CHECK(cudaFree(state->initial_dual_solution));
-    if (state->current_dual_solution)
-        CUDA_CHECK(cudaFree(state->current_dual_solution));
-    if (state->pdhg_dual_solution)
-        CUDA_CHECK(cudaFree(state->pdhg_dual_solution));
-    if (state->reflected_dual_solution)
-        CUDA_CHECK(cudaFree(state->reflected_dual_solution));
-    if (state->primal_product)
-        CUDA_CHECK(cudaFree(state->primal_product));
-    if (state->constraint_rescaling)
-        CUDA_CHECK(cudaFree(state->constraint_rescaling));
-    if (state->variable_rescaling)
-        CUDA_CHECK(cudaFree(state->variable_rescaling));
-    if (state->primal_slack)
-        CUDA_CHECK(cudaFree(state->primal_slack));
-    if (state->dual_slack)
-        CUDA_CHECK(cudaFree(state->dual_slack));
-    if (state->primal_residual)
-        CUDA_CHECK(cudaFree(state->primal_residual));
-    if (state->dual_residual)
-        CUDA_CHECK(cudaFree(state->dual_residual));
-    if (state->delta_primal_solution)
-        CUDA_CHECK(cudaFree(state->delta_primal_solution));
-    if (state->delta_dual_solution)
-        CUDA_CHECK(cudaFree(state->delta_dual_solution));
-    if (state->ones_primal_d)
-        CUDA_CHECK(cudaFree(state->ones_primal_d));
-    if (state->ones_dual_d)
-        CUDA_CHECK(cudaFree(state->ones_dual_d));
-
+    if (state->coefficient_values)
+        CUDA_CHECK(cudaFree(state->coefficient_values));
+    if (state->constraint_matrix_codes)
+        CUDA_CHECK(cudaFree(state->constraint_matrix_codes));
+    if (state->constraint_matrix_t_codes)
+        CUDA_CHECK(cudaFree(state->constraint_matrix_t_codes));
+    if (state->coded_spmv_input)
+        CUDA_CHECK(cudaFree(state->coded_spmv_input));
+    if (state->row_merge_path.num_partitions > 0)
+    {
+        CUDA_CHECK(cudaFree(state->row_merge_path.start_row));
+        CUDA_CHECK(cudaFree(state->row_merge_path.start_nz));
+    }
+    if (state->col_merge_path.num_partitions > 0)
+    {
+        CUDA_CHECK(cudaFree(state->col_merge_path.start_row));
+        CUDA_CHECK(cudaFree(state->col_merge_path.start_nz));
+    }
+    if (state->dual_scatter.slices.num_partitions > 0)
+    {
+        CUDA_CHECK(cudaFree(state->dual_scatter.slices.start_row));
+        CUDA_CHECK(cudaFree(state->dual_scatter.slices.start_nz));
+        CUDA_CHECK(cudaFree(state->dual_scatter.col_begin));
+        CUDA_CHECK(cudaFree(state->dual_scatter.window_offset));
+        CUDA_CHECK(cudaFree(state->dual_scatter.column_ptr));
+        CUDA_CHECK(cudaFree(state->dual_scatter.column_windows));
+        CUDA_CHECK(cudaFree(state->dual_scatter.partials));
+    }
+    if (state->dense_row_index)
+        CUDA_CHECK(cudaFree(state->dense_row_index));
+    if (state->dense_rows)
+        CUDA_CHECK(cudaFree(state->dense_rows));
+    if (state->dense_col_index)
+        CUDA_CHECK(cudaFree(state->dense_col_index));
+    if (state->dense_cols)
+        CUDA_CHECK(cudaFree(state->dense_cols));
+
+    if (state->plain_iteration_graph)
+        CUDA_CHECK(cudaGraphExecDestroy(state->plain_iteration_graph));
+    if (state->inner_count_d)
+        CUDA_CHECK(cudaFree(state->inner_count_d));
+
+    destroy_spmv_descriptors(state);
+    CUSPARSE_CHECK(cusparseDestroy(state->sparse_handle));
+    CUBLAS_CHECK(cublasDestroy(state->blas_handle));
+
+    free(state->variable_permutation);
+    free(state->constraint_permutation);
     free(state);
 }
 
@@ -972,6 +2066,10 @@ void rescale_info_free(rescale_info_t *info)
     lp_problem_free(info->scaled_problem);
     free(info->con_rescale);
     free(info->var_rescale);
+    free(info->var_perm);
+    free(info->con_perm);
+    dense_split_free(&info->dense);
+    coefficient_codes_free(&info->codes);
 
     free(info);
 }
@@ -988,12 +2086,20 @@ static cupdlpx_result_t *create_result_from_state(pdhg_solver_state_t *state)
     results->dual_solution =
         (double *)safe_malloc(state->num_constraints * sizeof(double));
 
-    CUDA_CHECK(cudaMemcpy(results->primal_solution, state->pdhg_primal_solution,
+    // the solver works on the bound-type grouped order
+    double *temp_host = (double *)safe_malloc(
+        fmax(state->num_variables, state->num_constraints) * sizeof(double));
+    CUDA_CHECK(cudaMemcpy(temp_host, state->pdhg_primal_solution,
                           state->num_variables * sizeof(double),
                           cudaMemcpyDeviceToHost));
-    CUDA_CHECK(cudaMemcpy(results->dual_solution, state->pdhg_dual_solution,
+    unpermute_vector(temp_host, state->variable_permutation,
+                     state->num_variables, results->primal_solution);
+    CUDA_CHECK(cudaMemcpy(temp_host, state->pdhg_dual_solution,
                           state->num_constraints * sizeof(double),
                           cudaMemcpyDeviceToHost));
+    unpermute_vector(temp_host, state->constraint_permutation,
+                     state->num_constraints, results->dual_solution);
+    free(temp_host);
 
     results->num_variables = state->num_variables;
     results->num_constraints = state->num_constraints;
@@ -1013,11 +2119,25 @@ static cupdlpx_result_t *create_result_from_state(pdhg_solver_state_t *state)
     results->termination_reason = state->termination_reason;
     results->feasibility_polishing_time = state->feasibility_polishing_time;
     results->feasibility_iteration = state->feasibility_iteration;
+    results->device_memory_bytes = state->device_memory_bytes;
 
     return results;
 }
 
 // Feasibility Polishing
+static void flush_polish_log(pdhg_solver_state_t *state)
+{
+    if (state->polish_log == NULL)
+        return;
+    char buffer[4096];
+    size_t length;
+    rewind(state->polish_log);
+    while ((length = fread(buffer, 1, sizeof(buffer), state->polish_log)) > 0)
+        fwrite(buffer, 1, length, stdout);
+    fclose(state->polish_log);
+    state->polish_log = NULL;
+}
+
 void feasibility_polish(const pdhg_parameters_t *params, pdhg_solver_state_t *state)
 {
     double start_time = monotonic_time_sec();
@@ -1038,29 +2158,63 @@ void feasibility_polish(const pdhg_parameters_t *params, pdhg_solver_state_t *st
         original_primal_weight = (state->objective_vector_norm + 1.0) / (state->constraint_bound_norm + 1.0);
     }
 
-    // PRIMAL FEASIBILITY POLISHING
+    // the phases run side by side on their own streams; next to their own
+    // allocations each takes over main-state buffers that are dead after the
+    // main loop, and the two sets are disjoint:
+    //   primal phase: initial, current and reflected primal, primal_product
+    //                 and delta_primal_solution, which holds its pdhg primal
+    //   dual phase:   initial, current and reflected dual, dual_product,
+    //                 dual_slack and delta_dual_solution, which holds its
+    //                 pdhg dual
+    // the main pdhg solutions, bounds and scaling are only read
     pdhg_solver_state_t *primal_state = initialize_primal_feas_polish_state(state);
     primal_state->primal_weight = original_primal_weight;
     primal_state->best_primal_weight = original_primal_weight;
-    primal_feasibility_polish(params, primal_state, state);
+    pdhg_solver_state_t *dual_state = initialize_dual_feas_polish_state(state);
+    dual_state->primal_weight = original_primal_weight;
+    dual_state->best_primal_weight = original_primal_weight;
+    CUDA_CHECK(cudaStreamSynchronize(state->stream));
+
+    // with verbose output each phase logs into its own temporary file,
+    // printed in turn after the join
+    if (params->verbose)
+    {
+        primal_state->polish_log = tmpfile();
+        dual_state->polish_log = tmpfile();
+    }
+
+    print_initial_feas_polish_info(params);
+    int device;
+    CUDA_CHECK(cudaGetDevice(&device));
+    std::thread primal_worker(
+        [params, primal_state, state, device]()
+        {
+            CUDA_CHECK(cudaSetDevice(device));
+            primal_feasibility_polish(params, primal_state, state);
+            CUDA_CHECK(cudaStreamSynchronize(primal_state->stream));
+        });
+    dual_feasibility_polish(params, dual_state, state);
+    CUDA_CHECK(cudaStreamSynchronize(dual_state->stream));
+    primal_worker.join();
+    flush_polish_log(primal_state);
+    flush_polish_log(dual_state);
 
     if (primal_state->termination_reason == TERMINATION_REASON_FEAS_POLISH_SUCCESS)
     {
-        CUDA_CHECK(cudaMemcpy(
+        // on the dual stream, which evaluates the objective against it below
+        CUDA_CHECK(cudaMemcpyAsync(
             state->pdhg_primal_solution, primal_state->pdhg_primal_solution,
-            state->num_variables * sizeof(double), cudaMemcpyDeviceToDevice));
+            state->num_variables * sizeof(double), cudaMemcpyDeviceToDevice,
+            dual_state->stream));
         state->absolute_primal_residual = primal_state->absolute_primal_residual;
         state->relative_primal_residual = primal_state->relative_primal_residual;
         state->primal_objective_value = primal_state->primal_objective_value;
+
+        // the dual objective is evaluated against the primal solution
+        compute_dual_feas_polish_objective(dual_state, state);
     }
     state->feasibility_iteration += primal_state->total_count - 1;
 
-    // DUAL FEASIBILITY POLISHING
-    pdhg_solver_state_t *dual_state = initialize_dual_feas_polish_state(state);
-    dual_state->primal_weight = original_primal_weight;
-    dual_state->best_primal_weight = original_primal_weight;
-    dual_feasibility_polish(params, dual_state, state);
-
     if (dual_state->termination_reason == TERMINATION_REASON_FEAS_POLISH_SUCCESS)
     {
         CUDA_CHECK(cudaMemcpy(
@@ -1086,7 +2240,6 @@ void feasibility_polish(const pdhg_parameters_t *params, pdhg_solver_state_t *st
 
 void primal_feasibility_polish(const pdhg_parameters_t *params, pdhg_solver_state_t *state, const pdhg_solver_state_t *ori_state)
 {
-    print_initial_feas_polish_info(true, params);
     double start_time = monotonic_time_sec();
     bool do_restart = false;
     while (state->termination_reason == TERMINATION_REASON_UNSPECIFIED)
@@ -1132,7 +2285,6 @@ void primal_feasibility_polish(const pdhg_parameters_t *params, pdhg_solver_stat
 
 void dual_feasibility_polish(const pdhg_parameters_t *params, pdhg_solver_state_t *state, const pdhg_solver_state_t *ori_state)
 {
-    print_initial_feas_polish_info(false, params);
     double start_time = monotonic_time_sec();
     bool do_restart = false;
     while (state->termination_reason == TERMINATION_REASON_UNSPECIFIED)
@@ -1176,8 +2328,47 @@ void dual_feasibility_polish(const pdhg_parameters_t *params, pdhg_solver_state_
     return;
 }
 
+static void attach_feas_polish_stream(pdhg_solver_state_t *state)
+{
+    CUDA_CHECK(cudaStreamCreateWithFlags(&state->stream, cudaStreamNonBlocking));
+    CUSPARSE_CHECK(cusparseCreate(&state->sparse_handle));
+    CUSPARSE_CHECK(cusparseSetStream(state->sparse_handle, state->stream));
+    CUBLAS_CHECK(cublasCreate(&state->blas_handle));
+    CUBLAS_CHECK(
+        cublasSetPointerMode(state->blas_handle, CUBLAS_POINTER_MODE_HOST));
+    CUBLAS_CHECK(cublasSetStream(state->blas_handle, state->stream));
+    create_spmv_descriptors(state);
+    // the polish states run concurrently, so each needs its own scratch
+    CUDA_CHECK(cudaMalloc(&state->reduction_buffer,
+                          REDUCTION_BUFFER_SIZE * sizeof(double)));
+    if (state->num_coefficient_values > 0)
+    {
+        CUDA_CHECK(cudaMalloc(&state->coded_spmv_input,
+                              coded_spmv_scratch_size(state) * sizeof(double)));
+    }
+    if (state->dual_scatter.slices.num_partitions > 0)
+    {
+        CUDA_CHECK(cudaMalloc(&state->dual_scatter.partials,
+                              state->dual_scatter.num_window_entries *
+                                  sizeof(double)));
+    }
+}
+
+static void detach_feas_polish_stream(pdhg_solver_state_t *state)
+{
+    destroy_spmv_descriptors(state);
+    CUDA_CHECK(cudaFree(state->reduction_buffer));
+    if (state->num_coefficient_values > 0)
+        CUDA_CHECK(cudaFree(state->coded_spmv_input));
+    if (state->dual_scatter.slices.num_partitions > 0)
+        CUDA_CHECK(cudaFree(state->dual_scatter.partials));
+    CUSPARSE_CHECK(cusparseDestroy(state->sparse_handle));
+    CUBLAS_CHECK(cublasDestroy(state->blas_handle));
+    CUDA_CHECK(cudaStreamDestroy(state->stream));
+}
+
 static pdhg_solver_state_t *initialize_primal_feas_polish_state(
-    const pdhg_solver_state_t *original_state)
+    pdhg_solver_state_t *original_state)
 {
     pdhg_solver_state_t *primal_state = (pdhg_solver_state_t *)malloc(sizeof(pdhg_solver_state_t));
     *primal_state = *original_state;
@@ -1188,20 +2379,15 @@ static pdhg_solver_state_t *initialize_primal_feas_polish_state(
     CUDA_CHECK(cudaMalloc(&dest, bytes)); \
     CUDA_CHECK(cudaMemset(dest, 0, bytes));
 
-    // RESET PROBLEM TO FEASIBILITY PROBLEM
-    ALLOC_ZERO(primal_state->objective_vector, num_var * sizeof(double));
+    // RESET PROBLEM TO FEASIBILITY PROBLEM (ZERO OBJECTIVE), WHICH THE
+    // PRIMAL UPDATE KERNELS TAKE AS A TEMPLATE FLAG INSTEAD OF A VECTOR
+    primal_state->objective_vector = NULL;
     primal_state->objective_constant = 0.0;
 
-#define ALLOC_AND_COPY_DEV(dest, src, bytes) \
-    CUDA_CHECK(cudaMalloc(&dest, bytes));    \
-    CUDA_CHECK(cudaMemcpy(dest, src, bytes, cudaMemcpyDeviceToDevice));
-
-    // ALLOCATE AND COPY SOLUTION VECTORS
-    ALLOC_AND_COPY_DEV(primal_state->initial_primal_solution, original_state->initial_primal_solution, num_var * sizeof(double));
-    ALLOC_AND_COPY_DEV(primal_state->current_primal_solution, original_state->current_primal_solution, num_var * sizeof(double));
-    ALLOC_AND_COPY_DEV(primal_state->pdhg_primal_solution, original_state->pdhg_primal_solution, num_var * sizeof(double));
-    ALLOC_AND_COPY_DEV(primal_state->reflected_primal_solution, original_state->reflected_primal_solution, num_var * sizeof(double));
-    ALLOC_AND_COPY_DEV(primal_state->primal_product, original_state->primal_product, num_cons * sizeof(double));
+    // BORROW THE PRIMAL ITERATES OF THE MAIN STATE, WHICH ARE DEAD AFTER THE MAIN LOOP
+    // the main pdhg solution must survive, so the polish copy lives in the main delta buffer
+    primal_state->pdhg_primal_solution = original_state->delta_primal_solution;
+    CUDA_CHECK(cudaMemcpy(primal_state->pdhg_primal_solution, original_state->pdhg_primal_solution, num_var * sizeof(double), cudaMemcpyDeviceToDevice));
 
     // ALLOC ZERO FOR OTHERS
     ALLOC_ZERO(primal_state->initial_dual_solution, num_cons * sizeof(double));
@@ -1209,13 +2395,12 @@ static pdhg_solver_state_t *initialize_primal_feas_polish_state(
     ALLOC_ZERO(primal_state->pdhg_dual_solution, num_cons * sizeof(double));
     ALLOC_ZERO(primal_state->reflected_dual_solution, num_cons * sizeof(double));
     ALLOC_ZERO(primal_state->dual_product, num_var * sizeof(double));
-
     ALLOC_ZERO(primal_state->dual_slack, num_var * sizeof(double));
-    ALLOC_ZERO(primal_state->primal_slack, num_cons * sizeof(double));
-    ALLOC_ZERO(primal_state->dual_residual, num_var * sizeof(double));
-    ALLOC_ZERO(primal_state->primal_residual, num_cons * sizeof(double));
     ALLOC_ZERO(primal_state->delta_primal_solution, num_var * sizeof(double));
-    ALLOC_ZERO(primal_state->delta_dual_solution, num_cons * sizeof(double));
+
+    // NOT USED BY PRIMAL POLISHING
+    primal_state->primal_slack = NULL;
+    primal_state->delta_dual_solution = NULL;
 
     // RESET SCALAR
     primal_state->primal_weight_error_sum = 0.0;
@@ -1239,6 +2424,7 @@ static pdhg_solver_state_t *initialize_primal_feas_polish_state(
     primal_state->relative_objective_gap = 0.0;
     primal_state->objective_gap = 0.0;
 
+    attach_feas_polish_stream(primal_state);
     return primal_state;
 }
 
@@ -1253,25 +2439,15 @@ void primal_feas_polish_state_free(pdhg_solver_state_t *state)
 
     if (!state)
         return;
-    SAFE_CUDA_FREE(state->objective_vector);
-    SAFE_CUDA_FREE(state->initial_primal_solution);
-    SAFE_CUDA_FREE(state->current_primal_solution);
-    SAFE_CUDA_FREE(state->pdhg_primal_solution);
-    SAFE_CUDA_FREE(state->reflected_primal_solution);
-
-    SAFE_CUDA_FREE(state->dual_product);
+    detach_feas_polish_stream(state);
+    // only the buffers that are not borrowed from the main state
     SAFE_CUDA_FREE(state->initial_dual_solution);
     SAFE_CUDA_FREE(state->current_dual_solution);
     SAFE_CUDA_FREE(state->pdhg_dual_solution);
     SAFE_CUDA_FREE(state->reflected_dual_solution);
-    SAFE_CUDA_FREE(state->primal_product);
-
-    SAFE_CUDA_FREE(state->primal_slack);
+    SAFE_CUDA_FREE(state->dual_product);
     SAFE_CUDA_FREE(state->dual_slack);
-    SAFE_CUDA_FREE(state->primal_residual);
-    SAFE_CUDA_FREE(state->dual_residual);
     SAFE_CUDA_FREE(state->delta_primal_solution);
-    SAFE_CUDA_FREE(state->delta_dual_solution);
     free(state);
 }
 
@@ -1287,7 +2463,7 @@ __global__ void zero_finite_value_vectors_kernel(
 }
 
 static pdhg_solver_state_t *initialize_dual_feas_polish_state(
-    const pdhg_solver_state_t *original_state)
+    pdhg_solver_state_t *original_state)
 {
     pdhg_solver_state_t *dual_state = (pdhg_solver_state_t *)malloc(sizeof(pdhg_solver_state_t));
     *dual_state = *original_state;
@@ -1299,12 +2475,15 @@ static pdhg_solver_state_t *initialize_dual_feas_polish_state(
     CUDA_CHECK(cudaMemcpy(dest, src, bytes, cudaMemcpyDeviceToDevice));
 
 // RESET PROBLEM TO DUAL FEASIBILITY PROBLEM
-#define SET_FINITE_TO_ZERO(vec, n)                                     \
-    {                                                                  \
-        int threads = 256;                                             \
-        int blocks = (n + threads - 1) / threads;                      \
-        zero_finite_value_vectors_kernel<<<blocks, threads>>>(vec, n); \
-        CUDA_CHECK(cudaDeviceSynchronize());                           \
+// the state still runs on the stream of the main solve, so other solves on
+// the device are not held up
+#define SET_FINITE_TO_ZERO(vec, n)                                  \
+    {                                                               \
+        int threads = 256;                                          \
+        int blocks = (n + threads - 1) / threads;                   \
+        zero_finite_value_vectors_kernel<<<blocks, threads, 0,      \
+                                           dual_state->stream>>>(   \
+            vec, n);                                                \
     }
 
     ALLOC_AND_COPY_DEV(dual_state->constraint_lower_bound, original_state->constraint_lower_bound, num_cons * sizeof(double));
@@ -1316,23 +2495,16 @@ static pdhg_solver_state_t *initialize_dual_feas_polish_state(
     SET_FINITE_TO_ZERO(dual_state->constraint_upper_bound, num_cons);
     SET_FINITE_TO_ZERO(dual_state->variable_lower_bound, num_var);
     SET_FINITE_TO_ZERO(dual_state->variable_upper_bound, num_var);
+    CUDA_CHECK(cudaStreamSynchronize(dual_state->stream));
 
 #define ALLOC_ZERO(dest, bytes)           \
     CUDA_CHECK(cudaMalloc(&dest, bytes)); \
     CUDA_CHECK(cudaMemset(dest, 0, bytes));
 
-    ALLOC_ZERO(dual_state->constraint_lower_bound_finite_val, num_cons * sizeof(double));
-    ALLOC_ZERO(dual_state->constraint_upper_bound_finite_val, num_cons * sizeof(double));
-    ALLOC_ZERO(dual_state->variable_lower_bound_finite_val, num_var * sizeof(double));
-    ALLOC_ZERO(dual_state->variable_upper_bound_finite_val, num_var * sizeof(double));
-
-    // ALLOCATE AND COPY SOLUTION VECTORS
-    ALLOC_AND_COPY_DEV(dual_state->initial_dual_solution, original_state->initial_dual_solution, num_cons * sizeof(double));
-    ALLOC_AND_COPY_DEV(dual_state->current_dual_solution, original_state->current_dual_solution, num_cons * sizeof(double));
-    ALLOC_AND_COPY_DEV(dual_state->pdhg_dual_solution, original_state->pdhg_dual_solution, num_cons * sizeof(double));
-    ALLOC_AND_COPY_DEV(dual_state->reflected_dual_solution, original_state->reflected_dual_solution, num_cons * sizeof(double));
-    ALLOC_AND_COPY_DEV(dual_state->dual_product, original_state->dual_product, num_var * sizeof(double));
-    ALLOC_AND_COPY_DEV(dual_state->dual_slack, original_state->dual_slack, num_var * sizeof(double));
+    // BORROW THE DUAL ITERATES OF THE MAIN STATE, WHICH ARE DEAD AFTER THE MAIN LOOP
+    // the main pdhg solution must survive, so the polish copy lives in the main delta buffer
+    dual_state->pdhg_dual_solution = original_state->delta_dual_solution;
+    CUDA_CHECK(cudaMemcpy(dual_state->pdhg_dual_solution, original_state->pdhg_dual_solution, num_cons * sizeof(double), cudaMemcpyDeviceToDevice));
 
     // ALLOC ZERO FOR OTHERS
     ALLOC_ZERO(dual_state->initial_primal_solution, num_var * sizeof(double));
@@ -1340,12 +2512,12 @@ static pdhg_solver_state_t *initialize_dual_feas_polish_state(
     ALLOC_ZERO(dual_state->pdhg_primal_solution, num_var * sizeof(double));
     ALLOC_ZERO(dual_state->reflected_primal_solution, num_var * sizeof(double));
     ALLOC_ZERO(dual_state->primal_product, num_cons * sizeof(double));
-    ALLOC_ZERO(dual_state->primal_slack, num_cons * sizeof(double));
-    ALLOC_ZERO(dual_state->dual_residual, num_var * sizeof(double));
-    ALLOC_ZERO(dual_state->primal_residual, num_cons * sizeof(double));
-    ALLOC_ZERO(dual_state->delta_primal_solution, num_var * sizeof(double));
     ALLOC_ZERO(dual_state->delta_dual_solution, num_cons * sizeof(double));
 
+    // NOT USED BY DUAL POLISHING
+    dual_state->primal_slack = NULL;
+    dual_state->delta_primal_solution = NULL;
+
     // RESET SCALAR
     dual_state->primal_weight_error_sum = 0.0;
     dual_state->primal_weight_last_error = 0.0;
@@ -1367,6 +2539,8 @@ static pdhg_solver_state_t *initialize_dual_feas_polish_state(
     dual_state->absolute_primal_residual = 0.0;
     dual_state->relative_objective_gap = 0.0;
     dual_state->objective_gap = 0.0;
+
+    attach_feas_polish_stream(dual_state);
     return dual_state;
 }
 
@@ -1381,48 +2555,34 @@ void dual_feas_polish_state_free(pdhg_solver_state_t *state)
 
     if (!state)
         return;
+    detach_feas_polish_stream(state);
+    // only the buffers that are not borrowed from the main state
     SAFE_CUDA_FREE(state->constraint_lower_bound);
     SAFE_CUDA_FREE(state->constraint_upper_bound);
     SAFE_CUDA_FREE(state->variable_lower_bound);
     SAFE_CUDA_FREE(state->variable_upper_bound);
-    SAFE_CUDA_FREE(state->constraint_lower_bound_finite_val);
-    SAFE_CUDA_FREE(state->constraint_upper_bound_finite_val);
-    SAFE_CUDA_FREE(state->variable_lower_bound_finite_val);
-    SAFE_CUDA_FREE(state->variable_upper_bound_finite_val);
 
     SAFE_CUDA_FREE(state->initial_primal_solution);
     SAFE_CUDA_FREE(state->current_primal_solution);
     SAFE_CUDA_FREE(state->pdhg_primal_solution);
     SAFE_CUDA_FREE(state->reflected_primal_solution);
-
-    SAFE_CUDA_FREE(state->dual_product);
-    SAFE_CUDA_FREE(state->initial_dual_solution);
-    SAFE_CUDA_FREE(state->current_dual_solution);
-    SAFE_CUDA_FREE(state->pdhg_dual_solution);
-    SAFE_CUDA_FREE(state->reflected_dual_solution);
     SAFE_CUDA_FREE(state->primal_product);
-
-    SAFE_CUDA_FREE(state->primal_slack);
-    SAFE_CUDA_FREE(state->dual_slack);
-    SAFE_CUDA_FREE(state->primal_residual);
-    SAFE_CUDA_FREE(state->dual_residual);
-    SAFE_CUDA_FREE(state->delta_primal_solution);
     SAFE_CUDA_FREE(state->delta_dual_solution);
     free(state);
 }
 
 static void perform_primal_restart(pdhg_solver_state_t *state)
 {
-    CUDA_CHECK(cudaMemcpy(state->initial_primal_solution, state->pdhg_primal_solution, state->num_variables * sizeof(double), cudaMemcpyDeviceToDevice));
-    CUDA_CHECK(cudaMemcpy(state->current_primal_solution, state->pdhg_primal_solution, state->num_variables * sizeof(double), cudaMemcpyDeviceToDevice));
+    CUDA_CHECK(cudaMemcpyAsync(state->initial_primal_solution, state->pdhg_primal_solution, state->num_variables * sizeof(double), cudaMemcpyDeviceToDevice, state->stream));
+    CUDA_CHECK(cudaMemcpyAsync(state->current_primal_solution, state->pdhg_primal_solution, state->num_variables * sizeof(double), cudaMemcpyDeviceToDevice, state->stream));
     state->inner_count = 0;
     state->last_trial_fixed_point_error = INFINITY;
 }
 
 static void perform_dual_restart(pdhg_solver_state_t *state)
 {
-    CUDA_CHECK(cudaMemcpy(state->initial_dual_solution, state->pdhg_dual_solution, state->num_constraints * sizeof(double), cudaMemcpyDeviceToDevice));
-    CUDA_CHECK(cudaMemcpy(state->current_dual_solution, state->pdhg_dual_solution, state->num_constraints * sizeof(double), cudaMemcpyDeviceToDevice));
+    CUDA_CHECK(cudaMemcpyAsync(state->initial_dual_solution, state->pdhg_dual_solution, state->num_constraints * sizeof(double), cudaMemcpyDeviceToDevice, state->stream));
+    CUDA_CHECK(cudaMemcpyAsync(state->current_dual_solution, state->pdhg_dual_solution, state->num_constraints * sizeof(double), cudaMemcpyDeviceToDevice, state->stream));
     state->inner_count = 0;
     state->last_trial_fixed_point_error = INFINITY;
 }
@@ -1451,32 +2611,24 @@ __global__ void compute_delta_dual_solution_kernel(
 
 static void compute_primal_fixed_point_error(pdhg_solver_state_t *state)
 {
-    compute_delta_primal_solution_kernel<<<state->num_blocks_primal, THREADS_PER_BLOCK>>>(
+    compute_delta_primal_solution_kernel<<<state->num_blocks_primal, THREADS_PER_BLOCK, 0, state->stream>>>(
         state->current_primal_solution,
         state->reflected_primal_solution,
         state->delta_primal_solution,
         state->num_variables);
-    double primal_norm = 0.0;
-    CUBLAS_CHECK(cublasDnrm2_v2_64(state->blas_handle,
-                                   state->num_variables,
-                                   state->delta_primal_solution,
-                                   1,
-                                   &primal_norm));
+    double primal_norm = get_vector_norm(state, state->num_variables,
+                                         state->delta_primal_solution);
     state->fixed_point_error = primal_norm * primal_norm * state->primal_weight;
 }
 
 static void compute_dual_fixed_point_error(pdhg_solver_state_t *state)
 {
-    compute_delta_dual_solution_kernel<<<state->num_blocks_dual, THREADS_PER_BLOCK>>>(
+    compute_delta_dual_solution_kernel<<<state->num_blocks_dual, THREADS_PER_BLOCK, 0, state->stream>>>(
         state->current_dual_solution,
         state->reflected_dual_solution,
         state->delta_dual_solution,
         state->num_constraints);
-    double dual_norm = 0.0;
-    CUBLAS_CHECK(cublasDnrm2_v2_64(state->blas_handle,
-                                   state->num_constraints,
-                                   state->delta_dual_solution,
-                                   1,
-                                   &dual_norm));
+    double dual_norm = get_vector_norm(state, state->num_constraints,
+                                       state->delta_dual_solution);
     state->fixed_point_error = dual_norm * dual_norm / state->primal_weight;
 }
@@ -0,0 +1,685 @@
+/*
+Copyright 2025 Haihao Lu
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "structure.h"
+#include "utils.h"
+#include <math.h>
+#include <string.h>
+
+typedef enum
+{
+    BOUND_FREE = 0,
+    BOUND_LOWER = 1,
+    BOUND_UPPER = 2,
+    BOUND_BOXED = 3,
+    BOUND_FIXED = 4,
+    NUM_BOUND_TYPES = 5
+} bound_type_t;
+
+static bound_type_t classify_bounds(double lower, double upper)
+{
+    bool lower_finite = isfinite(lower);
+    bool upper_finite = isfinite(upper);
+    if (lower_finite && upper_finite)
+        return (lower == upper) ? BOUND_FIXED : BOUND_BOXED;
+    if (lower_finite && upper == INFINITY)
+        return BOUND_LOWER;
+    if (upper_finite && lower == -INFINITY)
+        return BOUND_UPPER;
+    if (lower == -INFINITY && upper == INFINITY)
+        return BOUND_FREE;
+    // anything odd (nan, empty infinite range) keeps the generic projection
+    return BOUND_BOXED;
+}
+
+bool same_bound_types(const double *lower_a, const double *upper_a,
+                      const double *lower_b, const double *upper_b, int n)
+{
+    for (int i = 0; i < n; ++i)
+    {
+        if (classify_bounds(lower_a[i], upper_a[i]) !=
+            classify_bounds(lower_b[i], upper_b[i]))
+            return false;
+    }
+    return true;
+}
+
+bound_partition_t partition_by_bound_type(const double *lower_bound,
+                                          const double *upper_bound,
+                                          const int *block, int n, int *perm)
+{
+    // within a bound type, entries of the same block stay together; this is
+    // an lsd radix sort, first by block and then by bound type
+    int *order = safe_malloc(n * sizeof(int));
+    if (block)
+    {
+        int num_keys = 0;
+        for (int i = 0; i < n; ++i)
+            if (block[i] + 1 > num_keys)
+                num_keys = block[i] + 1;
+        int *start = safe_calloc(num_keys + 1, sizeof(int));
+        for (int i = 0; i < n; ++i)
+            start[block[i] + 1]++;
+        for (int b = 0; b < num_keys; ++b)
+            start[b + 1] += start[b];
+        for (int i = 0; i < n; ++i)
+            order[start[block[i]]++] = i;
+        free(start);
+    }
+    else
+    {
+        for (int i = 0; i < n; ++i)
+            order[i] = i;
+    }
+
+    int count[NUM_BOUND_TYPES] = {0};
+    for (int i = 0; i < n; ++i)
+        count[classify_bounds(lower_bound[i], upper_bound[i])]++;
+
+    int start[NUM_BOUND_TYPES];
+    start[0] = 0;
+    for (int t = 1; t < NUM_BOUND_TYPES; ++t)
+        start[t] = start[t - 1] + count[t - 1];
+
+    bound_partition_t partition;
+    partition.free_end = start[BOUND_LOWER];
+    partition.lower_end = start[BOUND_UPPER];
+    partition.upper_end = start[BOUND_BOXED];
+    partition.boxed_end = start[BOUND_FIXED];
+
+    for (int k = 0; k < n; ++k)
+    {
+        int i = order[k];
+        perm[start[classify_bounds(lower_bound[i], upper_bound[i])]++] = i;
+    }
+
+    free(order);
+    return partition;
+}
+
+#define LINKING_MIN_MEAN_RATIO 10.0
+
+static int find_root(int *parent, int i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+int detect_block_structure(const lp_problem_t *prob, int *var_block,
+                           int *con_block, int *num_linking_rows,
+                           int *num_linking_cols)
+{
+    int m = prob->num_constraints;
+    int n = prob->num_variables;
+    int nnz = prob->constraint_matrix_num_nonzeros;
+    const int *row_ptr = prob->constraint_matrix_row_pointers;
+    const int *col_ind = prob->constraint_matrix_col_indices;
+
+    // rows and columns far above the mean length tie blocks together
+    int *col_count = safe_calloc(n, sizeof(int));
+    for (int k = 0; k < nnz; ++k)
+        col_count[col_ind[k]]++;
+    double row_threshold =
+        (m > 0) ? LINKING_MIN_MEAN_RATIO * nnz / (double)m : 0.0;
+    double col_threshold =
+        (n > 0) ? LINKING_MIN_MEAN_RATIO * nnz / (double)n : 0.0;
+
+    bool *linking_col = safe_calloc(n, sizeof(bool));
+    *num_linking_cols = 0;
+    for (int j = 0; j < n; ++j)
+    {
+        if (col_count[j] > 1 && col_count[j] >= col_threshold)
+        {
+            linking_col[j] = true;
+            (*num_linking_cols)++;
+        }
+    }
+    free(col_count);
+
+    // connected components of the remaining bipartite row/column graph
+    int *parent = safe_malloc(n * sizeof(int));
+    int *size = safe_malloc(n * sizeof(int));
+    for (int j = 0; j < n; ++j)
+    {
+        parent[j] = j;
+        size[j] = 1;
+    }
+
+    *num_linking_rows = 0;
+    for (int i = 0; i < m; ++i)
+    {
+        int length = row_ptr[i + 1] - row_ptr[i];
+        con_block[i] = -1;
+        if (length > 1 && length >= row_threshold)
+        {
+            (*num_linking_rows)++;
+            continue;
+        }
+        int first = -1;
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+        {
+            int j = col_ind[k];
+            if (linking_col[j])
+                continue;
+            if (first < 0)
+            {
+                first = j;
+                continue;
+            }
+            int a = find_root(parent, first);
+            int b = find_root(parent, j);
+            if (a == b)
+                continue;
+            if (size[a] < size[b])
+            {
+                int t = a;
+                a = b;
+                b = t;
+            }
+            parent[b] = a;
+            size[a] += size[b];
+        }
+        // remember a member column, resolved to a block id below
+        con_block[i] = first;
+    }
+
+    // number the components that own at least one row, in order of
+    // first appearance; everything else goes to the trailing linking group
+    int *root_id = safe_malloc(n * sizeof(int));
+    for (int j = 0; j < n; ++j)
+        root_id[j] = -1;
+    int num_blocks = 0;
+    for (int i = 0; i < m; ++i)
+    {
+        if (con_block[i] < 0)
+            continue;
+        int root = find_root(parent, con_block[i]);
+        if (root_id[root] < 0)
+            root_id[root] = num_blocks++;
+        con_block[i] = root_id[root];
+    }
+    for (int i = 0; i < m; ++i)
+        if (con_block[i] < 0)
+            con_block[i] = num_blocks;
+    for (int j = 0; j < n; ++j)
+    {
+        int id = linking_col[j] ? -1 : root_id[find_root(parent, j)];
+        var_block[j] = (id < 0) ? num_blocks : id;
+    }
+
+    free(root_id);
+    free(size);
+    free(parent);
+    free(linking_col);
+    return num_blocks;
+}
+
+void permute_vector(const double *src, const int *perm, int n, double *dst)
+{
+    for (int k = 0; k < n; ++k)
+        dst[k] = src[perm[k]];
+}
+
+void unpermute_vector(const double *src, const int *perm, int n, double *dst)
+{
+    for (int k = 0; k < n; ++k)
+        dst[perm[k]] = src[k];
+}
+
+typedef struct
+{
+    int col;
+    double val;
+} matrix_entry_t;
+
+static int compare_entry_col(const void *a, const void *b)
+{
+    const matrix_entry_t *x = (const matrix_entry_t *)a;
+    const matrix_entry_t *y = (const matrix_entry_t *)b;
+    return (x->col > y->col) - (x->col < y->col);
+}
+
+// rows are copied in their new order with renumbered columns; only rows
+// the column permutation left out of order are sorted, through a scratch
+// buffer of one row, so no second copy of the matrix is needed
+static void permute_csr(int num_rows, int num_cols, const int *src_row_ptr,
+                        const int *src_col_ind, const double *src_val,
+                        const int *row_perm, const int *col_perm, int *row_ptr,
+                        int *col_ind, double *val)
+{
+    int *col_inv = safe_malloc(num_cols * sizeof(int));
+    for (int k = 0; k < num_cols; ++k)
+        col_inv[col_perm[k]] = k;
+
+    matrix_entry_t *scratch = NULL;
+    int scratch_size = 0;
+
+    row_ptr[0] = 0;
+    for (int r = 0; r < num_rows; ++r)
+    {
+        int row = row_perm[r];
+        int begin = src_row_ptr[row];
+        int len = src_row_ptr[row + 1] - begin;
+        int dst = row_ptr[r];
+        bool sorted = true;
+        for (int k = 0; k < len; ++k)
+        {
+            col_ind[dst + k] = col_inv[src_col_ind[begin + k]];
+            val[dst + k] = src_val[begin + k];
+            if (k > 0 && col_ind[dst + k] < col_ind[dst + k - 1])
+                sorted = false;
+        }
+        if (!sorted)
+        {
+            if (len > scratch_size)
+            {
+                scratch_size = len;
+                scratch = safe_realloc(scratch, scratch_size * sizeof(matrix_entry_t));
+            }
+            for (int k = 0; k < len; ++k)
+            {
+                scratch[k].col = col_ind[dst + k];
+                scratch[k].val = val[dst + k];
+            }
+            qsort(scratch, len, sizeof(matrix_entry_t), compare_entry_col);
+            for (int k = 0; k < len; ++k)
+            {
+                col_ind[dst + k] = scratch[k].col;
+                val[dst + k] = scratch[k].val;
+            }
+        }
+        row_ptr[r + 1] = dst + len;
+    }
+
+    free(scratch);
+    free(col_inv);
+}
+
+lp_problem_t *permute_problem(const lp_problem_t *prob, const int *var_perm,
+                              const int *con_perm)
+{
+    int m = prob->num_constraints;
+    int n = prob->num_variables;
+    int nnz = prob->constraint_matrix_num_nonzeros;
+
+    lp_problem_t *new_prob = (lp_problem_t *)safe_malloc(sizeof(lp_problem_t));
+    new_prob->num_variables = n;
+    new_prob->num_constraints = m;
+    new_prob->constraint_matrix_num_nonzeros = nnz;
+    new_prob->objective_constant = prob->objective_constant;
+    new_prob->borrows_constraint_matrix = false;
+
+    size_t var_bytes = n * sizeof(double);
+    size_t con_bytes = m * sizeof(double);
+
+    new_prob->variable_lower_bound = safe_malloc(var_bytes);
+    new_prob->variable_upper_bound = safe_malloc(var_bytes);
+    new_prob->objective_vector = safe_malloc(var_bytes);
+    new_prob->constraint_lower_bound = safe_malloc(con_bytes);
+    new_prob->constraint_upper_bound = safe_malloc(con_bytes);
+
+    permute_vector(prob->variable_lower_bound, var_perm, n,
+                   new_prob->variable_lower_bound);
+    permute_vector(prob->variable_upper_bound, var_perm, n,
+                   new_prob->variable_upper_bound);
+    permute_vector(prob->objective_vector, var_perm, n,
+                   new_prob->objective_vector);
+    permute_vector(prob->constraint_lower_bound, con_perm, m,
+                   new_prob->constraint_lower_bound);
+    permute_vector(prob->constraint_upper_bound, con_perm, m,
+                   new_prob->constraint_upper_bound);
+
+    new_prob->primal_start = NULL;
+    new_prob->dual_start = NULL;
+    if (prob->primal_start)
+    {
+        new_prob->primal_start = safe_malloc(var_bytes);
+        permute_vector(prob->primal_start, var_perm, n, new_prob->primal_start);
+    }
+    if (prob->dual_start)
+    {
+        new_prob->dual_start = safe_malloc(con_bytes);
+        permute_vector(prob->dual_start, con_perm, m, new_prob->dual_start);
+    }
+
+    new_prob->constraint_matrix_row_pointers = safe_malloc((m + 1) * sizeof(int));
+    new_prob->constraint_matrix_col_indices = safe_malloc(nnz * sizeof(int));
+    new_prob->constraint_matrix_values = safe_malloc(nnz * sizeof(double));
+    permute_csr(m, n, prob->constraint_matrix_row_pointers,
+                prob->constraint_matrix_col_indices,
+                prob->constraint_matrix_values, con_perm, var_perm,
+                new_prob->constraint_matrix_row_pointers,
+                new_prob->constraint_matrix_col_indices,
+                new_prob->constraint_matrix_values);
+
+    // a transpose given with the problem is reordered the other way round
+    new_prob->constraint_matrix_t_row_pointers = NULL;
+    new_prob->constraint_matrix_t_col_indices = NULL;
+    new_prob->constraint_matrix_t_values = NULL;
+    new_prob->borrows_constraint_matrix_t = false;
+    if (prob->constraint_matrix_t_row_pointers)
+    {
+        new_prob->constraint_matrix_t_row_pointers = safe_malloc((n + 1) * sizeof(int));
+        new_prob->constraint_matrix_t_col_indices = safe_malloc(nnz * sizeof(int));
+        new_prob->constraint_matrix_t_values = safe_malloc(nnz * sizeof(double));
+        permute_csr(n, m, prob->constraint_matrix_t_row_pointers,
+                    prob->constraint_matrix_t_col_indices,
+                    prob->constraint_matrix_t_values, var_perm, con_perm,
+                    new_prob->constraint_matrix_t_row_pointers,
+                    new_prob->constraint_matrix_t_col_indices,
+                    new_prob->constraint_matrix_t_values);
+    }
+    return new_prob;
+}
+
+#define DENSE_MIN_DENSITY 0.3
+#define DENSE_MIN_MEAN_RATIO 10.0
+#define DENSE_MAX_COUNT 32
+
+typedef struct
+{
+    int index;
+    int count;
+} nnz_count_t;
+
+static int compare_nnz_count_desc(const void *a, const void *b)
+{
+    const nnz_count_t *x = (const nnz_count_t *)a;
+    const nnz_count_t *y = (const nnz_count_t *)b;
+    if (x->count != y->count)
+        return (x->count < y->count) ? 1 : -1;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+// picks at most DENSE_MAX_COUNT of the densest vectors that are both dense
+// in absolute terms and far above the mean; slot[i] becomes its position + 1
+static int select_dense(const int *count, int num, int length, int nnz,
+                        int *slot, int **selected)
+{
+    *selected = NULL;
+    if (num == 0 || length == 0)
+        return 0;
+    double threshold = fmax(DENSE_MIN_DENSITY * length,
+                            DENSE_MIN_MEAN_RATIO * nnz / (double)num);
+
+    nnz_count_t *candidates = safe_malloc(num * sizeof(nnz_count_t));
+    int num_candidates = 0;
+    for (int i = 0; i < num; ++i)
+    {
+        if (count[i] > 0 && count[i] >= threshold)
+        {
+            candidates[num_candidates].index = i;
+            candidates[num_candidates].count = count[i];
+            num_candidates++;
+        }
+    }
+    qsort(candidates, num_candidates, sizeof(nnz_count_t),
+          compare_nnz_count_desc);
+    if (num_candidates > DENSE_MAX_COUNT)
+        num_candidates = DENSE_MAX_COUNT;
+
+    if (num_candidates > 0)
+    {
+        *selected = safe_malloc(num_candidates * sizeof(int));
+        for (int k = 0; k < num_candidates; ++k)
+        {
+            (*selected)[k] = candidates[k].index;
+            slot[candidates[k].index] = k + 1;
+        }
+    }
+    free(candidates);
+    return num_candidates;
+}
+
+void split_dense_rows_and_columns(lp_problem_t *prob, dense_split_t *split)
+{
+    int m = prob->num_constraints;
+    int n = prob->num_variables;
+    int nnz = prob->constraint_matrix_num_nonzeros;
+    int *row_ptr = prob->constraint_matrix_row_pointers;
+    int *col_ind = prob->constraint_matrix_col_indices;
+    double *val = prob->constraint_matrix_values;
+
+    memset(split, 0, sizeof(*split));
+
+    int *row_count = safe_malloc(m * sizeof(int));
+    int *col_count = safe_calloc(n, sizeof(int));
+    for (int i = 0; i < m; ++i)
+        row_count[i] = row_ptr[i + 1] - row_ptr[i];
+    for (int k = 0; k < nnz; ++k)
+        col_count[col_ind[k]]++;
+
+    // slot + 1 of each dense row / column, 0 for sparse ones
+    int *row_slot = safe_calloc(m, sizeof(int));
+    int *col_slot = safe_calloc(n, sizeof(int));
+    split->num_rows =
+        select_dense(row_count, m, n, nnz, row_slot, &split->row_index);
+    split->num_cols =
+        select_dense(col_count, n, m, nnz, col_slot, &split->col_index);
+    free(row_count);
+    free(col_count);
+
+    if (split->num_rows == 0 && split->num_cols == 0)
+    {
+        free(row_slot);
+        free(col_slot);
+        return;
+    }
+
+    // a transpose given with the problem no longer matches once entries
+    // move out, setup builds it from the compacted matrix instead
+    if (!prob->borrows_constraint_matrix_t)
+    {
+        free(prob->constraint_matrix_t_row_pointers);
+        free(prob->constraint_matrix_t_col_indices);
+        free(prob->constraint_matrix_t_values);
+    }
+    prob->constraint_matrix_t_row_pointers = NULL;
+    prob->constraint_matrix_t_col_indices = NULL;
+    prob->constraint_matrix_t_values = NULL;
+    prob->borrows_constraint_matrix_t = false;
+
+    if (split->num_rows > 0)
+        split->row_vals = safe_calloc((size_t)split->num_rows * n, sizeof(double));
+    if (split->num_cols > 0)
+        split->col_vals = safe_calloc((size_t)split->num_cols * m, sizeof(double));
+
+    // entries shared by a dense row and a dense column belong to the row
+    int kept = 0;
+    for (int i = 0; i < m; ++i)
+    {
+        int begin = row_ptr[i];
+        int end = row_ptr[i + 1];
+        row_ptr[i] = kept;
+        for (int k = begin; k < end; ++k)
+        {
+            int j = col_ind[k];
+            if (row_slot[i])
+            {
+                split->row_vals[(size_t)(row_slot[i] - 1) * n + j] += val[k];
+            }
+            else if (col_slot[j])
+            {
+                split->col_vals[(size_t)(col_slot[j] - 1) * m + i] += val[k];
+            }
+            else
+            {
+                col_ind[kept] = j;
+                val[kept] = val[k];
+                kept++;
+            }
+        }
+    }
+    row_ptr[m] = kept;
+    prob->constraint_matrix_num_nonzeros = kept;
+
+    free(row_slot);
+    free(col_slot);
+}
+
+void dense_split_free(dense_split_t *split)
+{
+    free(split->row_index);
+    free(split->row_vals);
+    free(split->col_index);
+    free(split->col_vals);
+    memset(split, 0, sizeof(*split));
+}
+
+#define CODED_MAX_VALUES 256
+#define CODED_VALUE_RTOL 1e-12
+
+// index of the table entry matching v within rounding, or -1; values is
+// sorted and *pos receives the insertion point
+static int find_coded_value(const double *values, int num_values, double v,
+                            int *pos)
+{
+    int lo = 0;
+    int hi = num_values;
+    while (lo < hi)
+    {
+        int mid = (lo + hi) / 2;
+        if (values[mid] < v)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    *pos = lo;
+    for (int k = lo - 1; k <= lo; ++k)
+    {
+        if (k >= 0 && k < num_values &&
+            fabs(values[k] - v) <= CODED_VALUE_RTOL * fabs(values[k]))
+            return k;
+    }
+    return -1;
+}
+
+bool encode_coefficients(const lp_problem_t *prob, const double *con_rescale,
+                         const double *var_rescale, coefficient_codes_t *codes)
+{
+    memset(codes, 0, sizeof(*codes));
+    int m = prob->num_constraints;
+    int nnz = prob->constraint_matrix_num_nonzeros;
+    const int *row_ptr = prob->constraint_matrix_row_pointers;
+    const int *col_ind = prob->constraint_matrix_col_indices;
+    const double *val = prob->constraint_matrix_values;
+    if (nnz == 0)
+        return false;
+
+    // the scaled values are a_ij / (r_i c_j), so undoing the diagonals gives
+    // back the user coefficients up to rounding
+    double *values = safe_malloc(CODED_MAX_VALUES * sizeof(double));
+    int num_values = 0;
+    for (int i = 0; i < m; ++i)
+    {
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+        {
+            double v = val[k] * con_rescale[i] * var_rescale[col_ind[k]];
+            int pos;
+            if (find_coded_value(values, num_values, v, &pos) >= 0)
+                continue;
+            if (num_values == CODED_MAX_VALUES)
+            {
+                free(values);
+                return false;
+            }
+            memmove(values + pos + 1, values + pos,
+                    (num_values - pos) * sizeof(double));
+            values[pos] = v;
+            num_values++;
+        }
+    }
+
+    codes->codes = safe_malloc(nnz * sizeof(unsigned char));
+    for (int i = 0; i < m; ++i)
+    {
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+        {
+            double v = val[k] * con_rescale[i] * var_rescale[col_ind[k]];
+            int pos;
+            codes->codes[k] =
+                (unsigned char)find_coded_value(values, num_values, v, &pos);
+        }
+    }
+    codes->num_values = num_values;
+    codes->values = values;
+    return true;
+}
+
+void coefficient_codes_free(coefficient_codes_t *codes)
+{
+    free(codes->values);
+    free(codes->codes);
+    memset(codes, 0, sizeof(*codes));
+}
+
+// rows longer than this many times the mean make the row-per-lanes kernel
+// wait on a few threads
+#define SKEWED_ROW_RATIO 32
+
+bool csr_rows_skewed(const int *row_ptr, int num_rows)
+{
+    if (num_rows == 0)
+        return false;
+    int longest = 0;
+    for (int i = 0; i < num_rows; ++i)
+    {
+        int len = row_ptr[i + 1] - row_ptr[i];
+        if (len > longest)
+            longest = len;
+    }
+    long long mean = row_ptr[num_rows] / num_rows + 1;
+    return longest > SKEWED_ROW_RATIO * mean;
+}
+
+int merge_path_num_partitions(int num_rows, int nnz, int items_per_partition)
+{
+    long long items = (long long)num_rows + nnz;
+    return (int)((items + items_per_partition - 1) / items_per_partition);
+}
+
+// the path walks the row ends and the nonzeros in merged order; partition p
+// starts on diagonal p * items_per_partition, found by binary search for
+// the first row whose end lies past the diagonal
+void merge_path_partitions(const int *row_ptr, int num_rows,
+                           int items_per_partition, int num_partitions,
+                           int *start_row, int *start_nz)
+{
+    long long nnz = row_ptr[num_rows];
+    long long items = num_rows + nnz;
+    for (int p = 0; p <= num_partitions; ++p)
+    {
+        long long diagonal = (long long)p * items_per_partition;
+        if (diagonal > items)
+            diagonal = items;
+        long long lo = diagonal - nnz > 0 ? diagonal - nnz : 0;
+        long long hi = diagonal < num_rows ? diagonal : num_rows;
+        while (lo < hi)
+        {
+            long long mid = (lo + hi) / 2;
+            if (row_ptr[mid + 1] <= diagonal - mid - 1)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        start_row[p] = (int)lo;
+        start_nz[p] = (int)(diagonal - lo);
+    }
+}
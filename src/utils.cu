@@ -16,15 +16,21 @@ limitations under the License.
 
 #include "utils.h"
 #include <math.h>
+#include <algorithm>
+#include <limits.h>
 #include <random>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <ctype.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #ifndef CUPDLPX_VERSION
 #define CUPDLPX_VERSION "unknown"
 #endif
 
-std::mt19937 gen(1);
-std::normal_distribution<double> dist(0.0, 1.0);
-
 const double HOST_ONE = 1.0;
 const double HOST_ZERO = 0.0;
 
@@ -66,20 +72,423 @@ void *safe_realloc(void *ptr, size_t new_size)
     return tmp;
 }
 
-double estimate_maximum_singular_value(cusparseHandle_t sparse_handle,
-                                       cublasHandle_t blas_handle,
-                                       const cu_sparse_matrix_csr_t *A,
-                                       const cu_sparse_matrix_csr_t *AT,
+// out[target[b]] = <mat[b, :], v>, one block per dense vector
+__global__ void dense_vector_dot_kernel(const double *__restrict__ mat,
+                                        int len,
+                                        const double *__restrict__ v,
+                                        const int *__restrict__ target,
+                                        double *__restrict__ out)
+{
+    __shared__ double partial[THREADS_PER_BLOCK];
+    const double *row = mat + (size_t)blockIdx.x * len;
+    double sum = 0.0;
+    for (int i = threadIdx.x; i < len; i += blockDim.x)
+        sum += row[i] * v[i];
+    partial[threadIdx.x] = sum;
+    __syncthreads();
+    for (int stride = blockDim.x / 2; stride > 0; stride >>= 1)
+    {
+        if (threadIdx.x < stride)
+            partial[threadIdx.x] += partial[threadIdx.x + stride];
+        __syncthreads();
+    }
+    if (threadIdx.x == 0)
+        out[target[blockIdx.x]] = partial[0];
+}
+
+// out[i] += sum_k mat[k, i] * v[source[k]], one thread per output
+__global__ void dense_vector_gemv_kernel(const double *__restrict__ mat,
+                                         int len, int count,
+                                         const double *__restrict__ v,
+                                         const int *__restrict__ source,
+                                         double *__restrict__ out)
+{
+    int i = blockIdx.x * blockDim.x + threadIdx.x;
+    if (i < len)
+    {
+        double sum = 0.0;
+        for (int k = 0; k < count; ++k)
+            sum += mat[(size_t)k * len + i] * v[source[k]];
+        out[i] += sum;
+    }
+}
+
+// out[i] = x[i] / scale[i]
+__global__ void divide_by_rescaling_kernel(const double *__restrict__ x,
+                                           const double *__restrict__ scale,
+                                           int n, double *__restrict__ out)
+{
+    int i = blockIdx.x * blockDim.x + threadIdx.x;
+    if (i < n)
+        out[i] = x[i] / scale[i];
+}
+
+// out[i] = sum_k values[codes[k]] * x_scaled[col_ind[k]] / out_rescaling[i],
+// with lanes (a power of two, at most a warp) threads sharing one row
+__global__ void coded_csr_spmv_kernel(int num_rows,
+                                      const int *__restrict__ row_ptr,
+                                      const int *__restrict__ col_ind,
+                                      const unsigned char *__restrict__ codes,
+                                      const double *__restrict__ values,
+                                      int num_values, int lanes,
+                                      const double *__restrict__ x_scaled,
+                                      const double *__restrict__ out_rescaling,
+                                      double *__restrict__ out)
+{
+    __shared__ double table[256];
+    for (int k = threadIdx.x; k < num_values; k += blockDim.x)
+        table[k] = values[k];
+    __syncthreads();
+
+    int thread = blockIdx.x * blockDim.x + threadIdx.x;
+    int row = thread / lanes;
+    int lane = thread & (lanes - 1);
+    double sum = 0.0;
+    if (row < num_rows)
+    {
+        for (int k = row_ptr[row] + lane; k < row_ptr[row + 1]; k += lanes)
+            sum += table[codes[k]] * x_scaled[col_ind[k]];
+    }
+    // every thread of the warp takes part in the shuffles
+    for (int offset = lanes / 2; offset > 0; offset >>= 1)
+        sum += __shfl_down_sync(0xffffffff, sum, offset, lanes);
+    if (row < num_rows && lane == 0)
+        out[row] = sum / out_rescaling[row];
+}
+
+// one thread per merge-path partition: rows that end inside it are written
+// directly, except a first row begun by earlier partitions, whose unscaled
+// part is left in out for the fix-up; the part of the last row that is cut
+// off goes to carry
+__global__ void coded_merge_path_spmv_kernel(
+    int num_partitions, const int *__restrict__ start_row,
+    const int *__restrict__ start_nz, const int *__restrict__ row_ptr,
+    const int *__restrict__ col_ind, const unsigned char *__restrict__ codes,
+    const double *__restrict__ values, int num_values,
+    const double *__restrict__ x_scaled,
+    const double *__restrict__ out_rescaling, double *__restrict__ out,
+    double *__restrict__ carry)
+{
+    __shared__ double table[256];
+    for (int k = threadIdx.x; k < num_values; k += blockDim.x)
+        table[k] = values[k];
+    __syncthreads();
+
+    int p = blockIdx.x * blockDim.x + threadIdx.x;
+    if (p >= num_partitions)
+        return;
+    int row = start_row[p];
+    int end_row = start_row[p + 1];
+    int k = start_nz[p];
+    int end_k = start_nz[p + 1];
+    bool continued = k > row_ptr[row];
+    double sum = 0.0;
+    for (; row < end_row; ++row)
+    {
+        for (int row_end = row_ptr[row + 1]; k < row_end; ++k)
+            sum += table[codes[k]] * x_scaled[col_ind[k]];
+        out[row] = continued ? sum : sum / out_rescaling[row];
+        continued = false;
+        sum = 0.0;
+    }
+    for (; k < end_k; ++k)
+        sum += table[codes[k]] * x_scaled[col_ind[k]];
+    carry[p] = sum;
+}
+
+// completes every row that spans partitions: the carries of the partitions
+// before the one that ends the row are added in order, so the result does
+// not depend on scheduling
+__global__ void merge_path_fixup_kernel(int num_partitions,
+                                        const int *__restrict__ start_row,
+                                        const int *__restrict__ start_nz,
+                                        const int *__restrict__ row_ptr,
+                                        const double *__restrict__ carry,
+                                        const double *__restrict__ out_rescaling,
+                                        double *__restrict__ out)
+{
+    int q = blockIdx.x * blockDim.x + threadIdx.x;
+    if (q >= num_partitions)
+        return;
+    int row = start_row[q];
+    if (start_nz[q] == row_ptr[row] || start_row[q + 1] == row)
+        return;
+    int first = q - 1;
+    while (first > 0 && start_row[first] == row)
+        --first;
+    double sum = 0.0;
+    for (int p = first; p < q; ++p)
+        sum += carry[p];
+    out[row] = (sum + out[row]) / out_rescaling[row];
+}
+
+// the scaled matrix is D_out^-1 A D_in^-1, so the input is divided by its
+// scaling once and the coded kernel never loads a value array
+static void coded_spmv(pdhg_solver_state_t *state,
+                       const cu_sparse_matrix_csr_t *mat,
+                       const unsigned char *codes, int lanes,
+                       const merge_path_t *path,
+                       const double *in_rescaling,
+                       const double *out_rescaling, const double *x,
+                       double *out)
+{
+    int in_blocks = (mat->num_cols + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+    if (in_blocks > 0)
+    {
+        divide_by_rescaling_kernel<<<in_blocks, THREADS_PER_BLOCK, 0,
+                                     state->stream>>>(
+            x, in_rescaling, mat->num_cols, state->coded_spmv_input);
+    }
+    if (path->num_partitions > 0)
+    {
+        double *carry = state->coded_spmv_input +
+                        (state->num_variables > state->num_constraints
+                             ? state->num_variables
+                             : state->num_constraints);
+        int blocks = (path->num_partitions + THREADS_PER_BLOCK - 1) /
+                     THREADS_PER_BLOCK;
+        coded_merge_path_spmv_kernel<<<blocks, THREADS_PER_BLOCK, 0,
+                                       state->stream>>>(
+            path->num_partitions, path->start_row, path->start_nz,
+            mat->row_ptr, mat->col_ind, codes, state->coefficient_values,
+            state->num_coefficient_values, state->coded_spmv_input,
+            out_rescaling, out, carry);
+        merge_path_fixup_kernel<<<blocks, THREADS_PER_BLOCK, 0,
+                                  state->stream>>>(
+            path->num_partitions, path->start_row, path->start_nz,
+            mat->row_ptr, carry, out_rescaling, out);
+        return;
+    }
+    long long threads = (long long)mat->num_rows * lanes;
+    int out_blocks = (int)((threads + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK);
+    if (out_blocks > 0)
+    {
+        coded_csr_spmv_kernel<<<out_blocks, THREADS_PER_BLOCK, 0,
+                                state->stream>>>(
+            mat->num_rows, mat->row_ptr, mat->col_ind, codes,
+            state->coefficient_values, state->num_coefficient_values, lanes,
+            state->coded_spmv_input, out_rescaling, out);
+    }
+}
+
+// one warp per slice of A, into the slice's own window: the rows go one
+// after another and the lanes split a row, whose columns are distinct, so no
+// two lanes ever add to the same entry at once and no atomics are needed.
+// The part of a row outside the slice belongs to the neighbouring slice. A
+// coded matrix holds the unscaled values, so the rows are divided by
+// row_rescaling here and the columns when the windows are summed
+template <bool CODED>
+__global__ void dual_scatter_kernel(
+    int num_slices, const int *__restrict__ start_row,
+    const int *__restrict__ start_nz, const int *__restrict__ col_begin,
+    const int *__restrict__ window_offset, const int *__restrict__ row_ptr,
+    const int *__restrict__ col_ind, const double *__restrict__ val,
+    const unsigned char *__restrict__ codes,
+    const double *__restrict__ values, int num_values,
+    const double *__restrict__ row_rescaling, const double *__restrict__ y,
+    double *__restrict__ partials)
+{
+    __shared__ double table[256];
+    if (CODED)
+    {
+        for (int k = threadIdx.x; k < num_values; k += blockDim.x)
+            table[k] = values[k];
+        __syncthreads();
+    }
+
+    int slice = (blockIdx.x * blockDim.x + threadIdx.x) / 32;
+    int lane = threadIdx.x % 32;
+    if (slice >= num_slices)
+        return;
+    int first_col = col_begin[slice];
+    double *window = partials + window_offset[slice];
+    int width = window_offset[slice + 1] - window_offset[slice];
+    for (int j = lane; j < width; j += 32)
+        window[j] = 0.0;
+    __syncwarp();
+
+    int row = start_row[slice];
+    int k = start_nz[slice];
+    int end_k = start_nz[slice + 1];
+    while (k < end_k)
+    {
+        while (row_ptr[row + 1] <= k)
+            ++row;
+        int row_end = min(row_ptr[row + 1], end_k);
+        double y_row = CODED ? y[row] / row_rescaling[row] : y[row];
+        for (int q = k + lane; q < row_end; q += 32)
+        {
+            double a = CODED ? table[codes[q]] : val[q];
+            window[col_ind[q] - first_col] += a * y_row;
+        }
+        __syncwarp();
+        k = row_end;
+    }
+}
+
+// each column adds up its window entries in slice order, so the result does
+// not depend on scheduling
+template <bool CODED>
+__global__ void dual_scatter_reduce_kernel(
+    int num_cols, const int *__restrict__ column_ptr,
+    const int *__restrict__ column_windows,
+    const double *__restrict__ partials,
+    const double *__restrict__ col_rescaling, double *__restrict__ out)
+{
+    int j = blockIdx.x * blockDim.x + threadIdx.x;
+    if (j >= num_cols)
+        return;
+    double sum = 0.0;
+    for (int t = column_ptr[j]; t < column_ptr[j + 1]; ++t)
+        sum += partials[column_windows[t]];
+    out[j] = CODED ? sum / col_rescaling[j] : sum;
+}
+
+// out = A^T y from the rows of A when no transpose is stored
+static void dual_scatter(pdhg_solver_state_t *state, const double *y,
+                         double *out)
+{
+    const dual_scatter_t *scatter = &state->dual_scatter;
+    const cu_sparse_matrix_csr_t *mat = state->constraint_matrix;
+    long long threads = (long long)scatter->slices.num_partitions * 32;
+    int blocks = (int)((threads + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK);
+    if (state->num_coefficient_values > 0)
+    {
+        dual_scatter_kernel<true><<<blocks, THREADS_PER_BLOCK, 0,
+                                    state->stream>>>(
+            scatter->slices.num_partitions, scatter->slices.start_row,
+            scatter->slices.start_nz, scatter->col_begin,
+            scatter->window_offset, mat->row_ptr, mat->col_ind, NULL,
+            state->constraint_matrix_codes, state->coefficient_values,
+            state->num_coefficient_values, state->constraint_rescaling, y,
+            scatter->partials);
+    }
+    else
+    {
+        dual_scatter_kernel<false><<<blocks, THREADS_PER_BLOCK, 0,
+                                     state->stream>>>(
+            scatter->slices.num_partitions, scatter->slices.start_row,
+            scatter->slices.start_nz, scatter->col_begin,
+            scatter->window_offset, mat->row_ptr, mat->col_ind, mat->val,
+            NULL, NULL, 0, NULL, y, scatter->partials);
+    }
+    if (state->num_blocks_primal == 0)
+        return;
+    if (state->num_coefficient_values > 0)
+    {
+        dual_scatter_reduce_kernel<true><<<state->num_blocks_primal,
+                                           THREADS_PER_BLOCK, 0,
+                                           state->stream>>>(
+            state->num_variables, scatter->column_ptr, scatter->column_windows,
+            scatter->partials, state->variable_rescaling, out);
+    }
+    else
+    {
+        dual_scatter_reduce_kernel<false><<<state->num_blocks_primal,
+                                            THREADS_PER_BLOCK, 0,
+                                            state->stream>>>(
+            state->num_variables, scatter->column_ptr, scatter->column_windows,
+            scatter->partials, NULL, out);
+    }
+}
+
+// out = A x: the SpMV covers the sparse remainder, dense rows are written by
+// the dot kernel and dense columns are added by the gemv kernel
+void compute_primal_product(pdhg_solver_state_t *state, const double *x,
+                            double *out)
+{
+    if (state->num_coefficient_values > 0)
+    {
+        coded_spmv(state, state->constraint_matrix,
+                   state->constraint_matrix_codes, state->coded_row_lanes,
+                   &state->row_merge_path,
+                   state->variable_rescaling, state->constraint_rescaling, x,
+                   out);
+    }
+    else
+    {
+        CUSPARSE_CHECK(cusparseDnVecSetValues(state->vec_primal_sol, (void *)x));
+        CUSPARSE_CHECK(cusparseDnVecSetValues(state->vec_primal_prod, out));
+        CUSPARSE_CHECK(cusparseSpMV(
+            state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
+            state->matA, state->vec_primal_sol, &HOST_ZERO,
+            state->vec_primal_prod, CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2,
+            state->primal_spmv_buffer));
+    }
+
+    if (state->num_dense_rows > 0)
+    {
+        dense_vector_dot_kernel<<<state->num_dense_rows, THREADS_PER_BLOCK, 0,
+                                  state->stream>>>(
+            state->dense_rows, state->num_variables, x, state->dense_row_index,
+            out);
+    }
+    if (state->num_dense_cols > 0)
+    {
+        dense_vector_gemv_kernel<<<state->num_blocks_dual, THREADS_PER_BLOCK, 0,
+                                   state->stream>>>(
+            state->dense_cols, state->num_constraints, state->num_dense_cols, x,
+            state->dense_col_index, out);
+    }
+}
+
+// out = A^T y, the mirror image of compute_primal_product
+void compute_dual_product(pdhg_solver_state_t *state, const double *y,
+                          double *out)
+{
+    if (state->dual_scatter.slices.num_partitions > 0)
+    {
+        dual_scatter(state, y, out);
+    }
+    else if (state->num_coefficient_values > 0)
+    {
+        coded_spmv(state, state->constraint_matrix_t,
+                   state->constraint_matrix_t_codes, state->coded_col_lanes,
+                   &state->col_merge_path,
+                   state->constraint_rescaling, state->variable_rescaling, y,
+                   out);
+    }
+    else
+    {
+        CUSPARSE_CHECK(cusparseDnVecSetValues(state->vec_dual_sol, (void *)y));
+        CUSPARSE_CHECK(cusparseDnVecSetValues(state->vec_dual_prod, out));
+        CUSPARSE_CHECK(cusparseSpMV(
+            state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
+            state->matAt, state->vec_dual_sol, &HOST_ZERO, state->vec_dual_prod,
+            CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->dual_spmv_buffer));
+    }
+
+    if (state->num_dense_cols > 0)
+    {
+        dense_vector_dot_kernel<<<state->num_dense_cols, THREADS_PER_BLOCK, 0,
+                                  state->stream>>>(
+            state->dense_cols, state->num_constraints, y,
+            state->dense_col_index, out);
+    }
+    if (state->num_dense_rows > 0)
+    {
+        dense_vector_gemv_kernel<<<state->num_blocks_primal, THREADS_PER_BLOCK, 0,
+                                   state->stream>>>(
+            state->dense_rows, state->num_variables, state->num_dense_rows, y,
+            state->dense_row_index, out);
+    }
+}
+
+double estimate_maximum_singular_value(pdhg_solver_state_t *state,
                                        int max_iterations, double tolerance)
 {
-    int m = A->num_rows;
-    int n = A->num_cols;
+    cublasHandle_t blas_handle = state->blas_handle;
+    int m = state->num_constraints;
+    int n = state->num_variables;
     double *eigenvector_d, *next_eigenvector_d, *dual_product_d;
 
     CUDA_CHECK(cudaMalloc(&eigenvector_d, m * sizeof(double)));
     CUDA_CHECK(cudaMalloc(&next_eigenvector_d, m * sizeof(double)));
     CUDA_CHECK(cudaMalloc(&dual_product_d, n * sizeof(double)));
 
+    // seeded per call so repeated solves start from the same vector
+    std::mt19937 gen(1);
+    std::normal_distribution<double> dist(0.0, 1.0);
     double *eigenvector_h = (double *)safe_malloc(m * sizeof(double));
     for (int i = 0; i < m; ++i)
     {
@@ -92,61 +501,22 @@ double estimate_maximum_singular_value(cusparseHandle_t sparse_handle,
 
     double sigma_max_sq = 1.0;
     const double one = 1.0;
-    const double zero = 0.0;
-
-    cusparseSpMatDescr_t matA, matAT;
-    CUSPARSE_CHECK(cusparseCreateCsr(
-        &matA, A->num_rows, A->num_cols, A->num_nonzeros, A->row_ptr, A->col_ind,
-        A->val, CUSPARSE_INDEX_32I, CUSPARSE_INDEX_32I, CUSPARSE_INDEX_BASE_ZERO,
-        CUDA_R_64F));
-    CUSPARSE_CHECK(cusparseCreateCsr(
-        &matAT, AT->num_rows, AT->num_cols, AT->num_nonzeros, AT->row_ptr,
-        AT->col_ind, AT->val, CUSPARSE_INDEX_32I, CUSPARSE_INDEX_32I,
-        CUSPARSE_INDEX_BASE_ZERO, CUDA_R_64F));
-
-    cusparseDnVecDescr_t vecEigen, vecNextEigen, vecDual;
-    CUSPARSE_CHECK(cusparseCreateDnVec(&vecEigen, m, eigenvector_d, CUDA_R_64F));
-    CUSPARSE_CHECK(
-        cusparseCreateDnVec(&vecNextEigen, m, next_eigenvector_d, CUDA_R_64F));
-    CUSPARSE_CHECK(cusparseCreateDnVec(&vecDual, n, dual_product_d, CUDA_R_64F));
-
-    void *dBufferAT = NULL;
-    void *dBufferA = NULL;
-    size_t bufferSizeAT = 0, bufferSizeA = 0;
-    CUSPARSE_CHECK(cusparseSpMV_bufferSize(
-        sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &one, matAT,
-        vecNextEigen, &zero, vecDual, CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2,
-        &bufferSizeAT));
-    CUSPARSE_CHECK(cusparseSpMV_bufferSize(
-        sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &one, matA, vecDual,
-        &zero, vecEigen, CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, &bufferSizeA));
-
-    CUDA_CHECK(cudaMalloc(&dBufferAT, bufferSizeAT));
-    CUDA_CHECK(cudaMalloc(&dBufferA, bufferSizeA));
 
     for (int i = 0; i < max_iterations; ++i)
     {
 
         CUDA_CHECK(cudaMemcpy(next_eigenvector_d, eigenvector_d, m * sizeof(double),
                               cudaMemcpyDeviceToDevice));
-        double eigenvector_norm;
-        CUBLAS_CHECK(cublasDnrm2_v2_64(blas_handle, m, next_eigenvector_d, 1,
-                                       &eigenvector_norm));
+        double eigenvector_norm = get_vector_norm(state, m, next_eigenvector_d);
 
         double inv_eigenvector_norm = 1.0 / eigenvector_norm;
         CUBLAS_CHECK(cublasDscal(blas_handle, m, &inv_eigenvector_norm,
                                  next_eigenvector_d, 1));
 
-        CUSPARSE_CHECK(cusparseSpMV(sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE,
-                                    &one, matAT, vecNextEigen, &zero, vecDual,
-                                    CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, dBufferAT));
-
-        CUSPARSE_CHECK(cusparseSpMV(sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE,
-                                    &one, matA, vecDual, &zero, vecEigen,
-                                    CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, dBufferA));
+        compute_dual_product(state, next_eigenvector_d, dual_product_d);
+        compute_primal_product(state, dual_product_d, eigenvector_d);
 
-        CUBLAS_CHECK(cublasDdot(blas_handle, m, next_eigenvector_d, 1,
-                                eigenvector_d, 1, &sigma_max_sq));
+        sigma_max_sq = get_vector_dot(state, m, next_eigenvector_d, eigenvector_d);
 
         double neg_sigma_sq = -sigma_max_sq;
         CUBLAS_CHECK(
@@ -154,21 +524,12 @@ double estimate_maximum_singular_value(cusparseHandle_t sparse_handle,
         CUBLAS_CHECK(cublasDaxpy(blas_handle, m, &one, eigenvector_d, 1,
                                  next_eigenvector_d, 1));
 
-        double residual_norm;
-        CUBLAS_CHECK(cublasDnrm2_v2_64(blas_handle, m, next_eigenvector_d, 1,
-                                       &residual_norm));
+        double residual_norm = get_vector_norm(state, m, next_eigenvector_d);
 
         if (residual_norm < tolerance)
             break;
     }
 
-    CUDA_CHECK(cudaFree(dBufferAT));
-    CUDA_CHECK(cudaFree(dBufferA));
-    CUSPARSE_CHECK(cusparseDestroySpMat(matA));
-    CUSPARSE_CHECK(cusparseDestroySpMat(matAT));
-    CUSPARSE_CHECK(cusparseDestroyDnVec(vecEigen));
-    CUSPARSE_CHECK(cusparseDestroyDnVec(vecNextEigen));
-    CUSPARSE_CHECK(cusparseDestroyDnVec(vecDual));
     CUDA_CHECK(cudaFree(eigenvector_d));
     CUDA_CHECK(cudaFree(next_eigenvector_d));
     CUDA_CHECK(cudaFree(dual_product_d));
@@ -179,19 +540,10 @@ double estimate_maximum_singular_value(cusparseHandle_t sparse_handle,
 void compute_interaction_and_movement(pdhg_solver_state_t *state,
                                       double *interaction, double *movement)
 {
-    double dual_norm, primal_norm, cross_term;
-
-    CUBLAS_CHECK(cublasDnrm2_v2_64(state->blas_handle, state->num_constraints,
-                                   state->delta_dual_solution, 1, &dual_norm));
-    CUBLAS_CHECK(cublasDnrm2_v2_64(state->blas_handle, state->num_variables,
-                                   state->delta_primal_solution, 1,
-                                   &primal_norm));
-    *movement = 0.5 * (primal_norm * primal_norm * state->primal_weight +
-                       dual_norm * dual_norm / state->primal_weight);
-
-    CUBLAS_CHECK(cublasDdot(state->blas_handle, state->num_variables,
-                            state->dual_product, 1, state->delta_primal_solution,
-                            1, &cross_term));
+    double primal_sq, dual_sq, cross_term;
+    get_movement_sums(state, &primal_sq, &dual_sq, &cross_term);
+    *movement = 0.5 * (primal_sq * state->primal_weight +
+                       dual_sq / state->primal_weight);
     *interaction = fabs(cross_term);
 }
 
@@ -213,6 +565,8 @@ const char *termination_reason_to_string(termination_reason_t reason)
         return "UNSPECIFIED";
     case TERMINATION_REASON_FEAS_POLISH_SUCCESS:
         return "FEAS_POLISH_SUCCESS";
+    case TERMINATION_REASON_USER_INTERRUPT:
+        return "USER_INTERRUPT";
     default:
         return "UNKNOWN";
     }
@@ -331,6 +685,14 @@ void set_default_parameters(pdhg_parameters_t *params)
     params->termination_evaluation_frequency = 200;
     params->feasibility_polishing = false;
     params->reflection_coefficient = 1.0;
+    params->cuda_graph = false;
+    params->persistent_iterations = false;
+    params->transpose_free = false;
+    params->setup_cache_dir = NULL;
+    params->solution_store_size = 0;
+    params->numa_affinity = false;
+    params->iteration_callback = NULL;
+    params->callback_user_data = NULL;
 
     params->sv_max_iter = 5000;
     params->sv_tol = 1e-4;
@@ -373,7 +735,9 @@ void set_default_parameters(pdhg_parameters_t *params)
     } while(0)
 
 void print_initial_info(const pdhg_parameters_t *params,
-                        const lp_problem_t *problem)
+                        const lp_problem_t *problem,
+                        const rescale_info_t *rescale_info,
+                        const pdhg_solver_state_t *state)
 {
     pdhg_parameters_t default_params;
     set_default_parameters(&default_params);
@@ -398,6 +762,39 @@ void print_initial_info(const pdhg_parameters_t *params,
     printf("  constraints   : %d\n", problem->num_constraints);
     printf("  nonzeros(A)   : %d\n", problem->constraint_matrix_num_nonzeros);
 
+    printf("structure:\n");
+    printf("  blocks        : %d\n", rescale_info->num_blocks);
+    printf("  linking rows  : %d\n", rescale_info->num_linking_rows);
+    printf("  linking cols  : %d\n", rescale_info->num_linking_cols);
+    if (rescale_info->dense.num_rows > 0 || rescale_info->dense.num_cols > 0)
+    {
+        printf("  dense rows    : %d\n", rescale_info->dense.num_rows);
+        printf("  dense cols    : %d\n", rescale_info->dense.num_cols);
+    }
+    if (rescale_info->codes.num_values > 0)
+        printf("  coefficients  : %d distinct, coded\n",
+               rescale_info->codes.num_values);
+
+    // the lean layout drops the ones vectors, the finite bound copies and
+    // the residual vectors that the fused reductions no longer need
+    size_t saved_bytes = 4 * (size_t)(problem->num_variables +
+                                      problem->num_constraints) *
+                         sizeof(double);
+    printf("memory:\n");
+    printf("  device        : %.1f MB\n", state->device_memory_bytes / 1048576.0);
+    printf("  vector pool   : %.1f MB\n", state->vector_pool_bytes / 1048576.0);
+    if (state->dual_scatter.slices.num_partitions > 0)
+        printf("  transpose     : none, A^T y from %d row slices, "
+               "%.1f MB of windows\n",
+               state->dual_scatter.slices.num_partitions,
+               state->dual_scatter.num_window_entries *
+                   (sizeof(double) + sizeof(int)) / 1048576.0);
+    else if (rescale_info->scaled_problem->constraint_matrix_t_row_pointers)
+        printf("  transpose     : from the CSC input\n");
+    else
+        printf("  transpose     : built on the device\n");
+    printf("  saved (lean)  : %.1f MB\n", saved_bytes / 1048576.0);
+
     printf("settings:\n");
     printf("  iter_limit         : %d\n",
            params->termination_criteria.iteration_limit);
@@ -439,6 +836,23 @@ void print_initial_info(const pdhg_parameters_t *params,
     PRINT_DIFF_DBL("eps_feas_polish_relative",
                    params->termination_criteria.eps_feas_polish_relative,
                    default_params.termination_criteria.eps_feas_polish_relative);
+    PRINT_DIFF_BOOL("cuda_graph",
+                    params->cuda_graph,
+                    default_params.cuda_graph);
+    PRINT_DIFF_BOOL("persistent_iter",
+                    params->persistent_iterations,
+                    default_params.persistent_iterations);
+    PRINT_DIFF_BOOL("transpose_free",
+                    params->transpose_free,
+                    default_params.transpose_free);
+    PRINT_DIFF_BOOL("numa_affinity",
+                    params->numa_affinity,
+                    default_params.numa_affinity);
+    PRINT_DIFF_INT("solution_store_size",
+                   params->solution_store_size,
+                   default_params.solution_store_size);
+    if (params->setup_cache_dir != NULL)
+        printf("  %-18s : %s\n", "setup_cache_dir", params->setup_cache_dir);
 
     printf("---------------------------------------------------------------------"
            "------------------\n");
@@ -490,51 +904,139 @@ void display_iteration_stats(const pdhg_solver_state_t *state, bool verbose)
     }
 }
 
-int get_print_frequency(int iter)
+// infinite bounds do not contribute to the dual objective
+__device__ __forceinline__ double finite_or_zero(double bound)
 {
-    int step = 10;
-    long long threshold = 1000;
+    return isfinite(bound) ? bound : 0.0;
+}
 
-    while (iter >= threshold)
+// sums each of the K values over the block and stores them in the partial
+// slots of this block, partial[k * REDUCTION_MAX_BLOCKS + blockIdx.x]
+template <int K>
+__device__ void block_sum_to_partials(double (&value)[K], double *partial)
+{
+    __shared__ double warp_sums[K][THREADS_PER_BLOCK / 32];
+    int lane = threadIdx.x & 31;
+    int warp = threadIdx.x >> 5;
+    for (int k = 0; k < K; ++k)
     {
-        step *= 10;
-        threshold *= 10;
+        for (int offset = 16; offset > 0; offset >>= 1)
+            value[k] += __shfl_down_sync(0xffffffff, value[k], offset);
+        if (lane == 0)
+            warp_sums[k][warp] = value[k];
+    }
+    __syncthreads();
+    if (warp == 0)
+    {
+        for (int k = 0; k < K; ++k)
+        {
+            double v = (lane < THREADS_PER_BLOCK / 32) ? warp_sums[k][lane] : 0.0;
+            for (int offset = 16; offset > 0; offset >>= 1)
+                v += __shfl_down_sync(0xffffffff, v, offset);
+            if (lane == 0)
+                partial[k * REDUCTION_MAX_BLOCKS + blockIdx.x] = v;
+        }
     }
-    return step;
 }
 
-__global__ void compute_residual_kernel(
-    double *primal_residual, const double *primal_product,
-    const double *constraint_lower_bound, const double *constraint_upper_bound,
-    const double *dual_solution, double *dual_residual,
-    const double *dual_product, const double *dual_slack,
-    const double *objective_vector, const double *constraint_rescaling,
-    const double *variable_rescaling, double *dual_obj_contribution,
-    const double *const_lb_finite, const double *const_ub_finite,
-    int num_constraints, int num_variables)
+// out[k] = sum of the num_partials partials of output k, one block per output;
+// together with the fixed grid of reduction_blocks the summation order only
+// depends on the vector length, never on the device or on timing
+__global__ void reduce_partials_kernel(const double *__restrict__ partial,
+                                       int num_partials,
+                                       double *__restrict__ out)
 {
-    int i = blockIdx.x * blockDim.x + threadIdx.x;
-
-    if (i < num_constraints)
+    __shared__ double cache[THREADS_PER_BLOCK];
+    const double *row = partial + blockIdx.x * REDUCTION_MAX_BLOCKS;
+    double sum = 0.0;
+    for (int i = threadIdx.x; i < num_partials; i += blockDim.x)
+        sum += row[i];
+    cache[threadIdx.x] = sum;
+    __syncthreads();
+    for (int stride = blockDim.x / 2; stride > 0; stride >>= 1)
     {
+        if (threadIdx.x < stride)
+            cache[threadIdx.x] += cache[threadIdx.x + stride];
+        __syncthreads();
+    }
+    if (threadIdx.x == 0)
+        out[blockIdx.x] = cache[0];
+}
 
-        double clamped_val =
-            fmax(constraint_lower_bound[i],
-                 fmin(primal_product[i], constraint_upper_bound[i]));
-        primal_residual[i] =
-            (primal_product[i] - clamped_val) * constraint_rescaling[i];
+// grid size of a fused reduction over n entries
+static int reduction_blocks(long long n)
+{
+    long long blocks = (n + THREADS_PER_BLOCK - 1) / THREADS_PER_BLOCK;
+    if (blocks > REDUCTION_MAX_BLOCKS)
+        blocks = REDUCTION_MAX_BLOCKS;
+    return (blocks > 0) ? (int)blocks : 1;
+}
 
-        dual_obj_contribution[i] =
-            fmax(dual_solution[i], 0.0) * const_lb_finite[i] +
-            fmin(dual_solution[i], 0.0) * const_ub_finite[i];
-    }
-    else if (i < num_constraints + num_variables)
+// folds the partials of a fused reduction kernel and copies the num_outputs
+// sums to the host with a single transfer
+static void finish_reduction(pdhg_solver_state_t *state, int num_blocks,
+                             int num_outputs, double *sums)
+{
+    double *result_d =
+        state->reduction_buffer + REDUCTION_MAX_OUTPUTS * REDUCTION_MAX_BLOCKS;
+    reduce_partials_kernel<<<num_outputs, THREADS_PER_BLOCK, 0,
+                             state->stream>>>(state->reduction_buffer,
+                                              num_blocks, result_d);
+    CUDA_CHECK(cudaMemcpyAsync(sums, result_d, num_outputs * sizeof(double),
+                               cudaMemcpyDeviceToHost, state->stream));
+    CUDA_CHECK(cudaStreamSynchronize(state->stream));
+}
+
+enum
+{
+    RESIDUAL_PRIMAL_SQ,
+    RESIDUAL_DUAL_BOUND_TERM,
+    RESIDUAL_DUAL_SQ,
+    RESIDUAL_PRIMAL_OBJECTIVE,
+    RESIDUAL_DUAL_SLACK_TERM,
+    RESIDUAL_NUM_SUMS
+};
+
+// one pass over [constraints | variables] producing the squared residual
+// norms and the objective terms of compute_residual
+__global__ void compute_residual_kernel(
+    const double *primal_product, const double *constraint_lower_bound,
+    const double *constraint_upper_bound, const double *dual_solution,
+    const double *dual_product, const double *dual_slack,
+    const double *objective_vector, const double *primal_solution,
+    const double *constraint_rescaling, const double *variable_rescaling,
+    int num_constraints, int num_variables, double *partial)
+{
+    double sums[RESIDUAL_NUM_SUMS] = {0.0, 0.0, 0.0, 0.0, 0.0};
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x;
+         i < num_constraints + num_variables; i += gridDim.x * blockDim.x)
     {
-        int idx = i - num_constraints;
-        dual_residual[idx] =
-            (objective_vector[idx] - dual_product[idx] - dual_slack[idx]) *
-            variable_rescaling[idx];
+        if (i < num_constraints)
+        {
+            double clamped_val =
+                fmax(constraint_lower_bound[i],
+                     fmin(primal_product[i], constraint_upper_bound[i]));
+            double residual =
+                (primal_product[i] - clamped_val) * constraint_rescaling[i];
+            sums[RESIDUAL_PRIMAL_SQ] += residual * residual;
+            sums[RESIDUAL_DUAL_BOUND_TERM] +=
+                fmax(dual_solution[i], 0.0) * finite_or_zero(constraint_lower_bound[i]) +
+                fmin(dual_solution[i], 0.0) * finite_or_zero(constraint_upper_bound[i]);
+        }
+        else
+        {
+            int idx = i - num_constraints;
+            double residual =
+                (objective_vector[idx] - dual_product[idx] - dual_slack[idx]) *
+                variable_rescaling[idx];
+            sums[RESIDUAL_DUAL_SQ] += residual * residual;
+            sums[RESIDUAL_PRIMAL_OBJECTIVE] +=
+                objective_vector[idx] * primal_solution[idx];
+            sums[RESIDUAL_DUAL_SLACK_TERM] +=
+                dual_slack[idx] * primal_solution[idx];
+        }
     }
+    block_sum_to_partials<RESIDUAL_NUM_SUMS>(sums, partial);
 }
 
 __global__ void primal_infeasibility_project_kernel(
@@ -605,8 +1107,8 @@ compute_dual_infeasibility_kernel(const double *dual_product,
 }
 
 __global__ void dual_solution_dual_objective_contribution_kernel(
-    const double *constraint_lower_bound_finite_val,
-    const double *constraint_upper_bound_finite_val,
+    const double *constraint_lower_bound,
+    const double *constraint_upper_bound,
     const double *dual_solution, int num_constraints,
     double *dual_objective_dual_solution_contribution_array)
 {
@@ -615,25 +1117,109 @@ __global__ void dual_solution_dual_objective_contribution_kernel(
     if (i < num_constraints)
     {
         dual_objective_dual_solution_contribution_array[i] =
-            fmax(dual_solution[i], 0.0) * constraint_lower_bound_finite_val[i] +
-            fmin(dual_solution[i], 0.0) * constraint_upper_bound_finite_val[i];
+            fmax(dual_solution[i], 0.0) * finite_or_zero(constraint_lower_bound[i]) +
+            fmin(dual_solution[i], 0.0) * finite_or_zero(constraint_upper_bound[i]);
     }
 }
 
 __global__ void dual_objective_dual_slack_contribution_array_kernel(
     const double *dual_slack,
     double *dual_objective_dual_slack_contribution_array,
-    const double *variable_lower_bound_finite_val,
-    const double *variable_upper_bound_finite_val, int num_variables)
+    const double *variable_lower_bound,
+    const double *variable_upper_bound, int num_variables)
 {
     int i = blockIdx.x * blockDim.x + threadIdx.x;
 
     if (i < num_variables)
     {
         dual_objective_dual_slack_contribution_array[i] =
-            fmax(-dual_slack[i], 0.0) * variable_lower_bound_finite_val[i] +
-            fmin(-dual_slack[i], 0.0) * variable_upper_bound_finite_val[i];
+            fmax(-dual_slack[i], 0.0) * finite_or_zero(variable_lower_bound[i]) +
+            fmin(-dual_slack[i], 0.0) * finite_or_zero(variable_upper_bound[i]);
+    }
+}
+
+// partial[b] = sum of the grid-stride slice of block b
+__global__ void vector_sum_partial_kernel(const double *__restrict__ x, int n,
+                                          double *__restrict__ partial)
+{
+    double sum[1] = {0.0};
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+         i += gridDim.x * blockDim.x)
+        sum[0] += x[i];
+    block_sum_to_partials<1>(sum, partial);
+}
+
+// partial[b] = sum of x[i] * y[i] over the grid-stride slice of block b
+__global__ void vector_dot_partial_kernel(const double *__restrict__ x,
+                                          const double *__restrict__ y, int n,
+                                          double *__restrict__ partial)
+{
+    double sum[1] = {0.0};
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n;
+         i += gridDim.x * blockDim.x)
+        sum[0] += x[i] * y[i];
+    block_sum_to_partials<1>(sum, partial);
+}
+
+// one pass over [variables | constraints] for the fixed point error
+__global__ void movement_partial_kernel(const double *__restrict__ delta_primal,
+                                        const double *__restrict__ delta_dual,
+                                        const double *__restrict__ dual_product,
+                                        int n_vars, int n_cons,
+                                        double *__restrict__ partial)
+{
+    double sums[3] = {0.0, 0.0, 0.0};
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < n_vars + n_cons;
+         i += gridDim.x * blockDim.x)
+    {
+        if (i < n_vars)
+        {
+            sums[0] += delta_primal[i] * delta_primal[i];
+            sums[2] += dual_product[i] * delta_primal[i];
+        }
+        else
+        {
+            double d = delta_dual[i - n_vars];
+            sums[1] += d * d;
+        }
     }
+    block_sum_to_partials<3>(sums, partial);
+}
+
+double get_vector_dot(pdhg_solver_state_t *state, int n, const double *x,
+                      const double *y)
+{
+    if (n <= 0)
+        return 0.0;
+
+    int num_blocks = reduction_blocks(n);
+    vector_dot_partial_kernel<<<num_blocks, THREADS_PER_BLOCK, 0,
+                                state->stream>>>(x, y, n,
+                                                 state->reduction_buffer);
+    double dot;
+    finish_reduction(state, num_blocks, 1, &dot);
+    return dot;
+}
+
+double get_vector_norm(pdhg_solver_state_t *state, int n, const double *x)
+{
+    return sqrt(get_vector_dot(state, n, x, x));
+}
+
+void get_movement_sums(pdhg_solver_state_t *state, double *primal_sq,
+                       double *dual_sq, double *cross_term)
+{
+    int num_blocks =
+        reduction_blocks((long long)state->num_variables + state->num_constraints);
+    movement_partial_kernel<<<num_blocks, THREADS_PER_BLOCK, 0, state->stream>>>(
+        state->delta_primal_solution, state->delta_dual_solution,
+        state->dual_product, state->num_variables, state->num_constraints,
+        state->reduction_buffer);
+    double sums[3];
+    finish_reduction(state, num_blocks, 3, sums);
+    *primal_sq = sums[0];
+    *dual_sq = sums[1];
+    *cross_term = sums[2];
 }
 
 static double get_vector_inf_norm(cublasHandle_t handle, int n,
@@ -651,73 +1237,53 @@ static double get_vector_inf_norm(cublasHandle_t handle, int n,
     return fabs(max_val);
 }
 
-static double get_vector_sum(cublasHandle_t handle, int n, double *ones_d,
+static double get_vector_sum(pdhg_solver_state_t *state, int n,
                              const double *x_d)
 {
     if (n <= 0)
         return 0.0;
 
+    int num_blocks = reduction_blocks(n);
+    vector_sum_partial_kernel<<<num_blocks, THREADS_PER_BLOCK, 0,
+                                state->stream>>>(x_d, n,
+                                                 state->reduction_buffer);
     double sum;
-    CUBLAS_CHECK(cublasDdot(handle, n, x_d, 1, ones_d, 1, &sum));
+    finish_reduction(state, num_blocks, 1, &sum);
     return sum;
 }
 
 void compute_residual(pdhg_solver_state_t *state)
 {
     NVTX_RANGE("residual");
-    cusparseDnVecSetValues(state->vec_primal_sol, state->pdhg_primal_solution);
-    cusparseDnVecSetValues(state->vec_dual_sol, state->pdhg_dual_solution);
-    cusparseDnVecSetValues(state->vec_primal_prod, state->primal_product);
-    cusparseDnVecSetValues(state->vec_dual_prod, state->dual_product);
-
-    CUSPARSE_CHECK(cusparseSpMV(
-        state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
-        state->matA, state->vec_primal_sol, &HOST_ZERO, state->vec_primal_prod,
-        CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->primal_spmv_buffer));
-
-    CUSPARSE_CHECK(cusparseSpMV(
-        state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
-        state->matAt, state->vec_dual_sol, &HOST_ZERO, state->vec_dual_prod,
-        CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->dual_spmv_buffer));
-
-    compute_residual_kernel<<<state->num_blocks_primal_dual, THREADS_PER_BLOCK>>>(
-        state->primal_residual, state->primal_product,
-        state->constraint_lower_bound, state->constraint_upper_bound,
-        state->pdhg_dual_solution, state->dual_residual, state->dual_product,
-        state->dual_slack, state->objective_vector, state->constraint_rescaling,
-        state->variable_rescaling, state->primal_slack,
-        state->constraint_lower_bound_finite_val,
-        state->constraint_upper_bound_finite_val, state->num_constraints,
-        state->num_variables);
+    compute_primal_product(state, state->pdhg_primal_solution,
+                           state->primal_product);
+    compute_dual_product(state, state->pdhg_dual_solution, state->dual_product);
 
-    CUBLAS_CHECK(cublasDnrm2_v2_64(state->blas_handle, state->num_constraints,
-                                   state->primal_residual, 1,
-                                   &state->absolute_primal_residual));
-    state->absolute_primal_residual /= state->constraint_bound_rescaling;
-    CUBLAS_CHECK(cublasDnrm2_v2_64(state->blas_handle, state->num_variables,
-                                   state->dual_residual, 1,
-                                   &state->absolute_dual_residual));
-    state->absolute_dual_residual /= state->objective_vector_rescaling;
-
-    CUBLAS_CHECK(cublasDdot(
-        state->blas_handle, state->num_variables, state->objective_vector, 1,
-        state->pdhg_primal_solution, 1, &state->primal_objective_value));
+    int num_blocks =
+        reduction_blocks((long long)state->num_constraints + state->num_variables);
+    compute_residual_kernel<<<num_blocks, THREADS_PER_BLOCK, 0, state->stream>>>(
+        state->primal_product, state->constraint_lower_bound,
+        state->constraint_upper_bound, state->pdhg_dual_solution,
+        state->dual_product, state->dual_slack, state->objective_vector,
+        state->pdhg_primal_solution, state->constraint_rescaling,
+        state->variable_rescaling, state->num_constraints, state->num_variables,
+        state->reduction_buffer);
+    double sums[RESIDUAL_NUM_SUMS];
+    finish_reduction(state, num_blocks, RESIDUAL_NUM_SUMS, sums);
+
+    state->absolute_primal_residual =
+        sqrt(sums[RESIDUAL_PRIMAL_SQ]) / state->constraint_bound_rescaling;
+    state->absolute_dual_residual =
+        sqrt(sums[RESIDUAL_DUAL_SQ]) / state->objective_vector_rescaling;
     state->primal_objective_value =
-        state->primal_objective_value / (state->constraint_bound_rescaling *
-                                         state->objective_vector_rescaling) +
+        sums[RESIDUAL_PRIMAL_OBJECTIVE] / (state->constraint_bound_rescaling *
+                                           state->objective_vector_rescaling) +
+        state->objective_constant;
+    state->dual_objective_value =
+        (sums[RESIDUAL_DUAL_SLACK_TERM] + sums[RESIDUAL_DUAL_BOUND_TERM]) /
+            (state->constraint_bound_rescaling *
+             state->objective_vector_rescaling) +
         state->objective_constant;
-
-    double base_dual_objective;
-    CUBLAS_CHECK(cublasDdot(state->blas_handle, state->num_variables,
-                            state->dual_slack, 1, state->pdhg_primal_solution, 1,
-                            &base_dual_objective));
-    double dual_slack_sum =
-        get_vector_sum(state->blas_handle, state->num_constraints,
-                       state->ones_dual_d, state->primal_slack);
-    state->dual_objective_value = (base_dual_objective + dual_slack_sum) /
-                                      (state->constraint_bound_rescaling *
-                                       state->objective_vector_rescaling) +
-                                  state->objective_constant;
 
     state->relative_primal_residual =
         state->absolute_primal_residual / (1.0 + state->constraint_bound_norm);
@@ -753,49 +1319,32 @@ void compute_infeasibility_information(pdhg_solver_state_t *state)
     double dual_ray_inf_norm = get_vector_inf_norm(
         state->blas_handle, state->num_constraints, state->delta_dual_solution);
 
-    CUSPARSE_CHECK(cusparseDnVecSetValues(state->vec_primal_sol,
-                                          state->delta_primal_solution));
-    CUSPARSE_CHECK(
-        cusparseDnVecSetValues(state->vec_dual_sol, state->delta_dual_solution));
-    CUSPARSE_CHECK(
-        cusparseDnVecSetValues(state->vec_primal_prod, state->primal_product));
-    CUSPARSE_CHECK(
-        cusparseDnVecSetValues(state->vec_dual_prod, state->dual_product));
-
-    CUSPARSE_CHECK(cusparseSpMV(
-        state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
-        state->matA, state->vec_primal_sol, &HOST_ZERO, state->vec_primal_prod,
-        CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->primal_spmv_buffer));
-
-    CUSPARSE_CHECK(cusparseSpMV(
-        state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE,
-        state->matAt, state->vec_dual_sol, &HOST_ZERO, state->vec_dual_prod,
-        CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->dual_spmv_buffer));
-
-    CUBLAS_CHECK(cublasDdot(
-        state->blas_handle, state->num_variables, state->objective_vector, 1,
-        state->delta_primal_solution, 1, &state->primal_ray_linear_objective));
+    compute_primal_product(state, state->delta_primal_solution,
+                           state->primal_product);
+    compute_dual_product(state, state->delta_dual_solution, state->dual_product);
+
+    state->primal_ray_linear_objective =
+        get_vector_dot(state, state->num_variables, state->objective_vector,
+                       state->delta_primal_solution);
     state->primal_ray_linear_objective /=
         (state->constraint_bound_rescaling * state->objective_vector_rescaling);
 
     dual_solution_dual_objective_contribution_kernel<<<state->num_blocks_dual,
                                                        THREADS_PER_BLOCK>>>(
-        state->constraint_lower_bound_finite_val,
-        state->constraint_upper_bound_finite_val, state->delta_dual_solution,
+        state->constraint_lower_bound, state->constraint_upper_bound,
+        state->delta_dual_solution,
         state->num_constraints, state->primal_slack);
 
     dual_objective_dual_slack_contribution_array_kernel<<<
         state->num_blocks_primal, THREADS_PER_BLOCK>>>(
         state->dual_product, state->dual_slack,
-        state->variable_lower_bound_finite_val,
-        state->variable_upper_bound_finite_val, state->num_variables);
+        state->variable_lower_bound, state->variable_upper_bound,
+        state->num_variables);
 
     double sum_primal_slack =
-        get_vector_sum(state->blas_handle, state->num_constraints,
-                       state->ones_dual_d, state->primal_slack);
+        get_vector_sum(state, state->num_constraints, state->primal_slack);
     double sum_dual_slack =
-        get_vector_sum(state->blas_handle, state->num_variables,
-                       state->ones_primal_d, state->dual_slack);
+        get_vector_sum(state, state->num_variables, state->dual_slack);
     state->dual_ray_objective =
         (sum_primal_slack + sum_dual_slack) /
         (state->constraint_bound_rescaling * state->objective_vector_rescaling);
@@ -841,225 +1390,535 @@ void fill_or_copy(double **dst, int n, const double *src, double fill_val)
             (*dst)[i] = fill_val;
 }
 
-// convert dense ? CSR
-int dense_to_csr(const matrix_desc_t *desc, int **row_ptr, int **col_ind,
-                 double **vals, int *nnz_out)
+#ifdef __linux__
+// the cpus sysfs lists as local to the current device, e.g. "0-15,32-47"
+static bool device_local_cpus(cpu_set_t *cpus)
+{
+    int device;
+    char bus_id[32];
+    if (cudaGetDevice(&device) != cudaSuccess ||
+        cudaDeviceGetPCIBusId(bus_id, sizeof(bus_id), device) != cudaSuccess)
+        return false;
+    for (char *c = bus_id; *c; ++c)
+        *c = (char)tolower((unsigned char)*c);
+
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/bus/pci/devices/%s/local_cpulist",
+             bus_id);
+    FILE *f = fopen(path, "r");
+    if (f == NULL)
+        return false;
+    CPU_ZERO(cpus);
+    int first, last;
+    while (fscanf(f, "%d", &first) == 1)
+    {
+        last = first;
+        int sep = fgetc(f);
+        if (sep == '-')
+        {
+            if (fscanf(f, "%d", &last) != 1)
+                break;
+            sep = fgetc(f);
+        }
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu)
+            CPU_SET(cpu, cpus);
+        if (sep != ',')
+            break;
+    }
+    fclose(f);
+    return CPU_COUNT(cpus) > 0;
+}
+#endif
+
+void *pin_thread_to_device_cpus(void)
 {
-    int m = desc->m, n = desc->n;
-    double tol = (desc->zero_tolerance > 0) ? desc->zero_tolerance : 1e-12;
+#ifdef __linux__
+    cpu_set_t local;
+    if (!device_local_cpus(&local))
+        return NULL;
+    cpu_set_t *previous = (cpu_set_t *)safe_malloc(sizeof(cpu_set_t));
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), previous) != 0 ||
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &local) != 0)
+    {
+        free(previous);
+        return NULL;
+    }
+    return previous;
+#else
+    return NULL;
+#endif
+}
 
-    // count nnz
-    int nnz = 0;
-    for (int i = 0; i < m * n; ++i)
+void restore_thread_cpus(void *previous)
+{
+#ifdef __linux__
+    if (previous == NULL)
+        return;
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                           (cpu_set_t *)previous);
+    free(previous);
+#endif
+}
+
+// entries per thread below which the conversions stay single-threaded
+#define CONVERSION_GRAIN (1 << 16)
+
+static int conversion_threads(long long work)
+{
+    long long threads = work / CONVERSION_GRAIN + 1;
+    long long hardware = (long long)std::thread::hardware_concurrency();
+    if (hardware < 1)
+        hardware = 1;
+    return (int)((threads < hardware) ? threads : hardware);
+}
+
+// runs body(t, begin, end) for equal slices of [0, n), one per thread
+template <typename Body>
+static void parallel_slices(long long n, int num_threads, Body body)
+{
+    std::vector<std::thread> workers;
+    for (int t = 1; t < num_threads; ++t)
+        workers.emplace_back(body, t, n * t / num_threads,
+                             n * (t + 1) / num_threads);
+    body(0, 0LL, n / num_threads);
+    for (size_t t = 0; t < workers.size(); ++t)
+        workers[t].join();
+}
+
+// calls fn with null pointers of the index and value element types, so the
+// conversions below are instantiated once per combination
+template <typename Fn>
+static int with_element_types(matrix_index_type_t index_type,
+                              matrix_value_type_t value_type, Fn fn)
+{
+    if (index_type == matrix_int64)
     {
-        if (fabs(desc->data.dense.A[i]) > tol)
-            ++nnz;
+        if (value_type == matrix_float32)
+            return fn((const long long *)NULL, (const float *)NULL);
+        return fn((const long long *)NULL, (const double *)NULL);
     }
+    if (value_type == matrix_float32)
+        return fn((const int *)NULL, (const float *)NULL);
+    return fn((const int *)NULL, (const double *)NULL);
+}
+
+// convert dense -> CSR; rows are split over threads, each counts its rows,
+// and the offsets are scanned before the same threads fill them
+template <typename V>
+static int dense_to_csr_typed(const matrix_desc_t *desc, const V *A,
+                              int **row_ptr, int **col_ind, double **vals,
+                              int *nnz_out)
+{
+    const int m = desc->m, n = desc->n;
+    const double tol = (desc->zero_tolerance > 0) ? desc->zero_tolerance : 1e-12;
+    const int num_threads = conversion_threads((long long)m * n);
 
-    // allocate
     *row_ptr = (int *)safe_malloc((size_t)(m + 1) * sizeof(int));
-    *col_ind = (int *)safe_malloc((size_t)nnz * sizeof(int));
-    *vals = (double *)safe_malloc((size_t)nnz * sizeof(double));
+    int *count = *row_ptr + 1;
 
-    // fill
-    int nz = 0;
+    // branch-free count so the inner loop vectorizes
+    parallel_slices(m, num_threads, [&](int, long long begin, long long end)
+                    {
+        for (long long i = begin; i < end; ++i)
+        {
+            const V *row = A + i * (size_t)n;
+            int c = 0;
+            for (int j = 0; j < n; ++j)
+                c += (fabs((double)row[j]) > tol);
+            count[i] = c;
+        } });
+
+    long long nnz = 0;
+    (*row_ptr)[0] = 0;
     for (int i = 0; i < m; ++i)
     {
-        (*row_ptr)[i] = nz;
-        for (int j = 0; j < n; ++j)
+        nnz += count[i];
+        if (nnz > INT_MAX)
         {
-            double v = desc->data.dense.A[i * n + j];
-            if (fabs(v) > tol)
-            {
-                (*col_ind)[nz] = j;
-                (*vals)[nz] = v;
-                ++nz;
-            }
+            fprintf(stderr, "[interface] dense: too many nonzeros\n");
+            free(*row_ptr);
+            *row_ptr = NULL;
+            return -1;
         }
+        (*row_ptr)[i + 1] = (int)nnz;
     }
-    (*row_ptr)[m] = nz;
-    *nnz_out = nz;
+
+    *col_ind = (int *)safe_malloc((size_t)nnz * sizeof(int));
+    *vals = (double *)safe_malloc((size_t)nnz * sizeof(double));
+
+    parallel_slices(m, num_threads, [&](int, long long begin, long long end)
+                    {
+        for (long long i = begin; i < end; ++i)
+        {
+            const V *row = A + i * (size_t)n;
+            int nz = (*row_ptr)[i];
+            for (int j = 0; j < n; ++j)
+            {
+                if (fabs((double)row[j]) > tol)
+                {
+                    (*col_ind)[nz] = j;
+                    (*vals)[nz] = (double)row[j];
+                    ++nz;
+                }
+            }
+        } });
+
+    *nnz_out = (int)nnz;
     return 0;
 }
 
-// convert CSC ? CSR
-int csc_to_csr(const matrix_desc_t *desc, int **row_ptr, int **col_ind,
-               double **vals, int *nnz_out)
+int dense_to_csr(const matrix_desc_t *desc, matrix_value_type_t value_type,
+                 int **row_ptr, int **col_ind, double **vals, int *nnz_out)
 {
-    const int m = desc->m, n = desc->n;
-    const int *col_ptr = desc->data.csc.col_ptr;
-    const int *row_ind = desc->data.csc.row_ind;
-    const double *v = desc->data.csc.vals;
+    return with_element_types(matrix_int32, value_type, [&](auto, auto value)
+                              { return dense_to_csr_typed(desc, (decltype(value))desc->data.dense.A,
+                                                          row_ptr, col_ind, vals, nnz_out); });
+}
 
-    const double tol = (desc->zero_tolerance > 0) ? desc->zero_tolerance : 0.0;
+// copy CSR with other index or value types into int and double arrays,
+// checking that the entries fit; rows are split over threads
+template <typename I, typename V>
+static int csr_to_csr_typed(const matrix_desc_t *desc, const I *rp, const I *ci,
+                            const V *v, int **row_ptr, int **col_ind,
+                            double **vals, int *nnz_out)
+{
+    const int m = desc->m, n = desc->n;
+    if (rp[0] != 0 || rp[m] < 0 || rp[m] > INT_MAX)
+    {
+        fprintf(stderr, "[interface] CSR: too many nonzeros\n");
+        return -1;
+    }
+    const int nnz = (int)rp[m];
+    const int num_threads = conversion_threads((long long)nnz + m);
+    std::vector<char> failed(num_threads, 0);
 
-    // count entries per row
     *row_ptr = (int *)safe_malloc((size_t)(m + 1) * sizeof(int));
-    for (int i = 0; i <= m; ++i)
-        (*row_ptr)[i] = 0;
+    *col_ind = (int *)safe_malloc((size_t)nnz * sizeof(int));
+    *vals = (double *)safe_malloc((size_t)nnz * sizeof(double));
 
-    // count nnz
-    int eff_nnz = 0;
-    for (int j = 0; j < n; ++j)
-    {
-        for (int k = col_ptr[j]; k < col_ptr[j + 1]; ++k)
+    parallel_slices(m, num_threads, [&](int t, long long begin, long long end)
+                    {
+        for (long long i = begin; i < end; ++i)
         {
-            int ri = row_ind[k];
-            if (ri < 0 || ri >= m)
+            if (rp[i] > rp[i + 1] || rp[i + 1] > nnz)
             {
-                fprintf(stderr, "[interface] CSC: row index out of range\n");
-                return -1;
+                failed[t] = 1;
+                return;
             }
-            double val = v[k];
-            if (tol > 0 && fabs(val) <= tol)
-                continue;
-            ++((*row_ptr)[ri + 1]);
-            ++eff_nnz;
-        }
-    }
-
-    // exclusive scan
-    for (int i = 0; i < m; ++i)
-        (*row_ptr)[i + 1] += (*row_ptr)[i];
-
-    // allocate
-    *col_ind = (int *)safe_malloc((size_t)eff_nnz * sizeof(int));
-    *vals = (double *)safe_malloc((size_t)eff_nnz * sizeof(double));
-
-    // next position to fill in each row
-    int *next = (int *)safe_malloc((size_t)m * sizeof(int));
-    for (int i = 0; i < m; ++i)
-        next[i] = (*row_ptr)[i];
+            (*row_ptr)[i] = (int)rp[i];
+            for (long long k = rp[i]; k < rp[i + 1]; ++k)
+            {
+                if (ci[k] < 0 || ci[k] >= n)
+                {
+                    failed[t] = 1;
+                    return;
+                }
+                (*col_ind)[k] = (int)ci[k];
+                (*vals)[k] = (double)v[k];
+            }
+        } });
+    (*row_ptr)[m] = nnz;
 
-    // fill column indices and values
-    for (int j = 0; j < n; ++j)
+    for (int t = 0; t < num_threads; ++t)
     {
-        for (int k = col_ptr[j]; k < col_ptr[j + 1]; ++k)
+        if (failed[t])
         {
-            int ri = row_ind[k];
-            double val = v[k];
-            if (tol > 0 && fabs(val) <= tol)
-                continue;
-            int pos = next[ri]++;
-            (*col_ind)[pos] = j;
-            (*vals)[pos] = val;
+            fprintf(stderr, "[interface] CSR: index out of range\n");
+            free(*row_ptr);
+            free(*col_ind);
+            free(*vals);
+            *row_ptr = NULL;
+            *col_ind = NULL;
+            *vals = NULL;
+            return -1;
         }
     }
 
-    free(next);
-    *nnz_out = eff_nnz;
+    *nnz_out = nnz;
     return 0;
 }
 
-// convert COO ? CSR
-int coo_to_csr(const matrix_desc_t *desc, int **row_ptr, int **col_ind,
+int csr_to_csr(const matrix_desc_t *desc, matrix_index_type_t index_type,
+               matrix_value_type_t value_type, int **row_ptr, int **col_ind,
                double **vals, int *nnz_out)
+{
+    return with_element_types(index_type, value_type, [&](auto index, auto value)
+                              {
+        typedef decltype(index) I;
+        typedef decltype(value) V;
+        return csr_to_csr_typed(desc, (I)desc->data.csr.row_ptr,
+                                (I)desc->data.csr.col_ind,
+                                (V)desc->data.csr.vals, row_ptr, col_ind,
+                                vals, nnz_out); });
+}
+
+// convert CSC -> CSR in two passes: every thread counts the rows of its
+// columns into its own histogram, the histograms are scanned into per-thread
+// row offsets, and every thread scatters its columns in order, so the
+// columns within each row stay sorted
+template <typename I, typename V>
+static int csc_to_csr_typed(const matrix_desc_t *desc, const I *col_ptr,
+                            const I *row_ind, const V *v, int **row_ptr,
+                            int **col_ind, double **vals, int *nnz_out)
 {
     const int m = desc->m, n = desc->n;
-    const int nnz_in = desc->data.coo.nnz;
-    const int *r = desc->data.coo.row_ind;
-    const int *c = desc->data.coo.col_ind;
-    const double *v = desc->data.coo.vals;
     const double tol = (desc->zero_tolerance > 0) ? desc->zero_tolerance : 0.0;
-
-    // count nnz
-    int nnz = 0;
-    if (tol > 0)
-    {
-        for (int k = 0; k < nnz_in; ++k)
-            if (fabs(v[k]) > tol)
-                ++nnz;
-    }
-    else
+    if (col_ptr[n] > INT_MAX)
     {
-        nnz = nnz_in;
+        fprintf(stderr, "[interface] CSC: too many nonzeros\n");
+        return -1;
     }
 
-    *row_ptr = (int *)safe_malloc((size_t)(m + 1) * sizeof(int));
-    *col_ind = (int *)safe_malloc((size_t)nnz * sizeof(int));
-    *vals = (double *)safe_malloc((size_t)nnz * sizeof(double));
+    // one histogram of m counts per thread
+    int num_threads = conversion_threads(col_ptr[n]);
+    while (num_threads > 1 && (long long)num_threads * m > 4LL * col_ptr[n] + m)
+        --num_threads;
 
-    // count entries per row
-    for (int i = 0; i <= m; ++i)
-        (*row_ptr)[i] = 0;
-    if (tol > 0)
-    {
-        for (int k = 0; k < nnz_in; ++k)
-            if (fabs(v[k]) > tol)
+    std::vector<int> offset((size_t)num_threads * m, 0);
+    std::vector<char> failed(num_threads, 0);
+
+    parallel_slices(n, num_threads, [&](int t, long long begin, long long end)
+                    {
+        int *hist = offset.data() + (size_t)t * m;
+        for (long long j = begin; j < end; ++j)
+        {
+            for (long long k = col_ptr[j]; k < col_ptr[j + 1]; ++k)
             {
-                int ri = r[k];
-                if (ri < 0 || ri >= m)
+                if (row_ind[k] < 0 || row_ind[k] >= m)
                 {
-                    fprintf(stderr, "[interface] COO: row index out of range\n");
-                    return -1;
+                    failed[t] = 1;
+                    return;
                 }
-                ++((*row_ptr)[ri + 1]);
+                if (tol > 0 && fabs((double)v[k]) <= tol)
+                    continue;
+                ++hist[row_ind[k]];
             }
-    }
-    else
+        } });
+
+    for (int t = 0; t < num_threads; ++t)
     {
-        for (int k = 0; k < nnz_in; ++k)
+        if (failed[t])
         {
-            int ri = r[k];
-            if (ri < 0 || ri >= m)
-            {
-                fprintf(stderr, "[interface] COO: row index out of range\n");
-                return -1;
-            }
-            ++((*row_ptr)[ri + 1]);
+            fprintf(stderr, "[interface] CSC: row index out of range\n");
+            return -1;
         }
     }
 
-    // exclusive scan
+    // exclusive scan over rows, then over threads within each row
+    *row_ptr = (int *)safe_malloc((size_t)(m + 1) * sizeof(int));
+    int nnz = 0;
     for (int i = 0; i < m; ++i)
-        (*row_ptr)[i + 1] += (*row_ptr)[i];
+    {
+        (*row_ptr)[i] = nnz;
+        for (int t = 0; t < num_threads; ++t)
+        {
+            int c = offset[(size_t)t * m + i];
+            offset[(size_t)t * m + i] = nnz;
+            nnz += c;
+        }
+    }
+    (*row_ptr)[m] = nnz;
 
-    // next position to fill in each row
-    int *next = (int *)safe_malloc((size_t)m * sizeof(int));
-    for (int i = 0; i < m; ++i)
-        next[i] = (*row_ptr)[i];
+    *col_ind = (int *)safe_malloc((size_t)nnz * sizeof(int));
+    *vals = (double *)safe_malloc((size_t)nnz * sizeof(double));
 
-    // fill column indices and values
-    if (tol > 0)
+    parallel_slices(n, num_threads, [&](int t, long long begin, long long end)
+                    {
+        int *next = offset.data() + (size_t)t * m;
+        for (long long j = begin; j < end; ++j)
+        {
+            for (long long k = col_ptr[j]; k < col_ptr[j + 1]; ++k)
+            {
+                if (tol > 0 && fabs((double)v[k]) <= tol)
+                    continue;
+                int pos = next[row_ind[k]]++;
+                (*col_ind)[pos] = (int)j;
+                (*vals)[pos] = (double)v[k];
+            }
+        } });
+
+    *nnz_out = nnz;
+    return 0;
+}
+
+int csc_to_csr(const matrix_desc_t *desc, matrix_index_type_t index_type,
+               matrix_value_type_t value_type, int **row_ptr, int **col_ind,
+               double **vals, int *nnz_out)
+{
+    return with_element_types(index_type, value_type, [&](auto index, auto value)
+                              {
+        typedef decltype(index) I;
+        typedef decltype(value) V;
+        return csc_to_csr_typed(desc, (I)desc->data.csc.col_ptr,
+                                (I)desc->data.csc.row_ind,
+                                (V)desc->data.csc.vals, row_ptr, col_ind,
+                                vals, nnz_out); });
+}
+
+static int bit_width(unsigned int x)
+{
+    int bits = 0;
+    while (x)
     {
-        for (int k = 0; k < nnz_in; ++k)
+        ++bits;
+        x >>= 1;
+    }
+    return bits;
+}
+
+// convert COO -> CSR: entries are keyed by (row, col), sorted with a stable
+// parallel LSD radix sort, and duplicates are summed in input order
+template <typename I, typename V>
+static int coo_to_csr_typed(const matrix_desc_t *desc, const I *r, const I *c,
+                            const V *v, int **row_ptr, int **col_ind,
+                            double **vals, int *nnz_out)
+{
+    const int m = desc->m, n = desc->n;
+    const int nnz_in = desc->data.coo.nnz;
+    const double tol = (desc->zero_tolerance > 0) ? desc->zero_tolerance : 0.0;
+    const int num_threads = conversion_threads(nnz_in);
+
+    const int col_bits = bit_width((unsigned int)(n > 1 ? n - 1 : 1));
+    const int key_bits = col_bits + bit_width((unsigned int)(m > 1 ? m - 1 : 1));
+    const unsigned long long col_mask = (1ULL << col_bits) - 1;
+
+    // validate and count the entries kept by each thread
+    std::vector<int> kept(num_threads + 1, 0);
+    std::vector<char> failed(num_threads, 0);
+    parallel_slices(nnz_in, num_threads, [&](int t, long long begin, long long end)
+                    {
+        int count = 0;
+        for (long long k = begin; k < end; ++k)
         {
-            if (fabs(v[k]) <= tol)
-                continue;
-            int ri = r[k], cj = c[k];
-            if (cj < 0 || cj >= n)
+            if (r[k] < 0 || r[k] >= m || c[k] < 0 || c[k] >= n)
             {
-                fprintf(stderr, "[interface] COO: col index out of range\n");
-                free(next);
-                return -1;
+                failed[t] = 1;
+                return;
             }
-            int pos = next[ri]++;
-            (*col_ind)[pos] = cj;
-            (*vals)[pos] = v[k];
+            count += !(tol > 0 && fabs((double)v[k]) <= tol);
+        }
+        kept[t + 1] = count; });
+
+    for (int t = 0; t < num_threads; ++t)
+    {
+        if (failed[t])
+        {
+            fprintf(stderr, "[interface] COO: index out of range\n");
+            return -1;
         }
+        kept[t + 1] += kept[t];
     }
-    else
+    const int nnz_kept = kept[num_threads];
+
+    std::vector<unsigned long long> keys(nnz_kept), keys_tmp(nnz_kept);
+    std::vector<double> values(nnz_kept), values_tmp(nnz_kept);
+    parallel_slices(nnz_in, num_threads, [&](int t, long long begin, long long end)
+                    {
+        int pos = kept[t];
+        for (long long k = begin; k < end; ++k)
+        {
+            if (tol > 0 && fabs((double)v[k]) <= tol)
+                continue;
+            keys[pos] = ((unsigned long long)r[k] << col_bits) | (unsigned long long)c[k];
+            values[pos] = (double)v[k];
+            ++pos;
+        } });
+
+    // one stable counting pass per byte of the key: per-thread histograms,
+    // scanned in (digit, thread) order so equal digits keep their order
+    std::vector<int> hist((size_t)num_threads * 256);
+    for (int shift = 0; shift < key_bits; shift += 8)
     {
-        for (int k = 0; k < nnz_in; ++k)
+        std::fill(hist.begin(), hist.end(), 0);
+        parallel_slices(nnz_kept, num_threads, [&](int t, long long begin, long long end)
+                        {
+            int *h = hist.data() + (size_t)t * 256;
+            for (long long k = begin; k < end; ++k)
+                ++h[(keys[k] >> shift) & 0xff]; });
+
+        int sum = 0;
+        for (int d = 0; d < 256; ++d)
         {
-            int ri = r[k], cj = c[k];
-            if (cj < 0 || cj >= n)
+            for (int t = 0; t < num_threads; ++t)
             {
-                fprintf(stderr, "[interface] COO: col index out of range\n");
-                free(next);
-                return -1;
+                int h = hist[(size_t)t * 256 + d];
+                hist[(size_t)t * 256 + d] = sum;
+                sum += h;
             }
-            int pos = next[ri]++;
-            (*col_ind)[pos] = cj;
-            (*vals)[pos] = v[k];
         }
+
+        parallel_slices(nnz_kept, num_threads, [&](int t, long long begin, long long end)
+                        {
+            int *next = hist.data() + (size_t)t * 256;
+            for (long long k = begin; k < end; ++k)
+            {
+                int pos = next[(keys[k] >> shift) & 0xff]++;
+                keys_tmp[pos] = keys[k];
+                values_tmp[pos] = values[k];
+            } });
+        keys.swap(keys_tmp);
+        values.swap(values_tmp);
     }
 
-    free(next);
+    // each thread owns the runs of equal keys that start in its slice
+    std::vector<int> unique(num_threads + 1, 0);
+    parallel_slices(nnz_kept, num_threads, [&](int t, long long begin, long long end)
+                    {
+        int count = 0;
+        for (long long k = begin; k < end; ++k)
+            count += (k == 0 || keys[k] != keys[k - 1]);
+        unique[t + 1] = count; });
+    for (int t = 0; t < num_threads; ++t)
+        unique[t + 1] += unique[t];
+    const int nnz = unique[num_threads];
+
+    *row_ptr = (int *)safe_malloc((size_t)(m + 1) * sizeof(int));
+    *col_ind = (int *)safe_malloc((size_t)nnz * sizeof(int));
+    *vals = (double *)safe_malloc((size_t)nnz * sizeof(double));
+    std::vector<unsigned long long> unique_keys(nnz);
+
+    parallel_slices(nnz_kept, num_threads, [&](int t, long long begin, long long end)
+                    {
+        int pos = unique[t];
+        for (long long k = begin; k < end; ++k)
+        {
+            if (k > 0 && keys[k] == keys[k - 1])
+                continue;
+            double sum = values[k];
+            for (long long l = k + 1; l < nnz_kept && keys[l] == keys[k]; ++l)
+                sum += values[l];
+            unique_keys[pos] = keys[k];
+            (*col_ind)[pos] = (int)(keys[k] & col_mask);
+            (*vals)[pos] = sum;
+            ++pos;
+        } });
+
+    // row i starts at the first key not below (i, 0)
+    parallel_slices(m + 1, num_threads, [&](int, long long begin, long long end)
+                    {
+        for (long long i = begin; i < end; ++i)
+            (*row_ptr)[i] = (int)(std::lower_bound(unique_keys.begin(), unique_keys.end(),
+                                                   (unsigned long long)i << col_bits) -
+                                  unique_keys.begin()); });
+
     *nnz_out = nnz;
     return 0;
 }
 
+int coo_to_csr(const matrix_desc_t *desc, matrix_index_type_t index_type,
+               matrix_value_type_t value_type, int **row_ptr, int **col_ind,
+               double **vals, int *nnz_out)
+{
+    return with_element_types(index_type, value_type, [&](auto index, auto value)
+                              {
+        typedef decltype(index) I;
+        typedef decltype(value) V;
+        return coo_to_csr_typed(desc, (I)desc->data.coo.row_ind,
+                                (I)desc->data.coo.col_ind,
+                                (V)desc->data.coo.vals, row_ptr, col_ind,
+                                vals, nnz_out); });
+}
+
 void check_feas_polishing_termination_criteria(
     pdhg_solver_state_t *solver_state,
     const termination_criteria_t *criteria,
@@ -1093,20 +1952,17 @@ void check_feas_polishing_termination_criteria(
     }
 }
 
-void print_initial_feas_polish_info(bool is_primal_polish, const pdhg_parameters_t *params)
+void print_initial_feas_polish_info(const pdhg_parameters_t *params)
 {
     if (!params->verbose)
     {
         return;
     }
     printf("---------------------------------------------------------------------------------------\n");
-    printf("Starting %s Feasibility Polishing Phase with relative tolerance %.2e\n",
-           is_primal_polish ? "Primal" : "Dual",
+    printf("Starting Primal and Dual Feasibility Polishing Phases with relative tolerance %.2e\n",
            params->termination_criteria.eps_feas_polish_relative);
     printf("---------------------------------------------------------------------------------------\n");
-    if (is_primal_polish) printf("%s %s |  %s  | %s | %s \n",  "  iter", "  time ", "pr obj", " abs pr res ", " rel pr res ");
-    // else printf("%s %s | %s | %s \n",  "  iter", "  time ", " abs du res ", " rel du res ");
-    else printf("%s %s |  %s  | %s | %s \n", "  iter", "  time ", "du obj", " abs du res ", " rel du res ");  
+    printf("%s %s %s |  %s  | %s | %s \n", " phase", "  iter", "  time ", "   obj", "   abs res  ", "   rel res  ");
     printf("---------------------------------------------------------------------------------------\n");
 }
 
@@ -1136,9 +1992,12 @@ void display_feas_polish_iteration_stats(const pdhg_solver_state_t *state, bool
     }
     if (state->total_count % get_print_frequency(state->total_count) == 0)
     {
+        // the phases are printed one after the other, each row carries its
+        // phase all the same
+        FILE *out = state->polish_log ? state->polish_log : stdout;
         if (is_primal_polish)
         {
-            printf("%6d %.1e | %8.1e |    %.1e   |   %.1e   \n",
+            fprintf(out, "primal %6d %.1e | %8.1e |    %.1e   |   %.1e   \n",
                 state->total_count,
                 state->cumulative_time_sec,
                 state->primal_objective_value,
@@ -1147,7 +2006,7 @@ void display_feas_polish_iteration_stats(const pdhg_solver_state_t *state, bool
         }
         else
         {
-            printf("%6d %.1e | %8.1e |    %.1e   |   %.1e   \n",
+            fprintf(out, "  dual %6d %.1e | %8.1e |    %.1e   |   %.1e   \n",
                 state->total_count,
                 state->cumulative_time_sec,
                 state->dual_objective_value,
@@ -1158,95 +2017,120 @@ void display_feas_polish_iteration_stats(const pdhg_solver_state_t *state, bool
 
 }
 
+// sums[0] = squared primal residual norm, sums[1] = objective of the
+// original problem at the polished primal point
 __global__ void compute_primal_feas_polish_residual_kernel(
-    double *primal_residual,
     const double *primal_product,
     const double *constraint_lower_bound,
     const double *constraint_upper_bound,
     const double *constraint_rescaling,
-    int num_constraints)
+    const double *objective_vector,
+    const double *primal_solution,
+    int num_constraints,
+    int num_variables,
+    double *partial)
 {
-    int i = blockIdx.x * blockDim.x + threadIdx.x;
-
-    if (i < num_constraints)
+    double sums[2] = {0.0, 0.0};
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < num_constraints + num_variables; i += gridDim.x * blockDim.x)
     {
-
-        double clamped_val = fmax(constraint_lower_bound[i], fmin(primal_product[i], constraint_upper_bound[i]));
-        primal_residual[i] = (primal_product[i] - clamped_val) * constraint_rescaling[i];
+        if (i < num_constraints)
+        {
+            double clamped_val = fmax(constraint_lower_bound[i], fmin(primal_product[i], constraint_upper_bound[i]));
+            double residual = (primal_product[i] - clamped_val) * constraint_rescaling[i];
+            sums[0] += residual * residual;
+        }
+        else
+        {
+            int idx = i - num_constraints;
+            sums[1] += objective_vector[idx] * primal_solution[idx];
+        }
     }
+    block_sum_to_partials<2>(sums, partial);
 }
 
-__global__ void compute_dual_feas_polish_residual_kerenl(
-    double *dual_residual,
+// sums[0] = squared dual residual norm, sums[1] = unscaled dual objective
+// with the bounds of the original problem and its primal point
+__global__ void compute_dual_feas_polish_residual_kernel(
     const double *dual_solution,
     const double *dual_product,
     const double *dual_slack,
     const double *objective_vector,
     const double *variable_rescaling,
-    double *dual_obj_contribution,
-    const double *const_lb_finite,
-    const double *const_ub_finite,
+    const double *primal_solution,
+    const double *constraint_lower_bound,
+    const double *constraint_upper_bound,
     int num_variables,
-    int num_constraints)
+    int num_constraints,
+    double *partial)
 {
-    int i = blockIdx.x * blockDim.x + threadIdx.x;
-
-    if (i < num_variables)
-    {
-        dual_residual[i] = (objective_vector[i] - dual_product[i] - dual_slack[i]) * variable_rescaling[i];
-    }
-    else if (i < num_constraints + num_variables)
+    double sums[2] = {0.0, 0.0};
+    for (int i = blockIdx.x * blockDim.x + threadIdx.x; i < num_constraints + num_variables; i += gridDim.x * blockDim.x)
     {
-        int idx = i - num_variables;
-        dual_obj_contribution[idx] = fmax(dual_solution[idx], 0.0) * const_lb_finite[idx] + fmin(dual_solution[idx], 0.0) * const_ub_finite[idx];
+        if (i < num_variables)
+        {
+            double residual = (objective_vector[i] - dual_product[i] - dual_slack[i]) * variable_rescaling[i];
+            sums[0] += residual * residual;
+            sums[1] += dual_slack[i] * primal_solution[i];
+        }
+        else
+        {
+            int idx = i - num_variables;
+            sums[1] += fmax(dual_solution[idx], 0.0) * finite_or_zero(constraint_lower_bound[idx]) + fmin(dual_solution[idx], 0.0) * finite_or_zero(constraint_upper_bound[idx]);
+        }
     }
+    block_sum_to_partials<2>(sums, partial);
 }
 
 void compute_primal_feas_polish_residual(pdhg_solver_state_t *state, const pdhg_solver_state_t *ori_state)
 {
-    cusparseDnVecSetValues(state->vec_primal_sol, state->pdhg_primal_solution);
-    cusparseDnVecSetValues(state->vec_primal_prod, state->primal_product);
-
-    CUSPARSE_CHECK(cusparseSpMV(state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE, state->matA, state->vec_primal_sol, &HOST_ZERO, state->vec_primal_prod, CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->primal_spmv_buffer));
+    compute_primal_product(state, state->pdhg_primal_solution, state->primal_product);
 
-    compute_primal_feas_polish_residual_kernel<<<state->num_blocks_dual, THREADS_PER_BLOCK>>>(
-        state->primal_residual, state->primal_product, state->constraint_lower_bound,
+    int num_blocks = reduction_blocks((long long)state->num_constraints + state->num_variables);
+    compute_primal_feas_polish_residual_kernel<<<num_blocks, THREADS_PER_BLOCK, 0, state->stream>>>(
+        state->primal_product, state->constraint_lower_bound,
         state->constraint_upper_bound, state->constraint_rescaling,
-        state->num_constraints);
+        ori_state->objective_vector, state->pdhg_primal_solution,
+        state->num_constraints, state->num_variables, state->reduction_buffer);
+    double sums[2];
+    finish_reduction(state, num_blocks, 2, sums);
 
-    CUBLAS_CHECK(cublasDnrm2_v2_64(state->blas_handle, state->num_constraints, state->primal_residual, 1, &state->absolute_primal_residual));
-    state->absolute_primal_residual /= state->constraint_bound_rescaling;
+    state->absolute_primal_residual = sqrt(sums[0]) / state->constraint_bound_rescaling;
     state->relative_primal_residual = state->absolute_primal_residual / (1.0 + state->constraint_bound_norm);
-
-    CUBLAS_CHECK(cublasDdot(state->blas_handle, state->num_variables, ori_state->objective_vector, 1, state->pdhg_primal_solution, 1, &state->primal_objective_value));
-    state->primal_objective_value = state->primal_objective_value / (state->constraint_bound_rescaling * state->objective_vector_rescaling) + state->objective_constant;
+    state->primal_objective_value = sums[1] / (state->constraint_bound_rescaling * state->objective_vector_rescaling) + state->objective_constant;
 }
 
-void compute_dual_feas_polish_residual(pdhg_solver_state_t *state, const pdhg_solver_state_t *ori_state)
+// the dual polish residual and objective come from the same pass
+static void dual_feas_polish_reduction(pdhg_solver_state_t *state, const pdhg_solver_state_t *ori_state, double *sums)
 {
-    cusparseDnVecSetValues(state->vec_dual_sol, state->pdhg_dual_solution);
-    cusparseDnVecSetValues(state->vec_dual_prod, state->dual_product);
-
-    CUSPARSE_CHECK(cusparseSpMV(state->sparse_handle, CUSPARSE_OPERATION_NON_TRANSPOSE, &HOST_ONE, state->matAt, state->vec_dual_sol, &HOST_ZERO, state->vec_dual_prod, CUDA_R_64F, CUSPARSE_SPMV_CSR_ALG2, state->dual_spmv_buffer));
-
-    compute_dual_feas_polish_residual_kerenl<<<state->num_blocks_primal_dual, THREADS_PER_BLOCK>>>(
-        state->dual_residual, 
+    int num_blocks = reduction_blocks((long long)state->num_constraints + state->num_variables);
+    compute_dual_feas_polish_residual_kernel<<<num_blocks, THREADS_PER_BLOCK, 0, state->stream>>>(
         state->pdhg_dual_solution,
         state->dual_product,
         state->dual_slack, state->objective_vector,
         state->variable_rescaling,
-        state->primal_slack,
-        ori_state->constraint_lower_bound_finite_val,
-        ori_state->constraint_upper_bound_finite_val,
-        state->num_variables, state->num_constraints
-    );
-
-    CUBLAS_CHECK(cublasDnrm2_v2_64(state->blas_handle, state->num_variables, state->dual_residual, 1, &state->absolute_dual_residual));
-    state->absolute_dual_residual /= state->objective_vector_rescaling;
+        ori_state->pdhg_primal_solution,
+        ori_state->constraint_lower_bound,
+        ori_state->constraint_upper_bound,
+        state->num_variables, state->num_constraints,
+        state->reduction_buffer);
+    finish_reduction(state, num_blocks, 2, sums);
+}
+
+void compute_dual_feas_polish_residual(pdhg_solver_state_t *state, const pdhg_solver_state_t *ori_state)
+{
+    compute_dual_product(state, state->pdhg_dual_solution, state->dual_product);
+
+    double sums[2];
+    dual_feas_polish_reduction(state, ori_state, sums);
+
+    state->absolute_dual_residual = sqrt(sums[0]) / state->objective_vector_rescaling;
     state->relative_dual_residual = state->absolute_dual_residual / (1.0 + state->objective_vector_norm);
+    state->dual_objective_value = sums[1] / (state->constraint_bound_rescaling * state->objective_vector_rescaling) + state->objective_constant;
+}
 
-    double base_dual_objective;
-    CUBLAS_CHECK(cublasDdot(state->blas_handle, state->num_variables, state->dual_slack, 1, ori_state->pdhg_primal_solution, 1, &base_dual_objective));
-    double dual_slack_sum = get_vector_sum(state->blas_handle, state->num_constraints, state->ones_dual_d, state->primal_slack);
-    state->dual_objective_value = (base_dual_objective + dual_slack_sum) / (state->constraint_bound_rescaling * state->objective_vector_rescaling) + state->objective_constant;
+void compute_dual_feas_polish_objective(pdhg_solver_state_t *state, const pdhg_solver_state_t *ori_state)
+{
+    double sums[2];
+    dual_feas_polish_reduction(state, ori_state, sums);
+    state->dual_objective_value = sums[1] / (state->constraint_bound_rescaling * state->objective_vector_rescaling) + state->objective_constant;
 }
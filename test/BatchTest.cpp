@@ -46,6 +46,8 @@ const char *termination_reason_to_string(termination_reason_t reason)
         return "ITERATION_LIMIT";
     case TERMINATION_REASON_FEAS_POLISH_SUCCESS:
         return "FEAS_POLISH_SUCCESS";
+    case TERMINATION_REASON_USER_INTERRUPT:
+        return "USER_INTERRUPT";
     case TERMINATION_REASON_UNSPECIFIED:
         return "UNSPECIFIED";
     default:
@@ -15,6 +15,8 @@
 import os
 import numpy as np
 import pytest
+import scipy.sparse as sp
+from cupdlpx import Model
 
 # set numpy print options for better readability
 np.set_printoptions(suppress=True, linewidth=120, precision=6)
@@ -47,3 +49,84 @@ def base_lp_data():
     lb = None
     ub = None
     return c, A, l, u, lb, ub
+
+@pytest.fixture(scope="session")
+def random_lp():
+    """
+    Factory for random sparse LPs, returning c, A, u, lb, ub.
+    Minimize c'x  s.t.  A x <= u,  0 <= x <= 10, feasible by construction.
+    With pattern_seed, A comes from that seed alone, so LPs of different
+    seeds share it; slack is added to every row bound.
+    """
+    def make(seed, m=300, n=200, density=0.02, pattern_seed=None, slack=0.0):
+        rng = np.random.default_rng(seed=seed)
+        pattern_rng = rng if pattern_seed is None else np.random.default_rng(seed=pattern_seed)
+        A = sp.random(m, n, density=density, format="csr", random_state=pattern_rng)
+        c = rng.standard_normal(n)
+        x0 = rng.random(n) * 10.0
+        u = A @ x0 + rng.random(m) + slack
+        return c, A, u, np.zeros(n), np.full(n, 10.0)
+    return make
+
+
+@pytest.fixture(scope="session")
+def random_model(random_lp):
+    """
+    Factory for quiet, unsolved models of random_lp; keyword arguments other
+    than the LP shape go to setParams.
+    """
+    def make(seed, m=200, n=150, density=0.03, **params):
+        c, A, u, lb, ub = random_lp(seed, m=m, n=n, density=density)
+        model = Model(c, A, None, u, lb, ub)
+        model.setParams(OutputFlag=False, **params)
+        return model
+    return make
+
+@pytest.fixture(scope="session")
+def solve():
+    """
+    Builds a quiet model of c, A, l, u, lb, ub, solves it with the given
+    parameters and returns it.
+    """
+    def run(c, A, l, u, lb, ub, **params):
+        model = Model(c, A, l, u, lb, ub)
+        model.setParams(OutputFlag=False, **params)
+        model.optimize()
+        return model
+    return run
+
+@pytest.fixture(scope="session")
+def check_same_optimum(atol):
+    """
+    Asserts that model and ref are both optimal with equal objectives.
+    """
+    def check(model, ref):
+        assert model.Status == "OPTIMAL", f"Unexpected termination status: {model.Status}"
+        assert ref.Status == "OPTIMAL", f"Unexpected reference status: {ref.Status}"
+        rel = abs(model.ObjVal - ref.ObjVal) / (1.0 + abs(ref.ObjVal))
+        assert rel < atol, f"Objective mismatch: {model.ObjVal} != {ref.ObjVal}"
+    return check
+
+@pytest.fixture(scope="session")
+def transportation_lp():
+    """
+    Factory for transportation problems, returning c, A, l, u, lb, ub; all
+    coefficients are +1, so A takes the coded path.
+    Minimize c'x  s.t.  sum_j x_ij <= s_i,  sum_i x_ij >= d_j,  x >= 0.
+    """
+    def make(seed, supplies, demands):
+        rng = np.random.default_rng(seed=seed)
+        n = supplies * demands
+        rows, cols = [], []
+        for i in range(supplies):
+            for j in range(demands):
+                rows += [i, supplies + j]
+                cols += [i * demands + j] * 2
+        A = sp.csr_matrix((np.ones(len(rows)), (rows, cols)), shape=(supplies + demands, n))
+        d = rng.integers(1, 10, demands).astype(float)
+        s = np.full(supplies, 1.5 * d.sum() / supplies)
+        l = np.concatenate([np.full(supplies, -np.inf), d])
+        u = np.concatenate([s, np.full(demands, np.inf)])
+        c = rng.random(n) + 0.1
+        return c, A, l, u, np.zeros(n), np.full(n, np.inf)
+    return make
@@ -5,4 +5,16 @@ cmake --build build --clean-first
 
 # test
 wget -P test/ https://miplib.zib.de/WebData/instances/2club200v15p5scn.mps.gz
-./build/cupdlpx test/2club200v15p5scn.mps.gz test/ -v
\ No newline at end of file
+./build/cupdlpx test/2club200v15p5scn.mps.gz test/ -v
+
+# stored transpose against the row scatter: device memory measured around
+# the setup, iterations and solve time of both
+for mode in "" --transpose_free; do
+    ./build/cupdlpx test/2club200v15p5scn.mps.gz test/ -v $mode |
+        awk -v mode="${mode:---stored}" '
+            /^  device +:/ { mb = $3 }
+            /^  Iterations +:/ { it = $3 }
+            /^  Solve time +:/ { t = $4 }
+            END { printf "%-16s %10s MB %8d iter %10.3g s %10.3g ms/iter\n",
+                         mode, mb, it, t, (it > 0) ? 1000 * t / it : 0 }'
+done
@@ -93,4 +93,46 @@ def test_maximize_solution_correct(base_lp_data, atol):
     assert np.allclose(model.Pi, [-0.25, 0, -0.25], atol=atol), f"Unexpected dual solution: {model.Pi}"
     # check objective
     assert hasattr(model, "ObjVal"), "Model.ObjVal (objective value) not exposed."
-    assert np.isclose(model.ObjVal, 3.25, atol=atol), f"Unexpected objective value: {model.ObjVal}"
\ No newline at end of file
+    assert np.isclose(model.ObjVal, 3.25, atol=atol), f"Unexpected objective value: {model.ObjVal}"
+
+def test_derived_solution_vectors(base_lp_data, atol):
+    """
+    Slack, reduced costs and residual vectors are derived from X and Pi on access.
+    """
+    c, A, l, u, lb, ub = base_lp_data
+    m = Model(c, A, l, u, lb, ub)
+    m.setParams(OutputFlag=False)
+    assert m.Slack is None and m.RC is None, "Derived vectors exist before optimize()."
+    m.optimize()
+    assert m.Status == "OPTIMAL", f"Unexpected termination status: {m.Status}"
+    # the rows are tight, tight, and one unit inside the upper bound
+    assert np.allclose(m.Slack, [0, 0, 1], atol=atol), f"Unexpected slack: {m.Slack}"
+    # both variables are positive, hence basic, so their reduced costs are zero
+    assert np.allclose(m.RC, [0, 0], atol=atol), f"Unexpected reduced costs: {m.RC}"
+    assert np.allclose(m.PrimalResidual, 0, atol=atol), f"Unexpected primal residual: {m.PrimalResidual}"
+    assert np.allclose(m.DualResidual, 0, atol=atol), f"Unexpected dual residual: {m.DualResidual}"
+    # cached until the model changes
+    assert m.RC is m.RC, "Reduced costs are recomputed on every access."
+    m.setObjectiveVector(c)
+    assert m.RC is None, "Derived vectors survive a model change."
+
+
+def test_reduced_costs_follow_model_sense(atol):
+    """
+    Under MAXIMIZE a variable held at its lower bound has a non-positive
+    reduced cost.
+    Maximize  x1 - x2
+    Subject to
+        x1 + x2 <= 2
+         x1, x2 >= 0
+    """
+    c = np.array([1.0, -1.0])
+    A = np.array([[1.0, 1.0]])
+    m = Model(c, A, None, np.array([2.0]), None, None)
+    m.ModelSense = PDLP.MAXIMIZE
+    m.setParams(OutputFlag=False)
+    m.optimize()
+    assert m.Status == "OPTIMAL", f"Unexpected termination status: {m.Status}"
+    assert np.allclose(m.X, [2, 0], atol=atol), f"Unexpected primal solution: {m.X}"
+    assert np.allclose(m.RC, [0, -2], atol=atol), f"Unexpected reduced costs: {m.RC}"
+    assert np.allclose(m.DualResidual, 0, atol=atol), f"Unexpected dual residual: {m.DualResidual}"
@@ -0,0 +1,41 @@
+# Copyright 2025 Haihao Lu
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import pytest
+from cupdlpx import solve_many
+
+
+def test_solve_many_matches_single_solves(random_model, atol):
+    """
+    Solving a batch on several threads gives the results of one-by-one solves,
+    in input order.
+    """
+    batch = [random_model(seed) for seed in range(6)]
+    returned = solve_many(batch, max_workers=3)
+    assert returned == batch, "Models are not returned in input order."
+    for seed, model in enumerate(batch):
+        ref = random_model(seed)
+        ref.optimize()
+        assert model.Status == "OPTIMAL", f"Unexpected termination status: {model.Status}"
+        rel = abs(model.ObjVal - ref.ObjVal) / (1.0 + abs(ref.ObjVal))
+        assert rel < atol, f"Objective mismatch for model {seed}: {model.ObjVal} != {ref.ObjVal}"
+
+
+def test_solve_many_rejects_duplicates(random_model):
+    """
+    A model listed twice would be solved by two threads at once.
+    """
+    model = random_model(0)
+    with pytest.raises(ValueError):
+        solve_many([model, model])
@@ -0,0 +1,166 @@
+/*
+Copyright 2025 Haihao Lu
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "structure.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NUM_BLOCKS 20
+#define BLOCK_VARS 5
+#define NUM_VARS (NUM_BLOCKS * BLOCK_VARS)
+#define NUM_ROWS (NUM_BLOCKS * (BLOCK_VARS - 1) + 1)
+
+// block-angular matrix with its blocks interleaved: variable j and row r < 80
+// belong to block j % 20 and r % 20, each block row ties two neighbouring
+// variables of its block, and the last row links all of them
+static int build_matrix(int *row_ptr, int *col_ind)
+{
+    int nnz = 0;
+    row_ptr[0] = 0;
+    for (int r = 0; r < NUM_ROWS - 1; ++r)
+    {
+        int b = r % NUM_BLOCKS, k = r / NUM_BLOCKS;
+        col_ind[nnz++] = b + NUM_BLOCKS * k;
+        col_ind[nnz++] = b + NUM_BLOCKS * (k + 1);
+        row_ptr[r + 1] = nnz;
+    }
+    for (int j = 0; j < NUM_VARS; ++j)
+        col_ind[nnz++] = j;
+    row_ptr[NUM_ROWS] = nnz;
+    return nnz;
+}
+
+static int group_of(double lower, double upper)
+{
+    if (lower == -INFINITY && upper == INFINITY)
+        return 0;
+    if (upper == INFINITY)
+        return 1;
+    if (lower == -INFINITY)
+        return 2;
+    return (lower == upper) ? 4 : 3;
+}
+
+// the order must be a permutation, grouped by bound type, and ordered by
+// block inside each group
+static int check_order(const char *name, const double *lower,
+                       const double *upper, const int *block, int n)
+{
+    int perm[NUM_ROWS > NUM_VARS ? NUM_ROWS : NUM_VARS];
+    char seen[NUM_ROWS > NUM_VARS ? NUM_ROWS : NUM_VARS];
+    bound_partition_t partition =
+        partition_by_bound_type(lower, upper, block, n, perm);
+    int ends[4] = {partition.free_end, partition.lower_end,
+                   partition.upper_end, partition.boxed_end};
+
+    memset(seen, 0, sizeof(seen));
+    for (int k = 0; k < n; ++k)
+    {
+        int i = perm[k];
+        if (i < 0 || i >= n || seen[i])
+        {
+            printf("%s: not a permutation at %d\n", name, k);
+            return 1;
+        }
+        seen[i] = 1;
+
+        int group = group_of(lower[i], upper[i]);
+        if ((group > 0 && k < ends[group - 1]) || (group < 4 && k >= ends[group]))
+        {
+            printf("%s: entry %d is outside its bound group\n", name, i);
+            return 1;
+        }
+        if (k > 0 && group == group_of(lower[perm[k - 1]], upper[perm[k - 1]]) &&
+            block[perm[k - 1]] > block[i])
+        {
+            printf("%s: block %d follows block %d in group %d\n", name,
+                   block[i], block[perm[k - 1]], group);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int row_ptr[NUM_ROWS + 1];
+    int col_ind[2 * NUM_ROWS + NUM_VARS];
+    lp_problem_t prob;
+    memset(&prob, 0, sizeof(prob));
+    prob.num_variables = NUM_VARS;
+    prob.num_constraints = NUM_ROWS;
+    prob.constraint_matrix_row_pointers = row_ptr;
+    prob.constraint_matrix_col_indices = col_ind;
+    prob.constraint_matrix_num_nonzeros = build_matrix(row_ptr, col_ind);
+
+    int failed = 0;
+    int var_block[NUM_VARS], con_block[NUM_ROWS];
+    int linking_rows = -1, linking_cols = -1;
+    int blocks = detect_block_structure(&prob, var_block, con_block,
+                                        &linking_rows, &linking_cols);
+    if (blocks != NUM_BLOCKS || linking_rows != 1 || linking_cols != 0)
+    {
+        printf("found %d blocks, %d linking rows, %d linking cols\n", blocks,
+               linking_rows, linking_cols);
+        failed = 1;
+    }
+    for (int j = 0; j < NUM_VARS && !failed; ++j)
+    {
+        if (var_block[j] != j % NUM_BLOCKS)
+        {
+            printf("variable %d in block %d\n", j, var_block[j]);
+            failed = 1;
+        }
+    }
+    for (int r = 0; r < NUM_ROWS && !failed; ++r)
+    {
+        int expected = (r < NUM_ROWS - 1) ? r % NUM_BLOCKS : NUM_BLOCKS;
+        if (con_block[r] != expected)
+        {
+            printf("row %d in block %d, expected %d\n", r, con_block[r],
+                   expected);
+            failed = 1;
+        }
+    }
+
+    // bound types cut across the blocks, so every group holds several
+    double var_lower[NUM_VARS], var_upper[NUM_VARS];
+    for (int j = 0; j < NUM_VARS; ++j)
+    {
+        int type = (j * 7) % 5;
+        var_lower[j] = (type == 0 || type == 2) ? -INFINITY : 0.0;
+        var_upper[j] = (type == 0 || type == 1) ? INFINITY
+                       : (type == 4)            ? 0.0
+                                                : 1.0;
+    }
+    double con_lower[NUM_ROWS], con_upper[NUM_ROWS];
+    for (int r = 0; r < NUM_ROWS; ++r)
+    {
+        con_lower[r] = (r % 3 == 0) ? 1.0 : -INFINITY;
+        con_upper[r] = (r % 3 == 2) ? INFINITY : 1.0;
+    }
+    if (!failed)
+    {
+        failed |= check_order("variables", var_lower, var_upper, var_block,
+                              NUM_VARS);
+        failed |= check_order("rows", con_lower, con_upper, con_block,
+                              NUM_ROWS);
+    }
+
+    printf("%s\n", failed ? "FAILED" : "PASSED");
+    return failed ? 1 : 0;
+}
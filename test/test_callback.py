@@ -0,0 +1,63 @@
+# Copyright 2025 Haihao Lu
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import pytest
+from cupdlpx import PDLP
+
+# shape of a random LP that needs a few thousand iterations
+LONG_SOLVE = dict(m=2000, n=1500, density=0.005)
+
+
+def test_callback_sees_major_iterations(random_model):
+    """
+    The callback runs at every major iteration with increasing counts.
+    """
+    model = random_model(11, TermCheckFreq=64, **LONG_SOLVE)
+    seen = []
+    model.optimize(callback=lambda stats: seen.append(stats.iteration))
+    assert model.Status == "OPTIMAL", f"Unexpected termination status: {model.Status}"
+    assert seen, "Callback was never called."
+    assert all(it % 64 == 0 for it in seen), f"Callback outside major iterations: {seen}"
+    assert seen == sorted(seen), "Iteration counts are not increasing."
+
+
+def test_callback_stops_solve(random_model):
+    """
+    Returning False ends the solve with USER_INTERRUPT.
+    """
+    model = random_model(11, TermCheckFreq=64, **LONG_SOLVE)
+    calls = []
+
+    def stop_early(stats):
+        calls.append(stats.relative_objective_gap)
+        return len(calls) < 2
+
+    model.optimize(callback=stop_early)
+    assert model.Status == "USER_INTERRUPT", f"Unexpected termination status: {model.Status}"
+    assert model.StatusCode == PDLP.USER_INTERRUPT
+    assert len(calls) == 2, f"Callback ran {len(calls)} times after asking to stop."
+    assert model.IterCount < 3 * 64, f"Solve ran on for {model.IterCount} iterations."
+
+
+def test_callback_exception_propagates(random_model):
+    """
+    An exception in the callback stops the solve and reaches the caller.
+    """
+    model = random_model(11, TermCheckFreq=64, **LONG_SOLVE)
+
+    def fail(stats):
+        raise RuntimeError("stop here")
+
+    with pytest.raises(RuntimeError, match="stop here"):
+        model.optimize(callback=fail)
@@ -0,0 +1,63 @@
+# Copyright 2025 Haihao Lu
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import numpy as np
+import scipy.sparse as sp
+from scipy.optimize import linprog
+from cupdlpx import Model
+
+
+def test_transportation_problem(transportation_lp, atol):
+    """
+    A small alphabet (+1 only) takes the coded SpMV path.
+    """
+    c, A, l, u, lb, ub = transportation_lp(seed=3, supplies=20, demands=30)
+    model = Model(c, A, l, u, lb, ub)
+    model.setParams(OutputFlag=False)
+    model.optimize()
+    assert model.Status == "OPTIMAL", f"Unexpected termination status: {model.Status}"
+
+    ns = 20
+    A_ub = sp.vstack([A[:ns], -A[ns:]])
+    b_ub = np.concatenate([u[:ns], -l[ns:]])
+    ref = linprog(c, A_ub=A_ub, b_ub=b_ub, bounds=(0, None), method="highs")
+    assert ref.status == 0, "Reference solve failed."
+
+    rel = abs(model.ObjVal - ref.fun) / (1.0 + abs(ref.fun))
+    assert rel < 1e-3, f"Objective mismatch: {model.ObjVal} != {ref.fun}"
+    Ax = A @ model.X
+    assert np.all(Ax <= u + atol * (1.0 + np.abs(u))), "Primal solution is not feasible."
+    assert np.all(Ax >= l - atol * (1.0 + np.abs(l))), "Primal solution is not feasible."
+
+
+def test_coded_matrix_keeps_no_values():
+    """
+    A coded matrix leaves its double values on the host, so the setup takes
+    less device memory than the same pattern with many distinct values.
+    """
+    supplies, demands = 500, 1000
+    n = supplies * demands
+    rows = np.concatenate([np.repeat(np.arange(supplies), demands),
+                           supplies + np.tile(np.arange(demands), supplies)])
+    cols = np.concatenate([np.arange(n), np.arange(n)])
+    pattern = sp.csr_matrix((np.ones(2 * n), (rows, cols)), shape=(supplies + demands, n))
+    used = {}
+    for name, values in (("coded", pattern.data),
+                         ("plain", 1.0 + np.random.default_rng(0).random(pattern.nnz))):
+        A = sp.csr_matrix((values, pattern.indices, pattern.indptr), shape=pattern.shape)
+        model = Model(np.ones(n), A, None, np.full(A.shape[0], 1.0e3), np.zeros(n), None)
+        model.setParams(OutputFlag=False, IterationLimit=10)
+        model.optimize()
+        used[name] = model.DeviceMemory
+    assert used["coded"] + 8 * pattern.nnz <= used["plain"], f"Coded setup took {used['coded']} bytes, plain {used['plain']}."
@@ -0,0 +1,72 @@
+# Copyright 2025 Haihao Lu
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import numpy as np
+import scipy.sparse as sp
+from scipy.optimize import linprog
+from cupdlpx import Model
+
+
+def _planted_dense_lp(seed, dense_rows, dense_cols):
+    """
+    Random sparse LP with a few fully dense rows and columns planted in it.
+    Minimize c'x  s.t.  A x <= u,  0 <= x <= 10, feasible by construction.
+    """
+    rng = np.random.default_rng(seed=seed)
+    m, n = 400, 300
+    A = sp.rand(m, n, density=0.01, format="lil", random_state=rng)
+    for i in rng.choice(m, dense_rows, replace=False):
+        A[i, :] = rng.random(n)
+    for j in rng.choice(n, dense_cols, replace=False):
+        A[:, j] = rng.random((m, 1))
+    A = A.tocsr()
+    c = rng.standard_normal(n)
+    lb = np.zeros(n)
+    ub = np.full(n, 10.0)
+    x0 = rng.random(n) * 10.0
+    u = A @ x0 + 1.0
+    return c, A, u, lb, ub
+
+
+def _check_against_linprog(c, A, u, lb, ub, atol):
+    model = Model(c, A, None, u, lb, ub)
+    model.setParams(OutputFlag=False)
+    model.optimize()
+    assert model.Status == "OPTIMAL", f"Unexpected termination status: {model.Status}"
+
+    ref = linprog(c, A_ub=A, b_ub=u, bounds=list(zip(lb, ub)), method="highs")
+    assert ref.status == 0, "Reference solve failed."
+
+    rel = abs(model.ObjVal - ref.fun) / (1.0 + abs(ref.fun))
+    assert rel < 1e-3, f"Objective mismatch: {model.ObjVal} != {ref.fun}"
+    # primal feasibility
+    assert np.all(A @ model.X <= u + atol * (1.0 + np.abs(u))), "Primal solution is not feasible."
+    assert np.all(model.X >= lb - atol), "Primal solution is not feasible."
+    assert np.all(model.X <= ub + atol), "Primal solution is not feasible."
+
+
+def test_planted_dense_columns(atol):
+    """
+    Dense columns are moved out of the sparse matrix.
+    """
+    c, A, u, lb, ub = _planted_dense_lp(seed=1, dense_rows=0, dense_cols=3)
+    _check_against_linprog(c, A, u, lb, ub, atol)
+
+
+def test_planted_dense_rows_and_columns(atol):
+    """
+    Dense rows and columns overlap, so shared entries must be counted once.
+    """
+    c, A, u, lb, ub = _planted_dense_lp(seed=2, dense_rows=2, dense_cols=3)
+    _check_against_linprog(c, A, u, lb, ub, atol)
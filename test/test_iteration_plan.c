@@ -0,0 +1,80 @@
+/*
+Copyright 2025 Haihao Lu
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "iteration_plan.h"
+#include <stdio.h>
+
+// replays the host decisions of the main loop and checks that every
+// iteration the plan calls plain is one where the loop does nothing but the
+// plain update, and that every such iteration is covered by a run
+static int check_against_main_loop(int evaluation_frequency, int num_iterations)
+{
+    bool is_this_major_iteration = false;
+    int next_free = 0; // first iteration not covered by a replayed run
+    for (int k = 0; k < num_iterations; ++k)
+    {
+        bool evaluate = is_this_major_iteration || k == 0 ||
+                        k % get_print_frequency(k) == 0;
+        bool restart_check = is_this_major_iteration || k == 0;
+        is_this_major_iteration = ((k + 1) % evaluation_frequency) == 0;
+        bool major_kernels = is_this_major_iteration ||
+                             ((k + 2) % get_print_frequency(k + 2)) == 0;
+        bool plain = !evaluate && !restart_check && !is_this_major_iteration &&
+                     !major_kernels;
+
+        if (plain != is_plain_iteration(k, evaluation_frequency))
+        {
+            printf("freq %d iteration %d: plan says %d, loop says %d\n",
+                   evaluation_frequency, k, !plain, plain);
+            return 1;
+        }
+        if (k >= next_free && plain)
+        {
+            int run = plain_iteration_run(k, evaluation_frequency, 1 << 30);
+            if (run <= 0 || run >= evaluation_frequency)
+            {
+                printf("freq %d iteration %d: run of %d\n", evaluation_frequency,
+                       k, run);
+                return 1;
+            }
+            next_free = k + run;
+        }
+        else if (k < next_free && !plain)
+        {
+            printf("freq %d iteration %d: run covers an evaluation\n",
+                   evaluation_frequency, k);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void)
+{
+    int failures = 0;
+    int frequencies[] = {1, 2, 3, 7, 64, 200, 1000};
+    for (int f = 0; f < (int)(sizeof(frequencies) / sizeof(frequencies[0])); ++f)
+        failures += check_against_main_loop(frequencies[f], 200000);
+
+    if (plain_iteration_run(1, 200, 5) != 5 || plain_iteration_run(0, 200, 5) != 0)
+    {
+        printf("run length is not capped\n");
+        failures++;
+    }
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -13,6 +13,7 @@
 # limitations under the License.
 
 import numpy as np
+import pytest
 from cupdlpx import Model
 import scipy.sparse as sp
 
@@ -91,4 +92,103 @@ def test_coo(base_lp_data, atol):
     assert np.allclose(model.Pi, [1, -1, 0], atol=atol), f"Unexpected dual solution: {model.Pi}"
     # check objective
     assert hasattr(model, "ObjVal"), "Model.ObjVal (objective value) not exposed."
-    assert np.isclose(model.ObjVal, 3, atol=atol), f"Unexpected objective value: {model.ObjVal}"
\ No newline at end of file
+    assert np.isclose(model.ObjVal, 3, atol=atol), f"Unexpected objective value: {model.ObjVal}"
+
+def test_coo_duplicates(base_lp_data, atol):
+    """
+    Test COO constraint matrix with every coefficient split into repeated entries.
+    """
+    # setup model
+    c, A, l, u, lb, ub = base_lp_data
+    A = sp.coo_matrix(A)
+    # split each value into halves, listed in reverse order
+    rows = np.concatenate([A.row, A.row])[::-1]
+    cols = np.concatenate([A.col, A.col])[::-1]
+    vals = np.concatenate([0.5 * A.data, 0.5 * A.data])[::-1]
+    A = sp.coo_matrix((vals, (rows, cols)), shape=A.shape)
+    model = Model(c, A, l, u, lb, ub)
+    # turn off output
+    model.setParams(OutputFlag=False)
+    # optimize
+    model.optimize()
+    # check status
+    assert model.Status == "OPTIMAL", f"Unexpected termination status: {model.Status}"
+    # check primal solution
+    assert np.allclose(model.X, [1, 2], atol=atol), f"Unexpected primal solution: {model.X}"
+    # check objective
+    assert np.isclose(model.ObjVal, 3, atol=atol), f"Unexpected objective value: {model.ObjVal}"
+
+
+@pytest.mark.parametrize("fmt", ["csr", "csc", "coo"])
+@pytest.mark.parametrize("index_dtype", [np.int32, np.int64])
+@pytest.mark.parametrize("value_dtype", [np.float32, np.float64])
+def test_index_and_value_types(base_lp_data, atol, fmt, index_dtype, value_dtype):
+    """
+    Test sparse constraint matrices with int64 indices and float32 values,
+    which the core converts instead of the Python side.
+    """
+    # setup model
+    c, A, l, u, lb, ub = base_lp_data
+    A = sp.coo_matrix(A).asformat(fmt).astype(value_dtype)
+    if fmt == "coo":
+        A.row = A.row.astype(index_dtype)
+        A.col = A.col.astype(index_dtype)
+    else:
+        A.indptr = A.indptr.astype(index_dtype)
+        A.indices = A.indices.astype(index_dtype)
+    model = Model(c, A, l, u, lb, ub)
+    # the matrix reaches the core unconverted
+    assert model.A.dtype == value_dtype
+    # turn off output
+    model.setParams(OutputFlag=False)
+    # optimize
+    model.optimize()
+    # check status
+    assert model.Status == "OPTIMAL", f"Unexpected termination status: {model.Status}"
+    # check primal solution
+    assert np.allclose(model.X, [1, 2], atol=atol), f"Unexpected primal solution: {model.X}"
+    # check objective
+    assert np.isclose(model.ObjVal, 3, atol=atol), f"Unexpected objective value: {model.ObjVal}"
+
+
+@pytest.mark.parametrize(
+    "variant, kept",
+    [("sorted", True), ("explicit_zero", True), ("unsorted", False), ("duplicate", False)],
+)
+def test_csc_kept_or_rebuilt_transpose(random_lp, check_same_optimum, capfd, variant, kept):
+    """
+    Sorted int32/float64 CSC input is kept as the transpose of A, explicit
+    zeros included; a column with unsorted or repeated rows makes the setup
+    build the transpose itself. Either way the solve matches CSR input.
+    """
+    c, A, u, lb, ub = random_lp(seed=21)
+    A = A.tocsc()
+    A.indptr = A.indptr.astype(np.int32)
+    A.indices = A.indices.astype(np.int32)
+    j = int(np.argmax(np.diff(A.indptr) >= 2))
+    k = A.indptr[j]
+    if variant == "unsorted":
+        # swap the first two entries of column j
+        A.indices[k:k + 2] = A.indices[k:k + 2][::-1].copy()
+        A.data[k:k + 2] = A.data[k:k + 2][::-1].copy()
+        A.has_sorted_indices = False
+    elif variant == "explicit_zero":
+        # the conversion keeps the zero, so the arrays still match A
+        A.data[k] = 0.0
+    elif variant == "duplicate":
+        # the second entry of column j repeats the row of the first
+        A.indices[k + 1] = A.indices[k]
+        A.has_canonical_format = False
+    ref_A = sp.csr_matrix(A)
+    ref_A.sum_duplicates()
+    model = Model(c, A, None, u, lb, ub)
+    model.setParams(OutputFlag=True)
+    capfd.readouterr()
+    model.optimize()
+    header = capfd.readouterr().out
+    expected = "from the CSC input" if kept else "built on the device"
+    assert f"transpose     : {expected}" in header, f"The {variant} transpose was not {expected}."
+    ref = Model(c, ref_A, None, u, lb, ub)
+    ref.setParams(OutputFlag=False)
+    ref.optimize()
+    check_same_optimum(model, ref)
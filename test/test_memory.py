@@ -0,0 +1,104 @@
+# Copyright 2025 Haihao Lu
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import os
+import subprocess
+import sys
+import textwrap
+import pytest
+
+# child process: build a conforming CSR matrix, reset the peak RSS and report
+# how far the solve raised it above the resident size before the call
+_CHILD = textwrap.dedent(
+    """
+    import numpy as np
+    import scipy.sparse as sp
+    from cupdlpx import Model
+
+    def status(field):
+        with open("/proc/self/status") as f:
+            for line in f:
+                if line.startswith(field + ":"):
+                    return int(line.split()[1]) * 1024
+
+    # warm up the CUDA context with a tiny solve
+    warm = Model(np.ones(2), sp.csr_matrix(np.ones((1, 2))), None, np.ones(1), np.zeros(2), None)
+    warm.setParams(OutputFlag=False, IterationLimit=10)
+    warm.optimize()
+
+    m, n, k = 400000, 400000, 40
+    indptr = np.arange(0, m * k + 1, k, dtype=np.int32)
+    indices = np.empty(m * k, dtype=np.int32)
+    for j in range(k):
+        indices[j::k] = (np.arange(m, dtype=np.int32) * 7 + j * 9973) % n
+    indices.reshape(m, k).sort(axis=1)
+    data = np.random.default_rng(0).random(m * k) + 0.5
+    A = sp.csr_matrix((data, indices, indptr), shape=(m, n))
+    matrix_bytes = data.nbytes + indices.nbytes + indptr.nbytes
+
+    model = Model(np.ones(n), A, None, np.full(m, float(k)), np.zeros(n), None)
+    model.setParams(OutputFlag=False, IterationLimit=10)
+    with open("/proc/self/clear_refs", "w") as f:
+        f.write("5")
+    before = status("VmRSS")
+    model.optimize()
+    print(matrix_bytes, status("VmHWM") - before)
+    """
+)
+
+
+@pytest.mark.skipif(not os.access("/proc/self/clear_refs", os.W_OK), reason="needs a resettable peak RSS")
+def test_solve_holds_one_extra_copy_of_matrix():
+    """
+    The solve borrows a conforming CSR matrix, so the host peak only grows by
+    the rescaled copy instead of one copy per layer.
+    """
+    out = subprocess.run([sys.executable, "-c", _CHILD], check=True, capture_output=True, text=True)
+    matrix_bytes, growth = (int(v) for v in out.stdout.split()[-2:])
+    assert growth < 1.5 * matrix_bytes, f"Peak RSS grew by {growth} bytes for a {matrix_bytes} byte matrix."
+
+
+def test_device_memory_is_measured():
+    """
+    The result reports the device memory the setup allocated, at least the
+    device copy of the matrix.
+    """
+    import numpy as np
+    import scipy.sparse as sp
+    from cupdlpx import Model
+
+    m = n = 20000
+    A = sp.random(m, n, density=1e-3, format="csr", random_state=0, dtype=np.float64)
+    A.data += 0.5
+    model = Model(np.ones(n), A, None, np.ones(m), np.zeros(n), None)
+    model.setParams(OutputFlag=False, IterationLimit=10)
+    model.optimize()
+    matrix_bytes = A.data.nbytes + A.indices.nbytes + A.indptr.nbytes
+    assert model.DeviceMemory is not None
+    assert model.DeviceMemory >= matrix_bytes, f"Device memory {model.DeviceMemory} is below the {matrix_bytes} byte matrix."
+
+
+def test_device_memory_ignores_concurrent_solves(random_model):
+    """
+    Solves of a batch run side by side on several threads, and each still
+    reports only its own setup.
+    """
+    from cupdlpx import solve_many
+
+    alone = random_model(seed=5, m=2000, n=1500, density=0.005)
+    alone.optimize()
+    batch = [random_model(seed=5, m=2000, n=1500, density=0.005) for _ in range(4)]
+    solve_many(batch, max_workers=4)
+    for model in batch:
+        assert model.DeviceMemory == alone.DeviceMemory, f"Device memory {model.DeviceMemory} differs from {alone.DeviceMemory} alone."
@@ -0,0 +1,175 @@
+/*
+Copyright 2025 Haihao Lu
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "structure.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_ROWS 2000
+#define NUM_COLS 500
+
+// a few rows hold most of the nonzeros, many are empty
+static int *skewed_row_ptr(int *col_ind, int *values)
+{
+    int *row_ptr = (int *)malloc((NUM_ROWS + 1) * sizeof(int));
+    unsigned state = 12345u;
+    int nnz = 0;
+    row_ptr[0] = 0;
+    for (int i = 0; i < NUM_ROWS; ++i)
+    {
+        int len = (i % 397 == 5) ? NUM_COLS : (i % 3 == 0 ? 0 : 1 + i % 4);
+        for (int k = 0; k < len; ++k)
+        {
+            state = state * 1103515245u + 12345u;
+            col_ind[nnz] = (len == NUM_COLS) ? k : (int)((state >> 8) % NUM_COLS);
+            values[nnz] = (int)((state >> 16) % 7) - 3;
+            ++nnz;
+        }
+        row_ptr[i + 1] = nnz;
+    }
+    return row_ptr;
+}
+
+// host replay of the merge-path kernel and its fix-up, with integer values
+// so that every sum is exact
+static int check_partitions(const int *row_ptr, const int *col_ind,
+                            const int *values, const double *x, int items)
+{
+    int nnz = row_ptr[NUM_ROWS];
+    int parts = merge_path_num_partitions(NUM_ROWS, nnz, items);
+    int *start_row = (int *)malloc((parts + 1) * sizeof(int));
+    int *start_nz = (int *)malloc((parts + 1) * sizeof(int));
+    double *carry = (double *)malloc(parts * sizeof(double));
+    double out[NUM_ROWS];
+    merge_path_partitions(row_ptr, NUM_ROWS, items, parts, start_row, start_nz);
+
+    int failed = 0;
+    if (start_row[0] != 0 || start_nz[0] != 0 || start_row[parts] != NUM_ROWS ||
+        start_nz[parts] != nnz)
+    {
+        printf("items %d: path does not span the matrix\n", items);
+        failed = 1;
+    }
+    for (int p = 0; p < parts && !failed; ++p)
+    {
+        int work = (start_row[p + 1] - start_row[p]) +
+                   (start_nz[p + 1] - start_nz[p]);
+        if (work < 0 || work > items ||
+            (p < parts - 1 && work != items) ||
+            start_nz[p] < row_ptr[start_row[p]] ||
+            start_nz[p] > row_ptr[start_row[p] + 1])
+        {
+            printf("items %d: partition %d is off the path\n", items, p);
+            failed = 1;
+        }
+    }
+
+    for (int p = 0; p < parts && !failed; ++p)
+    {
+        int row = start_row[p];
+        int k = start_nz[p];
+        double sum = 0.0;
+        for (; row < start_row[p + 1]; ++row)
+        {
+            for (; k < row_ptr[row + 1]; ++k)
+                sum += values[k] * x[col_ind[k]];
+            out[row] = sum;
+            sum = 0.0;
+        }
+        for (; k < start_nz[p + 1]; ++k)
+            sum += values[k] * x[col_ind[k]];
+        carry[p] = sum;
+    }
+    for (int q = 0; q < parts && !failed; ++q)
+    {
+        int row = start_row[q];
+        if (start_nz[q] == row_ptr[row] || start_row[q + 1] == row)
+            continue;
+        int first = q - 1;
+        while (first > 0 && start_row[first] == row)
+            --first;
+        for (int p = first; p < q; ++p)
+            out[row] += carry[p];
+    }
+
+    for (int i = 0; i < NUM_ROWS && !failed; ++i)
+    {
+        double expected = 0.0;
+        for (int k = row_ptr[i]; k < row_ptr[i + 1]; ++k)
+            expected += values[k] * x[col_ind[k]];
+        if (out[i] != expected)
+        {
+            printf("items %d: row %d gives %g, expected %g\n", items, i, out[i],
+                   expected);
+            failed = 1;
+        }
+    }
+    free(start_row);
+    free(start_nz);
+    free(carry);
+    return failed;
+}
+
+int main(void)
+{
+    int *col_ind = (int *)malloc(NUM_ROWS * NUM_COLS * sizeof(int));
+    int *values = (int *)malloc(NUM_ROWS * NUM_COLS * sizeof(int));
+    int *row_ptr = skewed_row_ptr(col_ind, values);
+    double x[NUM_COLS];
+    for (int j = 0; j < NUM_COLS; ++j)
+        x[j] = (j % 5) - 2;
+
+    int failed = 0;
+    if (!csr_rows_skewed(row_ptr, NUM_ROWS))
+    {
+        printf("skewed matrix not detected\n");
+        failed = 1;
+    }
+    int even[NUM_ROWS + 1];
+    for (int i = 0; i <= NUM_ROWS; ++i)
+        even[i] = 3 * i;
+    if (csr_rows_skewed(even, NUM_ROWS))
+    {
+        printf("even matrix reported skewed\n");
+        failed = 1;
+    }
+
+    int item_counts[] = {1, 2, 7, 32, 100, 5000, 1 << 20};
+    for (size_t t = 0; t < sizeof(item_counts) / sizeof(item_counts[0]); ++t)
+        failed |= check_partitions(row_ptr, col_ind, values, x, item_counts[t]);
+
+    // the busiest of 64 row-balanced slices against the merge-path share
+    int nnz = row_ptr[NUM_ROWS];
+    int busiest = 0;
+    for (int s = 0; s < 64; ++s)
+    {
+        int begin = NUM_ROWS * s / 64, end = NUM_ROWS * (s + 1) / 64;
+        int work = (end - begin) + row_ptr[end] - row_ptr[begin];
+        if (work > busiest)
+            busiest = work;
+    }
+    int share = (NUM_ROWS + nnz + 63) / 64;
+    printf("busiest of 64 slices: %d items by rows, %d by merge path\n",
+           busiest, share);
+    if (busiest <= share)
+        failed = 1;
+
+    free(row_ptr);
+    free(col_ind);
+    free(values);
+    printf("%s\n", failed ? "FAILED" : "PASSED");
+    return failed ? 1 : 0;
+}
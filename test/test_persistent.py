@@ -0,0 +1,68 @@
+# Copyright 2025 Haihao Lu
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+import numpy as np
+import pytest
+
+
+def _with_dense_row(random_lp):
+    """
+    Random LP with its first row made fully dense, so setup splits it off;
+    the row bound holds for every x in the box.
+    """
+    c, A, u, lb, ub = random_lp(seed=32)
+    A = A.tolil()
+    A[0, :] = np.random.default_rng(seed=33).random(A.shape[1])
+    A = A.tocsr()
+    u = u.copy()
+    u[0] = A[0] @ ub + 1.0
+    return c, A, None, u, lb, ub
+
+
+def test_persistent_iterations_match_regular_path(random_lp, solve, check_same_optimum):
+    """
+    The persistent kernel computes the sparse products row by row, so it
+    reaches the same optimum in about the same number of iterations.
+    """
+    c, A, u, lb, ub = random_lp(seed=31)
+    data = (c, A, None, u, lb, ub)
+    ref = solve(*data, PersistentIterations=False)
+    model = solve(*data, PersistentIterations=True)
+    check_same_optimum(model, ref)
+    assert abs(model.IterCount - ref.IterCount) <= 0.1 * ref.IterCount + 64, (
+        f"Iteration counts differ: {model.IterCount} != {ref.IterCount}"
+    )
+
+
+@pytest.mark.parametrize("case", ["dense split", "transpose free", "coded"])
+def test_persistent_iterations_fall_back(random_lp, transportation_lp, solve, check_same_optimum, case):
+    """
+    Split dense rows, a scattered A^T y and a coded matrix keep the regular
+    path, so the flag leaves the solve as it was.
+    """
+    params = {}
+    if case == "dense split":
+        data = _with_dense_row(random_lp)
+    elif case == "transpose free":
+        c, A, u, lb, ub = random_lp(seed=34)
+        data = (c, A, None, u, lb, ub)
+        params["TransposeFree"] = True
+    else:
+        data = transportation_lp(seed=3, supplies=20, demands=30)
+    ref = solve(*data, PersistentIterations=False, **params)
+    model = solve(*data, PersistentIterations=True, **params)
+    check_same_optimum(model, ref)
+    assert model.IterCount == ref.IterCount, f"Iteration counts differ: {model.IterCount} != {ref.IterCount}"
+    assert model.ObjVal == ref.ObjVal, f"Objectives differ: {model.ObjVal} != {ref.ObjVal}"
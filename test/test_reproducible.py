@@ -0,0 +1,30 @@
+# Copyright 2025 Haihao Lu
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import numpy as np
+
+
+def test_repeated_solves_are_bitwise_identical(random_lp, solve):
+    """
+    Reductions have a fixed shape, so two solves of the same problem take the
+    same restart decisions and end at the same iterate.
+    """
+    # large enough for several restarts
+    c, A, u, lb, ub = random_lp(seed=7, m=2000, n=1500, density=0.005)
+    first = solve(c, A, None, u, lb, ub)
+    second = solve(c, A, None, u, lb, ub)
+    assert first.Status == "OPTIMAL", f"Unexpected termination status: {first.Status}"
+    assert first.IterCount == second.IterCount, "Iteration counts differ."
+    assert np.array_equal(first.X, second.X), "Primal solutions differ."
+    assert np.array_equal(first.Pi, second.Pi), "Dual solutions differ."
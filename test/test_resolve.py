@@ -0,0 +1,84 @@
+# Copyright 2025 Haihao Lu
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+import numpy as np
+from cupdlpx import Model, PDLP
+
+
+def _fresh(c, A, u, lb, ub, sense=PDLP.MINIMIZE):
+    model = Model(c, A, None, u, lb, ub)
+    model.ModelSense = sense
+    model.setParams(OutputFlag=False)
+    model.optimize()
+    return model
+
+
+def test_resolve_unchanged_starts_from_previous_solution(random_lp):
+    """
+    A second optimize() of an unchanged model starts at the previous solution.
+    """
+    c, A, u, lb, ub = random_lp(seed=1)
+    model = _fresh(c, A, u, lb, ub)
+    first_iters = model.IterCount
+    first_obj = model.ObjVal
+    model.optimize()
+    assert model.Status == "OPTIMAL", f"Unexpected termination status: {model.Status}"
+    assert model.IterCount <= first_iters, (
+        f"Re-solve took more iterations than the first solve: {model.IterCount} > {first_iters}"
+    )
+    assert np.isclose(model.ObjVal, first_obj, rtol=1e-4), f"Objective changed: {model.ObjVal} != {first_obj}"
+
+
+def test_resolve_after_objective_and_bound_changes(random_lp, check_same_optimum):
+    """
+    Objective and bound updates with the same bound types reuse the native
+    solver and reach the optimum of a freshly built model.
+    """
+    c, A, u, lb, ub = random_lp(seed=2)
+    model = _fresh(c, A, u, lb, ub)
+    rng = np.random.default_rng(seed=3)
+    c2 = c + 0.1 * rng.standard_normal(c.size)
+    ub2 = ub * 0.5
+    u2 = u * 1.1
+    model.setObjectiveVector(c2)
+    model.setVariableUpperBound(ub2)
+    model.setConstraintUpperBound(u2)
+    model.optimize()
+    check_same_optimum(model, _fresh(c2, A, u2, lb, ub2))
+
+
+def test_resolve_after_bound_type_change(random_lp, check_same_optimum):
+    """
+    Dropping finite upper bounds changes the bound types, which sets the
+    native solver up again.
+    """
+    c, A, u, lb, ub = random_lp(seed=4)
+    c = np.abs(c)
+    model = _fresh(c, A, u, lb, ub)
+    ub2 = ub.copy()
+    ub2[::2] = np.inf
+    model.setVariableUpperBound(ub2)
+    model.optimize()
+    check_same_optimum(model, _fresh(c, A, u, lb, ub2))
+
+
+def test_resolve_after_sense_change(random_lp, check_same_optimum):
+    """
+    Flipping ModelSense pushes the negated objective.
+    """
+    c, A, u, lb, ub = random_lp(seed=5)
+    model = _fresh(c, A, u, lb, ub)
+    model.ModelSense = PDLP.MAXIMIZE
+    model.optimize()
+    check_same_optimum(model, _fresh(c, A, u, lb, ub, sense=PDLP.MAXIMIZE))
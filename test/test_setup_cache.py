@@ -0,0 +1,65 @@
+# Copyright 2025 Haihao Lu
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+import numpy as np
+from cupdlpx import Model
+
+
+def _solve(data, cache_dir):
+    model = Model(*data)
+    model.setParams(OutputFlag=False, SetupCacheDir=str(cache_dir))
+    model.optimize()
+    assert model.Status == "OPTIMAL", f"Unexpected termination status: {model.Status}"
+    return model
+
+
+def _entries(cache_dir):
+    return sorted(cache_dir.glob("cupdlpx_setup_*.bin"))
+
+
+def test_setup_cache_reuses_entry(base_lp_data, tmp_path):
+    """
+    The first solve writes an entry and a second solve that loads it gives
+    the same result.
+    """
+    first = _solve(base_lp_data, tmp_path)
+    entries = _entries(tmp_path)
+    assert len(entries) == 1, f"Expected one cache entry, found {entries}."
+    second = _solve(base_lp_data, tmp_path)
+    assert second.IterCount == first.IterCount, "Iteration counts differ."
+    assert np.allclose(second.X, first.X), "Primal solutions differ."
+    assert np.allclose(second.Pi, first.Pi), "Dual solutions differ."
+
+
+def test_setup_cache_ignores_damaged_entry(base_lp_data, tmp_path, capfd, atol):
+    """
+    A truncated or corrupted entry is skipped with a warning, and the solve
+    sets up from scratch and writes a sound entry for the next one.
+    """
+    ref = _solve(base_lp_data, tmp_path)
+    entry = _entries(tmp_path)[0]
+    sound = entry.read_bytes()
+    damaged = {
+        "truncated": sound[: len(sound) - 8],
+        "corrupted": sound[:-8] + bytes(b ^ 0xFF for b in sound[-8:]),
+    }
+    for name, content in damaged.items():
+        entry.write_bytes(content)
+        capfd.readouterr()
+        model = _solve(base_lp_data, tmp_path)
+        assert "damaged setup cache entry" in capfd.readouterr().err, f"The {name} entry was not reported."
+        assert abs(model.ObjVal - ref.ObjVal) < atol, f"Objective mismatch after a {name} entry: {model.ObjVal} != {ref.ObjVal}"
+        _solve(base_lp_data, tmp_path)
+        assert "setup cache" not in capfd.readouterr().err, f"The {name} entry was not rewritten."
@@ -0,0 +1,70 @@
+# Copyright 2025 Haihao Lu
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+import numpy as np
+import cupdlpx
+from cupdlpx import Model
+
+
+def _solve(c, A, u, lb, ub, store_size):
+    model = Model(c, A, None, u, lb, ub)
+    model.setParams(OutputFlag=False, SolutionStoreSize=store_size)
+    model.optimize()
+    assert model.Status == "OPTIMAL", f"Unexpected termination status: {model.Status}"
+    return model
+
+
+def test_store_off_by_default(random_lp):
+    """
+    Without a store size a fresh model ignores earlier solves.
+    """
+    cupdlpx.clear_solution_store()
+    c, A, u, lb, ub = random_lp(seed=1, pattern_seed=0, slack=1.0)
+    first = _solve(c, A, u, lb, ub, store_size=0)
+    second = _solve(c, A, u, lb, ub, store_size=0)
+    assert second.IterCount == first.IterCount, (
+        f"Iteration counts differ: {second.IterCount} != {first.IterCount}"
+    )
+
+
+def test_fresh_model_starts_from_stored_solution(random_lp):
+    """
+    A fresh model of the same pattern starts from the latest stored solution.
+    """
+    cupdlpx.clear_solution_store()
+    c, A, u, lb, ub = random_lp(seed=2, pattern_seed=0, slack=1.0)
+    cold = _solve(c, A, u, lb, ub, store_size=4)
+    warm = _solve(c, A, u, lb, ub, store_size=4)
+    assert warm.IterCount < cold.IterCount, (
+        f"Stored solution did not shorten the solve: {warm.IterCount} >= {cold.IterCount}"
+    )
+    assert np.isclose(warm.ObjVal, cold.ObjVal, rtol=1e-4), f"Objective changed: {warm.ObjVal} != {cold.ObjVal}"
+    cupdlpx.clear_solution_store()
+
+
+def test_stored_solution_of_changed_values(random_lp, check_same_optimum):
+    """
+    New values on the same pattern still reach the optimum of a cold solve.
+    """
+    cupdlpx.clear_solution_store()
+    c, A, u, lb, ub = random_lp(seed=3, pattern_seed=0, slack=1.0)
+    _solve(c, A, u, lb, ub, store_size=4)
+    c2, A2, u2, lb2, ub2 = random_lp(seed=4, pattern_seed=0, slack=1.0)
+    A2 = A2.copy()
+    A2.data *= 1.5
+    warm = _solve(c2, A2, u2, lb2, ub2, store_size=4)
+    cupdlpx.clear_solution_store()
+    cold = _solve(c2, A2, u2, lb2, ub2, store_size=0)
+    check_same_optimum(warm, cold)
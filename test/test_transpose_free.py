@@ -0,0 +1,73 @@
+# Copyright 2025 Haihao Lu
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+
+import numpy as np
+from cupdlpx import Model
+
+
+def test_transpose_free_matches_stored_transpose(random_lp, solve, check_same_optimum):
+    """
+    Scattering A^T y from the rows of A reaches the same optimum.
+    """
+    c, A, u, lb, ub = random_lp(seed=11, m=2000, n=1500, density=0.005)
+    model = solve(c, A, None, u, lb, ub, TransposeFree=True)
+    check_same_optimum(model, solve(c, A, None, u, lb, ub, TransposeFree=False))
+
+
+def test_transpose_free_coded_matrix(transportation_lp, solve, check_same_optimum):
+    """
+    A coded matrix keeps the coded A x and scatters A^T y from the codes.
+    """
+    data = transportation_lp(seed=3, supplies=20, demands=30)
+    model = solve(*data, TransposeFree=True)
+    check_same_optimum(model, solve(*data, TransposeFree=False))
+
+
+def test_transpose_free_wide_slices(random_lp, solve, check_same_optimum):
+    """
+    Rows that spread over most columns make wide windows, so the slices grow
+    until the windows fit, and the optimum stays the same.
+    """
+    c, A, u, lb, ub = random_lp(seed=12, m=1500, n=6000, density=0.002)
+    model = solve(c, A, None, u, lb, ub, TransposeFree=True)
+    check_same_optimum(model, solve(c, A, None, u, lb, ub, TransposeFree=False))
+
+
+def test_transpose_free_is_reproducible(random_lp, solve):
+    """
+    The windows are summed in slice order, so repeated solves agree bitwise.
+    """
+    c, A, u, lb, ub = random_lp(seed=12, m=2000, n=1500, density=0.005)
+    first = solve(c, A, None, u, lb, ub, TransposeFree=True)
+    second = solve(c, A, None, u, lb, ub, TransposeFree=True)
+    assert first.IterCount == second.IterCount, "Iteration counts differ."
+    assert np.array_equal(first.X, second.X), "Primal solutions differ."
+    assert np.array_equal(first.Pi, second.Pi), "Dual solutions differ."
+
+
+def test_transpose_free_change_rebuilds_setup(random_lp, capfd):
+    """
+    Switching TransposeFree on a solved model sets the solver up again
+    instead of reusing the stored transpose.
+    """
+    c, A, u, lb, ub = random_lp(seed=13)
+    model = Model(c, A, None, u, lb, ub)
+    model.setParams(OutputFlag=False)
+    model.optimize()
+    model.setParams(OutputFlag=True, TransposeFree=True)
+    capfd.readouterr()
+    model.optimize()
+    assert "transpose     : none" in capfd.readouterr().out, "The stored transpose was reused."
+    assert model.Status == "OPTIMAL", f"Unexpected termination status: {model.Status}"